@@ -24,7 +24,10 @@
 #include <QString>
 #include <QUrl>
 #include <QDebug>
+#include <QProcessEnvironment>
 #include "renderjob.h"
+#include "rendercoordinator.h"
+#include "renderworker.h"
 
 int main(int argc, char **argv)
 {
@@ -32,6 +35,16 @@ int main(int argc, char **argv)
     QStringList args = app.arguments();
     QStringList preargs;
     QString locale;
+    // Secret shared by a coordinator and its workers
+    QString token = QProcessEnvironment::systemEnvironment().value(QStringLiteral("KDENLIVE_RENDER_TOKEN"));
+    if (args.count() >= 2 && args.at(1).startsWith(QLatin1String("-worker:"))) {
+        // Render ranges for a coordinator, possibly on another host
+        RenderWorker worker(args.at(1).section(QLatin1Char(':'), 1), token, args.value(2));
+        if (!worker.start()) {
+            return 1;
+        }
+        return app.exec();
+    }
     if (args.count() >= 7) {
         int pid = 0;
         int in = -1;
@@ -58,6 +71,19 @@ int main(int argc, char **argv)
             locale = args.at(0).section(QLatin1Char(':'), 1);
             args.removeFirst();
         }
+        QString coordinator;
+        int workers = 0;
+        int chunk = 0;
+        while (args.at(0).startsWith(QLatin1String("-coordinator:")) || args.at(0).startsWith(QLatin1String("-workers:")) || args.at(0).startsWith(QLatin1String("-chunk:"))) {
+            const QString option = args.takeFirst();
+            if (option.startsWith(QLatin1String("-coordinator:"))) {
+                coordinator = option.section(QLatin1Char(':'), 1);
+            } else if (option.startsWith(QLatin1String("-workers:"))) {
+                workers = option.section(QLatin1Char(':'), 1).toInt();
+            } else {
+                chunk = option.section(QLatin1Char(':'), 1).toInt();
+            }
+        }
         if (args.at(0).startsWith(QLatin1String("in="))) {
             in = args.takeFirst().section(QLatin1Char('='), -1).toInt();
         }
@@ -119,6 +145,26 @@ int main(int argc, char **argv)
             }
         }
 
+        if (!coordinator.isEmpty()) {
+            // Ranges are encoded separately and joined, dual pass is not supported
+            for (int i = args.count() - 1; i >= 0; --i) {
+                if (args.at(i) == QLatin1String("pass=1") || args.at(i).startsWith(QLatin1String("passlogfile="))) {
+                    args.removeAt(i);
+                }
+            }
+            qDebug() << "//STARTING DISTRIBUTED RENDERING: " << coordinator << ',' << workers << ',' << chunk << ',' << render << ',' << profile << ',' << rendermodule << ',' << src << ',' << dest << ',' << args << ',' << in << ',' << out;
+            RenderCoordinator job(coordinator, pid, erase, render, profile, rendermodule, src, dest, preargs, args, in, out, chunk);
+            if (!locale.isEmpty()) {
+                job.setLocale(locale);
+            }
+            job.setToken(token);
+            if (!job.start()) {
+                return 1;
+            }
+            job.startLocalWorkers(workers);
+            return app.exec();
+        }
+
         qDebug() << "//STARTING RENDERING: " << erase << ',' << usekuiserver << ',' << render << ',' << profile << ',' << rendermodule << ',' << player << ',' << src << ',' << dest << ',' << preargs << ',' << args << ',' << in << ',' << out;
         RenderJob *job = new RenderJob(doerase, usekuiserver, pid, render, profile, rendermodule, player, src, dest, preargs, args, in, out);
         if (!locale.isEmpty()) {
@@ -138,10 +184,20 @@ int main(int argc, char **argv)
         delete dualjob;
     } else {
         fprintf(stderr, "Kdenlive video renderer for MLT.\nUsage: "
-                "kdenlive_render [-erase] [-kuiserver] [-locale:LOCALE] [in=pos] [out=pos] [render] [profile] [rendermodule] [player] [src] [dest] [[arg1] [arg2] ...]\n"
+                "kdenlive_render [-erase] [-kuiserver] [-locale:LOCALE] [-coordinator:ADDRESS [-workers:N] [-chunk:FRAMES]] [in=pos] [out=pos] [render] [profile] [rendermodule] [player] [src] [dest] [[arg1] [arg2] ...]\n"
+                "kdenlive_render -worker:ADDRESS [render]\n"
                 "  -erase: if that parameter is present, src file will be erased at the end\n"
                 "  -kuiserver: if that parameter is present, use KDE job tracker\n"
                 "  -locale:LOCALE : set a locale for rendering. For example, -locale:fr_FR.UTF-8 will use a french locale (comma as numeric separator)\n"
+                "  -coordinator:ADDRESS: split the rendering in frame ranges rendered by workers connecting to ADDRESS,\n"
+                "                        and join them with FFmpeg. ADDRESS is a port number (localhost only), host:port\n"
+                "                        to accept workers from other hosts on that interface, or a local socket name\n"
+                "  -workers:N: also start N workers on this host\n"
+                "  -chunk:FRAMES: number of frames in each range (default 1500)\n"
+                "  -worker:ADDRESS: render ranges for the coordinator at ADDRESS (host:port or local socket name),\n"
+                "                   with the given melt executable or the one in the PATH. Paths must be the same on all hosts\n"
+                "  KDENLIVE_RENDER_TOKEN: environment variable holding the secret shared by the coordinator and its workers,\n"
+                "                         the coordinator prints a generated one if it is not set\n"
                 "  in=pos: start rendering at frame pos\n"
                 "  out=pos: end rendering at frame pos\n"
                 "  render: path to MLT melt renderer\n"
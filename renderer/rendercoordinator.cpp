@@ -0,0 +1,616 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "rendercoordinator.h"
+
+#include <QtDBus>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMimeDatabase>
+#include <QStandardPaths>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUuid>
+
+#include <stdio.h>
+
+// A range failing that many times aborts the render, a worker failing that many times is dismissed
+static const int MaxFailures = 3;
+
+RenderCoordinator::RenderCoordinator(const QString &address, int pid, bool erase, const QString &renderer, const QString &profile, const QString &rendermodule, const QString &scenelist, const QString &dest, const QStringList &preargs, const QStringList &args, int in, int out, int chunk) :
+    QObject(),
+    m_address(address),
+    m_port(-1),
+    m_pid(pid),
+    m_erase(erase),
+    m_renderer(renderer),
+    m_profile(profile),
+    m_rendermodule(rendermodule),
+    m_scenelist(scenelist),
+    m_dest(dest),
+    m_preargs(preargs),
+    m_args(args),
+    m_tcpServer(nullptr),
+    m_localServer(nullptr),
+    m_joinProcess(nullptr),
+    m_kdenliveinterface(nullptr),
+    m_progress(0),
+    m_finished(false),
+    m_cleanedUp(false),
+    m_status(0),
+    m_logfile(dest + QStringLiteral(".txt"))
+{
+    if (!m_logfile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Unable to log to " << m_logfile.fileName();
+    } else {
+        m_logstream.setDevice(&m_logfile);
+    }
+    // A port alone listens on localhost, other hosts are only accepted if an interface is given
+    bool isPort;
+    m_port = m_address.toInt(&isPort);
+    if (isPort) {
+        m_host = QStringLiteral("127.0.0.1");
+    } else {
+        m_port = m_address.section(QLatin1Char(':'), -1).toInt(&isPort);
+        if (isPort && m_address.contains(QLatin1Char(':'))) {
+            m_host = m_address.section(QLatin1Char(':'), 0, -2);
+        } else {
+            m_port = -1;
+        }
+    }
+    if (chunk <= 0) {
+        chunk = 1500;
+    }
+    for (int start = qMax(0, in); start <= out; start += chunk) {
+        Range range;
+        range.in = start;
+        range.out = qMin(out, start + chunk - 1);
+        range.progress = 0;
+        range.failures = 0;
+        range.done = false;
+        range.audio = false;
+        m_ranges << range;
+    }
+    // Audio encoders add priming samples at the start of each stream, joined audio
+    // ranges would have small gaps. Audio is encoded once over the whole zone, first
+    // since it is quick.
+    if (!m_ranges.isEmpty() && !m_args.contains(QStringLiteral("an=1")) && !m_args.contains(QStringLiteral("vn=1"))
+            && !QMimeDatabase().mimeTypeForFile(m_dest, QMimeDatabase::MatchExtension).name().startsWith(QLatin1String("audio/"))) {
+        Range range;
+        range.in = m_ranges.first().in;
+        range.out = m_ranges.last().out;
+        range.progress = 0;
+        range.failures = 0;
+        range.done = false;
+        range.audio = true;
+        m_ranges.prepend(range);
+    }
+}
+
+RenderCoordinator::~RenderCoordinator()
+{
+    for (QProcess *process : m_localWorkers) {
+        // Workers exit by themselves once told to quit
+        if (!process->waitForFinished(3000)) {
+            process->kill();
+            process->waitForFinished();
+        }
+    }
+    qDeleteAll(m_localWorkers);
+    m_logfile.close();
+}
+
+void RenderCoordinator::setLocale(const QString &locale)
+{
+    m_locale = locale;
+}
+
+void RenderCoordinator::setToken(const QString &token)
+{
+    m_token = token;
+}
+
+void RenderCoordinator::startLocalWorkers(int count)
+{
+    QString address = m_address;
+    if (m_port >= 0) {
+        const QHostAddress host(m_host);
+        const bool anyHost = host == QHostAddress::Any || host == QHostAddress::AnyIPv4 || host == QHostAddress::AnyIPv6;
+        address = (anyHost ? QStringLiteral("127.0.0.1") : m_host) + QLatin1Char(':') + QString::number(m_port);
+    }
+    // The token is not passed on the command line, where other users could read it
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("KDENLIVE_RENDER_TOKEN"), m_token);
+    for (int i = 0; i < count; ++i) {
+        QProcess *process = new QProcess;
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->setProcessEnvironment(env);
+        connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &RenderCoordinator::slotLocalWorkerExited);
+        connect(process, &QProcess::errorOccurred, this, &RenderCoordinator::slotLocalWorkerExited);
+        process->start(QCoreApplication::applicationFilePath(), QStringList() << QStringLiteral("-worker:") + address << m_renderer);
+        m_localWorkers << process;
+    }
+}
+
+bool RenderCoordinator::start()
+{
+    if (m_token.isEmpty()) {
+        m_token = QUuid::createUuid().toString().remove(QLatin1Char('{')).remove(QLatin1Char('}'));
+        // Remote workers need it, see KDENLIVE_RENDER_TOKEN
+        fprintf(stdout, "Render token: %s\n", m_token.toUtf8().constData());
+        fflush(stdout);
+    }
+    bool listening;
+    if (m_port >= 0) {
+        m_tcpServer = new QTcpServer(this);
+        connect(m_tcpServer, &QTcpServer::newConnection, this, &RenderCoordinator::slotNewConnection);
+        listening = m_tcpServer->listen(QHostAddress(m_host), (quint16) m_port);
+    } else {
+        m_localServer = new QLocalServer(this);
+        connect(m_localServer, &QLocalServer::newConnection, this, &RenderCoordinator::slotNewConnection);
+        QLocalServer::removeServer(m_address);
+        listening = m_localServer->listen(m_address);
+    }
+    initKdenliveDbusInterface();
+    if (!listening) {
+        finish(-2, tr("Cannot listen for render workers on %1").arg(m_address));
+        return false;
+    }
+    if (m_ranges.isEmpty()) {
+        finish(-2, tr("Nothing to render"));
+        return false;
+    }
+    m_timer.start();
+    m_logstream << "Waiting for workers on " << m_address << ", " << m_ranges.count() << " ranges to render" << endl;
+    return true;
+}
+
+void RenderCoordinator::slotNewConnection()
+{
+    if (m_tcpServer) {
+        while (m_tcpServer->hasPendingConnections()) {
+            addConnection(m_tcpServer->nextPendingConnection());
+        }
+    } else if (m_localServer) {
+        while (m_localServer->hasPendingConnections()) {
+            addConnection(m_localServer->nextPendingConnection());
+        }
+    }
+}
+
+void RenderCoordinator::addConnection(QIODevice *socket)
+{
+    Worker worker;
+    worker.range = -1;
+    worker.frames = 0;
+    worker.msecs = 0;
+    worker.failures = 0;
+    m_workers.insert(socket, worker);
+    // QTcpSocket and QLocalSocket have no common base class for these signals
+    connect(socket, SIGNAL(disconnected()), this, SLOT(slotWorkerDisconnected()));
+    connect(socket, &QIODevice::readyRead, this, &RenderCoordinator::slotReadWorker);
+}
+
+void RenderCoordinator::send(QIODevice *socket, const QJsonObject &message)
+{
+    socket->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void RenderCoordinator::dispatch(QIODevice *socket)
+{
+    Worker &worker = m_workers[socket];
+    if (m_finished || worker.failures >= MaxFailures) {
+        QJsonObject message;
+        message.insert(QStringLiteral("type"), QStringLiteral("quit"));
+        send(socket, message);
+        return;
+    }
+    if (worker.range >= 0 || worker.name.isEmpty()) {
+        return;
+    }
+    // Find a range that is neither rendered nor assigned
+    QList<int> assigned;
+    for (const Worker &w : m_workers) {
+        assigned << w.range;
+    }
+    for (int i = 0; i < m_ranges.count(); ++i) {
+        if (m_ranges.at(i).done || assigned.contains(i)) {
+            continue;
+        }
+        Range &range = m_ranges[i];
+        // Each attempt has its own file, a worker that was given up on may still be writing the previous one
+        const QFileInfo info(m_dest);
+        if (range.audio) {
+            range.part = info.absolutePath() + QLatin1Char('/') + info.completeBaseName() + QStringLiteral(".audio-%1.").arg(range.failures + 1) + info.suffix();
+        } else {
+            range.part = info.absolutePath() + QLatin1Char('/') + info.completeBaseName() + QStringLiteral(".range%1-%2.").arg(m_ranges.first().audio ? i : i + 1, 3, 10, QLatin1Char('0')).arg(range.failures + 1) + info.suffix();
+        }
+        m_partFiles << range.part;
+        QStringList args = m_args;
+        if (range.audio) {
+            args << QStringLiteral("vn=1");
+        } else if (m_ranges.first().audio) {
+            args << QStringLiteral("an=1");
+        }
+        QJsonObject message;
+        message.insert(QStringLiteral("type"), QStringLiteral("render"));
+        message.insert(QStringLiteral("id"), i);
+        message.insert(QStringLiteral("in"), range.in);
+        message.insert(QStringLiteral("out"), range.out);
+        message.insert(QStringLiteral("dest"), range.part);
+        message.insert(QStringLiteral("profile"), m_profile);
+        message.insert(QStringLiteral("rendermodule"), m_rendermodule);
+        message.insert(QStringLiteral("scenelist"), m_scenelist);
+        message.insert(QStringLiteral("locale"), m_locale);
+        message.insert(QStringLiteral("preargs"), QJsonArray::fromStringList(m_preargs));
+        message.insert(QStringLiteral("args"), QJsonArray::fromStringList(args));
+        send(socket, message);
+        worker.range = i;
+        worker.timer.start();
+        m_logstream << (range.audio ? "Audio " : "Range ") << range.in << '-' << range.out << " sent to " << worker.name << endl;
+        return;
+    }
+}
+
+void RenderCoordinator::slotReadWorker()
+{
+    QIODevice *socket = qobject_cast<QIODevice *>(sender());
+    if (!socket || !m_workers.contains(socket)) {
+        return;
+    }
+    while (socket->canReadLine()) {
+        const QJsonObject message = QJsonDocument::fromJson(socket->readLine()).object();
+        const QString type = message.value(QStringLiteral("type")).toString();
+        Worker &worker = m_workers[socket];
+        if (type == QLatin1String("hello")) {
+            if (message.value(QStringLiteral("token")).toString() != m_token) {
+                m_logstream << "Rejected worker " << message.value(QStringLiteral("name")).toString() << ": wrong token" << endl;
+                m_workers.remove(socket);
+                socket->close();
+                socket->deleteLater();
+                return;
+            }
+            worker.name = message.value(QStringLiteral("name")).toString();
+            m_logstream << "Worker " << worker.name << " connected" << endl;
+            dispatch(socket);
+            continue;
+        }
+        if (worker.name.isEmpty()) {
+            // Nothing is accepted before the hello
+            m_workers.remove(socket);
+            socket->close();
+            socket->deleteLater();
+            return;
+        }
+        const int id = message.value(QStringLiteral("id")).toInt(-1);
+        if (id < 0 || id != worker.range || m_finished) {
+            continue;
+        }
+        Range &range = m_ranges[id];
+        if (type == QLatin1String("progress")) {
+            range.progress = qBound(0, message.value(QStringLiteral("progress")).toInt(), 100);
+            updateProgress();
+        } else if (type == QLatin1String("done")) {
+            range.done = true;
+            range.progress = 100;
+            if (!range.audio) {
+                worker.frames += range.out - range.in + 1;
+            }
+            worker.msecs += worker.timer.elapsed();
+            worker.range = -1;
+            updateProgress();
+            bool complete = true;
+            for (const Range &r : m_ranges) {
+                complete = complete && r.done;
+            }
+            if (complete) {
+                joinParts();
+                return;
+            }
+            dispatch(socket);
+        } else if (type == QLatin1String("failed")) {
+            rangeFailed(worker, message.value(QStringLiteral("error")).toString());
+            if (!m_finished) {
+                for (auto it = m_workers.constBegin(); it != m_workers.constEnd(); ++it) {
+                    dispatch(it.key());
+                }
+            }
+            return;
+        }
+    }
+}
+
+void RenderCoordinator::rangeFailed(Worker &worker, const QString &error)
+{
+    Range &range = m_ranges[worker.range];
+    range.progress = 0;
+    range.failures++;
+    worker.failures++;
+    worker.range = -1;
+    m_logstream << "Range " << range.in << '-' << range.out << " failed on " << worker.name << ": " << error << endl;
+    updateProgress();
+    if (range.failures >= MaxFailures) {
+        finish(-2, tr("Rendering of frames %1 to %2 failed %3 times, last error: %4").arg(range.in).arg(range.out).arg(range.failures).arg(error));
+    }
+}
+
+void RenderCoordinator::slotWorkerDisconnected()
+{
+    QIODevice *socket = qobject_cast<QIODevice *>(sender());
+    if (!socket || !m_workers.contains(socket)) {
+        return;
+    }
+    Worker worker = m_workers.take(socket);
+    socket->deleteLater();
+    if (worker.range >= 0 && !m_finished) {
+        rangeFailed(worker, tr("worker disconnected"));
+    }
+    if (!worker.name.isEmpty()) {
+        m_retiredWorkers << worker;
+    }
+    if (m_finished) {
+        if (m_workers.isEmpty()) {
+            slotCleanup();
+        }
+        return;
+    }
+    // Give the range back to an idle worker
+    for (auto it = m_workers.constBegin(); it != m_workers.constEnd(); ++it) {
+        dispatch(it.key());
+    }
+    checkWorkersLeft();
+}
+
+void RenderCoordinator::slotLocalWorkerExited()
+{
+    if (!m_finished) {
+        checkWorkersLeft();
+    }
+}
+
+void RenderCoordinator::checkWorkersLeft()
+{
+    if (m_finished || m_joinProcess) {
+        return;
+    }
+    int connected = 0;
+    for (const Worker &worker : m_workers) {
+        if (worker.failures < MaxFailures) {
+            connected++;
+        }
+    }
+    if (connected > 0) {
+        return;
+    }
+    for (QProcess *process : m_localWorkers) {
+        if (process->state() != QProcess::NotRunning) {
+            // Still starting, it will connect
+            return;
+        }
+    }
+    if (m_retiredWorkers.isEmpty() && m_localWorkers.isEmpty()) {
+        // No worker came yet, remote workers may still connect
+        return;
+    }
+    finish(-2, tr("All render workers left before the end of the rendering"));
+}
+
+void RenderCoordinator::updateProgress()
+{
+    qint64 done = 0;
+    qint64 total = 0;
+    for (const Range &range : m_ranges) {
+        // Audio alone encodes much faster than the video ranges
+        const int length = range.audio ? qMax(1, (range.out - range.in + 1) / 20) : range.out - range.in + 1;
+        done += (qint64) length * range.progress;
+        total += length;
+    }
+    // Keep the last percent for the joining step
+    const int progress = total > 0 ? (int)(done * 99 / (total * 100)) : 0;
+    if (progress == m_progress) {
+        return;
+    }
+    m_progress = progress;
+    if (m_kdenliveinterface && m_kdenliveinterface->isValid()) {
+        m_dbusargs[1] = m_progress;
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
+    }
+}
+
+void RenderCoordinator::joinParts()
+{
+    for (auto it = m_workers.constBegin(); it != m_workers.constEnd(); ++it) {
+        QJsonObject message;
+        message.insert(QStringLiteral("type"), QStringLiteral("quit"));
+        send(it.key(), message);
+    }
+    const QString ffmpeg = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
+    QFile list(m_dest + QStringLiteral(".ranges.txt"));
+    if (ffmpeg.isEmpty() || !list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        finish(-2, ffmpeg.isEmpty() ? tr("FFmpeg is required to join the rendered ranges") : tr("Cannot write to %1").arg(list.fileName()));
+        return;
+    }
+    QTextStream stream(&list);
+    QString audioPart;
+    for (const Range &range : m_ranges) {
+        if (range.audio) {
+            audioPart = range.part;
+            continue;
+        }
+        QString part = range.part;
+        stream << "file '" << part.replace(QLatin1Char('\''), QLatin1String("'\\''")) << "'\n";
+    }
+    list.close();
+    m_joinProcess = new QProcess(this);
+    m_joinProcess->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_joinProcess, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &RenderCoordinator::slotJoinFinished);
+    connect(m_joinProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            finish(-2, tr("Cannot start FFmpeg: %1").arg(m_joinProcess->errorString()));
+        }
+    });
+    QStringList args;
+    args << QStringLiteral("-y") << QStringLiteral("-hide_banner") << QStringLiteral("-loglevel") << QStringLiteral("error");
+    args << QStringLiteral("-f") << QStringLiteral("concat") << QStringLiteral("-safe") << QStringLiteral("0") << QStringLiteral("-i") << list.fileName();
+    if (audioPart.isEmpty()) {
+        args << QStringLiteral("-map") << QStringLiteral("0");
+    } else {
+        // Video ranges joined, with the audio encoded in one pass
+        args << QStringLiteral("-i") << audioPart << QStringLiteral("-map") << QStringLiteral("0:v") << QStringLiteral("-map") << QStringLiteral("1:a");
+    }
+    args << QStringLiteral("-c") << QStringLiteral("copy") << m_dest;
+    m_logstream << "Joining ranges: " << ffmpeg << ' ' << args.join(QLatin1Char(' ')) << endl;
+    m_joinProcess->start(ffmpeg, args);
+}
+
+void RenderCoordinator::slotJoinFinished(int exitCode, QProcess::ExitStatus status)
+{
+    const QString log = QString::fromUtf8(m_joinProcess->readAll());
+    QFile::remove(m_dest + QStringLiteral(".ranges.txt"));
+    const bool success = status == QProcess::NormalExit && exitCode == 0;
+    finish(success ? -1 : -2, log);
+}
+
+void RenderCoordinator::slotAbort(const QString &url)
+{
+    if (url == m_dest && !m_finished) {
+        if (m_joinProcess && m_joinProcess->state() != QProcess::NotRunning) {
+            m_joinProcess->blockSignals(true);
+            m_joinProcess->kill();
+            m_joinProcess->waitForFinished();
+        }
+        // The destination is removed in slotCleanup, once nothing writes to it
+        finish(-3, QString());
+    }
+}
+
+void RenderCoordinator::finish(int status, const QString &error)
+{
+    if (m_finished) {
+        return;
+    }
+    m_finished = true;
+    m_status = status;
+    m_error = error;
+    // Workers kill their melt and wait for it before leaving
+    for (auto it = m_workers.constBegin(); it != m_workers.constEnd(); ++it) {
+        QJsonObject message;
+        message.insert(QStringLiteral("type"), QStringLiteral("quit"));
+        send(it.key(), message);
+    }
+    if (m_workers.isEmpty()) {
+        slotCleanup();
+    } else {
+        // Do not wait forever for an unresponsive remote worker
+        QTimer::singleShot(30000, this, &RenderCoordinator::slotCleanup);
+    }
+}
+
+void RenderCoordinator::slotCleanup()
+{
+    if (m_cleanedUp) {
+        return;
+    }
+    m_cleanedUp = true;
+    const int status = m_status;
+    const QString error = m_error;
+    for (QProcess *process : m_localWorkers) {
+        if (!process->waitForFinished(10000)) {
+            process->kill();
+            process->waitForFinished();
+        }
+    }
+    for (const QString &part : m_partFiles) {
+        QFile::remove(part);
+    }
+    if (status == -3) {
+        QFile::remove(m_dest);
+    }
+    if (m_erase) {
+        QFile(m_scenelist).remove();
+    }
+
+    // Throughput of each worker
+    QList<Worker> workers = m_retiredWorkers;
+    workers << m_workers.values();
+    qint64 frames = 0;
+    for (const Worker &worker : workers) {
+        frames += worker.frames;
+        const double fps = worker.msecs > 0 ? worker.frames * 1000.0 / worker.msecs : 0;
+        m_logstream << "Worker " << worker.name << ": " << worker.frames << " frames in " << worker.msecs / 1000.0 << "s (" << fps << " fps), " << worker.failures << " failures" << endl;
+        fprintf(stdout, "%s: %lld frames, %.1f fps, %d failures\n", worker.name.toUtf8().constData(), (long long) worker.frames, fps, worker.failures);
+    }
+    const qint64 elapsed = m_timer.isValid() ? m_timer.elapsed() : 0;
+    m_logstream << "Rendered " << frames << " frames in " << elapsed / 1000.0 << "s with " << workers.count() << " workers" << endl;
+
+    if (m_kdenliveinterface) {
+        m_dbusargs[1] = status;
+        m_dbusargs.append(error);
+        m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingFinished"), m_dbusargs);
+    }
+    if (status == -1) {
+        m_logstream << "Rendering of " << m_dest << " finished" << endl;
+        m_logstream.flush();
+        m_logfile.remove();
+    } else {
+        m_logstream << error << endl;
+        m_logstream.flush();
+    }
+    qApp->quit();
+}
+
+void RenderCoordinator::initKdenliveDbusInterface()
+{
+    QString kdenliveId;
+    QDBusConnection connection = QDBusConnection::sessionBus();
+    QDBusConnectionInterface *ibus = connection.interface();
+    if (!ibus) {
+        return;
+    }
+    kdenliveId = QStringLiteral("org.kde.kdenlive-%1").arg(m_pid);
+    if (!ibus->isServiceRegistered(kdenliveId)) {
+        kdenliveId.clear();
+        const QStringList services = ibus->registeredServiceNames();
+        for (const QString &service : services) {
+            if (service.startsWith(QLatin1String("org.kde.kdenlive"))) {
+                kdenliveId = service;
+                break;
+            }
+        }
+    }
+    m_dbusargs.clear();
+    if (kdenliveId.isEmpty()) {
+        return;
+    }
+    m_kdenliveinterface = new QDBusInterface(kdenliveId,
+            QStringLiteral("/kdenlive/MainWindow_1"),
+            QStringLiteral("org.kde.kdenlive.rendering"),
+            connection,
+            this);
+    m_dbusargs.append(m_dest);
+    m_dbusargs.append((int) 0);
+    m_kdenliveinterface->callWithArgumentList(QDBus::NoBlock, QStringLiteral("setRenderingProgress"), m_dbusargs);
+    connect(m_kdenliveinterface, SIGNAL(abortRenderJob(QString)),
+            this, SLOT(slotAbort(QString)));
+}
@@ -0,0 +1,151 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef RENDERCOORDINATOR_H
+#define RENDERCOORDINATOR_H
+
+#include <QObject>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QMap>
+#include <QFile>
+#include <QTextStream>
+
+class QDBusInterface;
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+
+/**
+  Splits a render in frame ranges and hands them to kdenlive_render workers.
+
+  Workers connect over TCP or a local socket and exchange one JSON object per
+  line. The address is a port number (listening on localhost only), host:port
+  to listen on another interface, or a local socket name. A worker says hello
+  with the shared token, then receives ranges to render until there is nothing
+  left. Workers run their own melt, the coordinator only sends the range and
+  the render arguments. A range is given back to the queue when its worker
+  fails or disconnects, the render fails when no worker is left. The ranges
+  are rendered without audio, which is encoded in one pass over the whole
+  zone by another worker. When everything is rendered, the ranges are joined
+  and the audio muxed in without re-encoding, and the result is reported to
+  Kdenlive like a normal render job.
+
+  The scenelist and the destination folder must be reachable with the same path
+  on every worker host.
+  */
+class RenderCoordinator : public QObject
+{
+    Q_OBJECT
+
+public:
+    RenderCoordinator(const QString &address, int pid, bool erase, const QString &renderer, const QString &profile, const QString &rendermodule, const QString &scenelist, const QString &dest, const QStringList &preargs, const QStringList &args, int in, int out, int chunk);
+    ~RenderCoordinator();
+    void setLocale(const QString &locale);
+    /** @brief Secret the workers must send in their hello, generated if not set. */
+    void setToken(const QString &token);
+    /** @brief Start @param count worker processes on this host, connecting to our address. */
+    void startLocalWorkers(int count);
+
+public slots:
+    /** @brief Start listening for workers, returns false if the address is not available. */
+    bool start();
+
+private slots:
+    void slotNewConnection();
+    void slotReadWorker();
+    void slotWorkerDisconnected();
+    void slotAbort(const QString &url);
+    void slotJoinFinished(int exitCode, QProcess::ExitStatus status);
+    void slotLocalWorkerExited();
+    /** @brief Remove the range files and report the result, once the workers stopped writing them. */
+    void slotCleanup();
+
+private:
+    struct Range {
+        int in;
+        int out;
+        int progress;
+        int failures;
+        bool done;
+        /** @brief True for the audio of the whole zone, the other ranges have no audio */
+        bool audio;
+        QString part;
+    };
+    struct Worker {
+        QString name;
+        /** @brief Index of the range being rendered, -1 if idle */
+        int range;
+        qint64 frames;
+        qint64 msecs;
+        int failures;
+        QElapsedTimer timer;
+    };
+
+    QString m_address;
+    /** @brief Interface to listen on and port, -1 for a local socket */
+    QString m_host;
+    int m_port;
+    QString m_token;
+    int m_pid;
+    bool m_erase;
+    QString m_locale;
+    QString m_renderer;
+    QString m_profile;
+    QString m_rendermodule;
+    QString m_scenelist;
+    QString m_dest;
+    QStringList m_preargs;
+    QStringList m_args;
+    QTcpServer *m_tcpServer;
+    QLocalServer *m_localServer;
+    QList<Range> m_ranges;
+    /** @brief Every range file given to a worker, removed at the end */
+    QStringList m_partFiles;
+    QMap<QIODevice *, Worker> m_workers;
+    /** @brief Workers that left, kept for the final statistics */
+    QList<Worker> m_retiredWorkers;
+    QList<QProcess *> m_localWorkers;
+    QProcess *m_joinProcess;
+    QDBusInterface *m_kdenliveinterface;
+    QList<QVariant> m_dbusargs;
+    int m_progress;
+    bool m_finished;
+    bool m_cleanedUp;
+    int m_status;
+    QString m_error;
+    QElapsedTimer m_timer;
+    QFile m_logfile;
+    QTextStream m_logstream;
+
+    void addConnection(QIODevice *socket);
+    void send(QIODevice *socket, const QJsonObject &message);
+    /** @brief Give the next pending range to an idle worker, or tell it to quit. */
+    void dispatch(QIODevice *socket);
+    void rangeFailed(Worker &worker, const QString &error);
+    /** @brief Fail the render if every worker left while ranges are pending. */
+    void checkWorkersLeft();
+    void updateProgress();
+    void joinParts();
+    void finish(int status, const QString &error);
+    void initKdenliveDbusInterface();
+};
+
+#endif
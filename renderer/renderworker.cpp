@@ -0,0 +1,221 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "renderworker.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QHostInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QProcessEnvironment>
+#include <QStandardPaths>
+#include <QTcpSocket>
+
+RenderWorker::RenderWorker(const QString &address, const QString &token, const QString &renderer) :
+    QObject(),
+    m_address(address),
+    m_token(token),
+    m_renderer(renderer.isEmpty() ? QStandardPaths::findExecutable(QStringLiteral("melt")) : renderer),
+    m_socket(nullptr),
+    m_renderProcess(nullptr),
+    m_range(-1),
+    m_progress(0)
+{
+}
+
+RenderWorker::~RenderWorker()
+{
+    stopRender();
+}
+
+void RenderWorker::stopRender()
+{
+    if (m_renderProcess && m_renderProcess->state() != QProcess::NotRunning) {
+        m_renderProcess->blockSignals(true);
+        m_renderProcess->kill();
+        m_renderProcess->waitForFinished();
+        m_renderProcess->blockSignals(false);
+    }
+}
+
+bool RenderWorker::start()
+{
+    bool isPort;
+    const int port = m_address.section(QLatin1Char(':'), -1).toInt(&isPort);
+    bool connected;
+    if (isPort && m_address.contains(QLatin1Char(':'))) {
+        QTcpSocket *socket = new QTcpSocket(this);
+        socket->connectToHost(m_address.section(QLatin1Char(':'), 0, -2), (quint16) port);
+        connected = socket->waitForConnected(10000);
+        m_socket = socket;
+    } else {
+        QLocalSocket *socket = new QLocalSocket(this);
+        socket->connectToServer(m_address);
+        connected = socket->waitForConnected(10000);
+        m_socket = socket;
+    }
+    if (!connected) {
+        qWarning() << "Cannot connect to render coordinator" << m_address;
+        return false;
+    }
+    connect(m_socket, &QIODevice::readyRead, this, &RenderWorker::slotReadCommand);
+    connect(m_socket, SIGNAL(disconnected()), this, SLOT(slotDisconnected()));
+    QJsonObject message;
+    message.insert(QStringLiteral("type"), QStringLiteral("hello"));
+    message.insert(QStringLiteral("name"), QStringLiteral("%1/%2").arg(QHostInfo::localHostName()).arg(QCoreApplication::applicationPid()));
+    message.insert(QStringLiteral("token"), m_token);
+    send(message);
+    return true;
+}
+
+void RenderWorker::send(const QJsonObject &message)
+{
+    m_socket->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void RenderWorker::slotReadCommand()
+{
+    while (m_socket->canReadLine()) {
+        const QJsonObject command = QJsonDocument::fromJson(m_socket->readLine()).object();
+        const QString type = command.value(QStringLiteral("type")).toString();
+        if (type == QLatin1String("render")) {
+            render(command);
+        } else if (type == QLatin1String("quit")) {
+            stopRender();
+            qApp->quit();
+            return;
+        }
+    }
+}
+
+void RenderWorker::slotDisconnected()
+{
+    qWarning() << "Render coordinator closed the connection";
+    stopRender();
+    qApp->quit();
+}
+
+void RenderWorker::sendFailed(int range, const QString &error)
+{
+    QJsonObject message;
+    message.insert(QStringLiteral("type"), QStringLiteral("failed"));
+    message.insert(QStringLiteral("id"), range);
+    message.insert(QStringLiteral("error"), error);
+    send(message);
+}
+
+void RenderWorker::render(const QJsonObject &command)
+{
+    if (m_renderProcess && m_renderProcess->state() != QProcess::NotRunning) {
+        sendFailed(command.value(QStringLiteral("id")).toInt(), QStringLiteral("worker busy"));
+        return;
+    }
+    if (m_renderer.isEmpty()) {
+        sendFailed(command.value(QStringLiteral("id")).toInt(), QStringLiteral("melt not found on %1").arg(QHostInfo::localHostName()));
+        return;
+    }
+    m_range = command.value(QStringLiteral("id")).toInt();
+    m_progress = 0;
+    m_errorMessage.clear();
+
+    // Same command line as RenderJob, limited to the requested range
+    const QString scenelist = command.value(QStringLiteral("scenelist")).toString();
+    const QString profile = command.value(QStringLiteral("profile")).toString();
+    QStringList args;
+    args << scenelist;
+    args << QStringLiteral("in=") + QString::number(command.value(QStringLiteral("in")).toInt());
+    args << QStringLiteral("out=") + QString::number(command.value(QStringLiteral("out")).toInt());
+    for (const QJsonValue &value : command.value(QStringLiteral("preargs")).toArray()) {
+        args << value.toString();
+    }
+    if (scenelist.startsWith(QLatin1String("consumer:"))) {
+        args << QStringLiteral("profile=") + profile;
+    }
+    args << QStringLiteral("-profile") << profile;
+    args << QStringLiteral("-consumer") << command.value(QStringLiteral("rendermodule")).toString() + QLatin1Char(':') + command.value(QStringLiteral("dest")).toString() << QStringLiteral("progress=1");
+    for (const QJsonValue &value : command.value(QStringLiteral("args")).toArray()) {
+        args << value.toString();
+    }
+
+    if (!m_renderProcess) {
+        m_renderProcess = new QProcess(this);
+        m_renderProcess->setReadChannel(QProcess::StandardError);
+        connect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderWorker::receivedStderr);
+        connect(m_renderProcess, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &RenderWorker::slotRenderFinished);
+        connect(m_renderProcess, &QProcess::errorOccurred, this, &RenderWorker::slotRenderError);
+    }
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("MLT_NO_VDPAU"), QStringLiteral("1"));
+    const QString locale = command.value(QStringLiteral("locale")).toString();
+    if (!locale.isEmpty()) {
+        env.insert(QStringLiteral("LC_NUMERIC"), locale);
+    }
+    m_renderProcess->setProcessEnvironment(env);
+    // Only the local melt is run, the coordinator just describes the range
+    m_renderProcess->start(m_renderer, args);
+}
+
+void RenderWorker::slotRenderError(QProcess::ProcessError error)
+{
+    // Other errors are followed by finished()
+    if (error != QProcess::FailedToStart || m_range < 0) {
+        return;
+    }
+    const int range = m_range;
+    m_range = -1;
+    sendFailed(range, QStringLiteral("cannot start %1: %2").arg(m_renderer, m_renderProcess->errorString()));
+}
+
+void RenderWorker::receivedStderr()
+{
+    const QString result = QString::fromLocal8Bit(m_renderProcess->readAllStandardError()).simplified();
+    if (!result.startsWith(QLatin1String("Current Frame"))) {
+        m_errorMessage.append(result + QStringLiteral("<br>"));
+        return;
+    }
+    const int progress = result.section(QLatin1Char(' '), -1).toInt();
+    if (progress <= m_progress || progress <= 0 || progress > 100) {
+        return;
+    }
+    m_progress = progress;
+    QJsonObject message;
+    message.insert(QStringLiteral("type"), QStringLiteral("progress"));
+    message.insert(QStringLiteral("id"), m_range);
+    message.insert(QStringLiteral("progress"), m_progress);
+    send(message);
+}
+
+void RenderWorker::slotRenderFinished(int exitCode, QProcess::ExitStatus status)
+{
+    if (m_range < 0) {
+        return;
+    }
+    QJsonObject message;
+    message.insert(QStringLiteral("id"), m_range);
+    if (status == QProcess::NormalExit && exitCode == 0) {
+        message.insert(QStringLiteral("type"), QStringLiteral("done"));
+    } else {
+        message.insert(QStringLiteral("type"), QStringLiteral("failed"));
+        message.insert(QStringLiteral("error"), m_errorMessage.isEmpty() ? m_renderProcess->errorString() : m_errorMessage);
+    }
+    m_range = -1;
+    send(message);
+}
@@ -0,0 +1,72 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef RENDERWORKER_H
+#define RENDERWORKER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QJsonObject>
+
+class QIODevice;
+
+/**
+  Renders the frame ranges sent by a RenderCoordinator, one at a time,
+  until the coordinator tells it to quit or the connection is lost.
+  */
+class RenderWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @param address host:port for TCP, otherwise a local socket name
+     *  @param token secret shared with the coordinator
+     *  @param renderer melt executable, found in the PATH if empty. It is never taken from the coordinator */
+    RenderWorker(const QString &address, const QString &token, const QString &renderer = QString());
+    ~RenderWorker();
+
+public slots:
+    /** @brief Connect to the coordinator, returns false if it cannot be reached. */
+    bool start();
+
+private slots:
+    void slotReadCommand();
+    void slotDisconnected();
+    void receivedStderr();
+    void slotRenderFinished(int exitCode, QProcess::ExitStatus status);
+    void slotRenderError(QProcess::ProcessError error);
+
+private:
+    QString m_address;
+    QString m_token;
+    QString m_renderer;
+    QIODevice *m_socket;
+    QProcess *m_renderProcess;
+    int m_range;
+    int m_progress;
+    QString m_errorMessage;
+
+    void send(const QJsonObject &message);
+    void render(const QJsonObject &command);
+    void sendFailed(int range, const QString &error);
+    /** @brief Kill the running melt and wait for it, so that it does not write to the range file anymore. */
+    void stopRender();
+};
+
+#endif
@@ -67,6 +67,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QtConcurrent>
 #include <QUndoCommand>
 #include <QCryptographicHash>
+#include <QSysInfo>
 
 MyListView::MyListView(QWidget *parent) : QListView(parent)
 {
@@ -691,6 +692,7 @@ Bin::Bin(QWidget *parent) :
     m_infoMessage->hide();
     connect(this, SIGNAL(requesteInvalidRemoval(QString, QString, QString)), this, SLOT(slotQueryRemoval(QString, QString, QString)));
     connect(this, &Bin::refreshAudioThumbs, this, &Bin::doRefreshAudioThumbs);
+    connect(this, &Bin::openClip, this, &Bin::slotBoostOpenedClip);
     connect(this, SIGNAL(displayBinMessage(QString, KMessageWidget::MessageType)), this, SLOT(doDisplayMessage(QString, KMessageWidget::MessageType)));
 }
 
@@ -2110,6 +2112,48 @@ void Bin::slotThumbnailReady(const QString &id, const QImage &img, bool fromFile
     }
 }
 
+void Bin::slotThumbnailsReady(const QMap<QString, QImage> &thumbs)
+{
+    QList<AbstractProjectItem *> updated;
+    QMapIterator<QString, QImage> i(thumbs);
+    while (i.hasNext()) {
+        i.next();
+        ProjectClip *clip = m_rootFolder->clip(i.key());
+        if (clip) {
+            clip->setThumbnail(i.value(), false);
+            updated << clip;
+        }
+    }
+    m_itemModel->onItemsUpdated(updated);
+}
+
+QStringList Bin::visibleClipIds() const
+{
+    QStringList ids;
+    if (m_itemView) {
+        visibleClipIds(m_itemView->rootIndex(), ids);
+    }
+    return ids;
+}
+
+void Bin::visibleClipIds(const QModelIndex &parent, QStringList &ids) const
+{
+    const QRect viewRect = m_itemView->viewport()->rect();
+    QTreeView *tree = m_listType == BinTreeView ? static_cast<QTreeView *>(m_itemView) : nullptr;
+    for (int row = 0; row < m_proxyModel->rowCount(parent); ++row) {
+        QModelIndex ix = m_proxyModel->index(row, 0, parent);
+        if (m_itemView->visualRect(ix).intersects(viewRect)) {
+            AbstractProjectItem *item = static_cast<AbstractProjectItem *>(m_proxyModel->mapToSource(ix).internalPointer());
+            if (item && item->itemType() == AbstractProjectItem::ClipItem) {
+                ids << item->clipId();
+            }
+        }
+        if (tree && tree->isExpanded(ix)) {
+            visibleClipIds(ix, ids);
+        }
+    }
+}
+
 QStringList Bin::getBinFolderClipIds(const QString &id) const
 {
     QStringList ids;
@@ -2144,6 +2188,23 @@ void Bin::setWaitingStatus(const QString &id)
     }
 }
 
+void Bin::slotGotDecodeSpeed(const QString &id, double fps)
+{
+    ProjectClip *clip = m_rootFolder->clip(id);
+    if (!clip) {
+        return;
+    }
+    clip->setProducerProperty(QStringLiteral("kdenlive:decodefps"), fps);
+    clip->setProducerProperty(QStringLiteral("kdenlive:decodehost"), QSysInfo::machineHostName());
+    if (!m_doc->useProxy() || clip->hasProxy() || clip->getProducerProperty(QStringLiteral("kdenlive:proxy")) == QLatin1String("-")) {
+        // Proxy disabled, already there or manually removed by the user
+        return;
+    }
+    if (m_doc->autoGenerateSlowProxy(fps) && !hasPendingJob(id, AbstractClipJob::PROXYJOB)) {
+        m_doc->slotProxyCurrentItem(true, QList<ProjectClip *>() << clip);
+    }
+}
+
 void Bin::slotRemoveInvalidClip(const QString &id, bool replace, const QString &errorMessage)
 {
     Q_UNUSED(replace)
@@ -2169,7 +2230,7 @@ void Bin::slotProducerReady(const requestClipInfo &info, ClipController *control
             if (m_doc->useProxy()) {
                 if (t == AV || t == Video) {
                     int width = clip->getProducerIntProperty(QStringLiteral("meta.media.width"));
-                    if (m_doc->autoGenerateProxy(width)) {
+                    if (m_doc->autoGenerateProxy(width) || m_doc->autoGenerateSlowProxy(clip->decodeSpeed())) {
                         // Start proxy
                         m_doc->slotProxyCurrentItem(true, QList<ProjectClip *>() << clip);
                     }
@@ -2183,6 +2244,13 @@ void Bin::slotProducerReady(const requestClipInfo &info, ClipController *control
             }
         } else {
             emit producerReady(info.clipId);
+            if (clip->clipType() == Playlist && clip->hasProxy() && m_doc->useProxy() && !hasPendingJob(info.clipId, AbstractClipJob::PROXYJOB)) {
+                // Playlist proxies are named after the signature of the nested media, recomputed on each load
+                const QString proxy = clip->getProducerProperty(QStringLiteral("kdenlive:proxy"));
+                if (!QFileInfo(proxy).completeBaseName().contains(clip->mediaSignature())) {
+                    m_doc->slotProxyCurrentItem(true, QList<ProjectClip *>() << clip, true);
+                }
+            }
         }
         QString currentClip = m_monitor->activeClipId();
         if (currentClip.isEmpty()) {
@@ -2529,6 +2597,26 @@ bool Bin::hasPendingJob(const QString &id, AbstractClipJob::JOBTYPE type)
     return m_jobManager->hasPendingJob(id, type);
 }
 
+void Bin::boostClipJobs(const QString &id)
+{
+    if (m_jobManager) {
+        m_jobManager->boostClip(id);
+    }
+}
+
+void Bin::slotBoostOpenedClip(ClipController *controller)
+{
+    if (controller) {
+        boostClipJobs(controller->clipId());
+    }
+}
+
+bool Bin::isClipActive(ProjectClip *clip)
+{
+    // The usage count is kept by the timeline, no need to search the tracks
+    return clip->refCount() > 0 || (m_monitor && m_monitor->activeClipId() == clip->clipId());
+}
+
 void Bin::slotCreateProjectClip()
 {
     QAction *act = qobject_cast<QAction *>(sender());
@@ -3230,6 +3318,61 @@ void Bin::updateTimecodeFormat()
     emit refreshTimeCode();
 }
 
+void Bin::slotGotLoudnessResults(const QString &id, const stringMap &results, const stringMap &extra)
+{
+    ProjectClip *clip = getBinClip(id);
+    if (!clip) {
+        return;
+    }
+    QUndoCommand *command = new QUndoCommand();
+    command->setText(i18n("Loudness analysis"));
+    QMapIterator<QString, QString> i(results);
+    while (i.hasNext()) {
+        i.next();
+        slotAddClipExtraData(id, i.key(), i.value(), command);
+    }
+    if (extra.contains(QStringLiteral("target"))) {
+        double gain = extra.value(QStringLiteral("target")).toDouble() - results.value(QStringLiteral("kdenlive:loudness.integrated")).toDouble();
+        gain = qBound(-60.0, gain, 60.0);
+        QString level = QString::number(gain, 'f', 2);
+        QDomElement effect = MainWindow::audioEffects.getEffectByTag(QStringLiteral("volume"), QStringLiteral("volume")).cloneNode().toElement();
+        if (!effect.isNull()) {
+            EffectsList::setParameter(effect, QStringLiteral("level"), level);
+            // The analysis is done on the source file, so a previous normalization
+            // is replaced rather than stacked. It is the volume effect still set
+            // to the gain we applied, a volume the user edited is left alone.
+            QDomElement previous;
+            QString previousGain = clip->getProducerProperty(QStringLiteral("kdenlive:loudness.gain"));
+            if (!previousGain.isEmpty()) {
+                EffectsList effects = clip->controller()->effectList();
+                for (int ix = 0; ix < effects.count(); ++ix) {
+                    QDomElement current = effects.at(ix);
+                    if (current.attribute(QStringLiteral("id")) != QLatin1String("volume")) {
+                        continue;
+                    }
+                    // Animated parameters may be stored as a single keyframe
+                    QString currentLevel = EffectsList::parameter(current, QStringLiteral("level")).section(QLatin1Char('='), -1);
+                    if (qAbs(currentLevel.toDouble() - previousGain.toDouble()) < 0.005) {
+                        previous = current.cloneNode().toElement();
+                        break;
+                    }
+                }
+            }
+            if (!previous.isNull()) {
+                effect.setAttribute(QStringLiteral("kdenlive_ix"), previous.attribute(QStringLiteral("kdenlive_ix")));
+                new UpdateBinEffectCommand(this, id, previous, effect, previous.attribute(QStringLiteral("kdenlive_ix")).toInt(), true, true, command);
+            } else {
+                new AddBinEffectCommand(this, id, effect, command);
+            }
+            slotAddClipExtraData(id, QStringLiteral("kdenlive:loudness.gain"), level, command);
+            command->setText(i18n("Normalize loudness"));
+        } else {
+            emit displayBinMessage(i18n("Cannot find the volume effect to normalize clip"), KMessageWidget::Warning);
+        }
+    }
+    m_doc->commandStack()->push(command);
+}
+
 void Bin::slotGotFilterJobResults(const QString &id, int startPos, int track, const stringMap &results, const stringMap &filterInfo)
 {
     if (filterInfo.contains(QStringLiteral("finalfilter"))) {
@@ -3829,7 +3972,7 @@ void Bin::refreshProxySettings()
                 toProxy << clp;
                 continue;
             } else if ((t == AV || t == Video)
-                       && m_doc->autoGenerateProxy(clp->getProducerIntProperty(QStringLiteral("meta.media.width")))) {
+                       && (m_doc->autoGenerateProxy(clp->getProducerIntProperty(QStringLiteral("meta.media.width"))) || m_doc->autoGenerateSlowProxy(clp->decodeSpeed()))) {
                 // Start proxy
                 toProxy << clp;
                 continue;
@@ -220,6 +220,12 @@ public:
     /** @brief Check if there is a job waiting / running for this clip  */
     bool hasPendingJob(const QString &id, AbstractClipJob::JOBTYPE type);
 
+    /** @brief Process the jobs of this clip before the other ones, the user is working on it */
+    void boostClipJobs(const QString &id);
+
+    /** @brief Returns true if the clip is displayed in the clip monitor or used in timeline */
+    bool isClipActive(ProjectClip *clip);
+
     /** @brief Reload / replace a producer */
     void reloadProducer(const QString &id, const QDomElement &xml);
 
@@ -277,6 +283,8 @@ public:
     void focusBinView() const;
     /** @brief Get a string list of all clip ids that are inside a folder defined by id. */
     QStringList getBinFolderClipIds(const QString &id) const;
+    /** @brief Returns the ids of the clips currently visible in the Bin view, used to prioritize thumbnail loading */
+    QStringList visibleClipIds() const;
     /** @brief Build a rename folder command. */
     void renameFolderCommand(const QString &id, const QString &newName, const QString &oldName);
     /** @brief Rename a folder and store new name in MLT. */
@@ -347,6 +355,8 @@ public:
     void saveZone(const QStringList &info, const QDir &dir);
 
 private slots:
+    /** @brief Boost the jobs of the clip opened in the clip monitor */
+    void slotBoostOpenedClip(ClipController *controller);
     void slotAddClip();
     void slotReloadClip();
     /** @brief Set sorting column */
@@ -380,6 +390,8 @@ private slots:
     void slotShowJobLog();
     /** @brief process clip job result. */
     void slotGotFilterJobResults(const QString &, int, int, const stringMap &, const stringMap &);
+    /** @brief Store the result of a loudness analysis and apply the normalization gain if requested. */
+    void slotGotLoudnessResults(const QString &id, const stringMap &results, const stringMap &extra);
     /** @brief Reset all text and log data from info message widget. */
     void slotResetInfoMessage();
     /** @brief Show dialog prompting for removal of invalid clips. */
@@ -409,12 +421,16 @@ private slots:
 
 public slots:
     void slotThumbnailReady(const QString &id, const QImage &img, bool fromFile = false);
+    /** @brief A batch of cached thumbnails was loaded on project opening, update the view once */
+    void slotThumbnailsReady(const QMap<QString, QImage> &thumbs);
     /** @brief The producer for this clip is ready.
      *  @param id the clip id
      *  @param controller The Controller for this clip
      */
     void slotProducerReady(const requestClipInfo &info, ClipController *controller);
     void slotRemoveInvalidClip(const QString &id, bool replace, const QString &errorMessage);
+    /** @brief The decoding speed of a clip was measured, create a proxy if it is too slow */
+    void slotGotDecodeSpeed(const QString &id, double fps);
     /** @brief Create a folder when opening a document */
     void slotLoadFolders(const QMap<QString, QString> &foldersData);
     /** @brief Reload clip thumbnail - when frame for thumbnail changed */
@@ -546,6 +562,8 @@ private:
     void showClipProperties(ProjectClip *clip, bool forceRefresh = false);
     /** @brief Get the QModelIndex value for an item in the Bin. */
     QModelIndex getIndexForId(const QString &id, bool folderWanted) const;
+    /** @brief Collect ids of the clips currently visible in the item view */
+    void visibleClipIds(const QModelIndex &parent, QStringList &ids) const;
     /** @brief Get a Clip item from its id. */
     AbstractProjectItem *getClipForId(const QString &id) const;
     ProjectClip *getFirstSelectedClip();
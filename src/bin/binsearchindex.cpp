@@ -0,0 +1,139 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "binsearchindex.h"
+#include "abstractprojectitem.h"
+
+#include <algorithm>
+
+BinSearchIndex::BinSearchIndex() :
+    m_cacheValid(false)
+{
+}
+
+QSet<quint64> BinSearchIndex::trigrams(const QString &text)
+{
+    QSet<quint64> result;
+    const ushort *data = text.utf16();
+    for (int i = 0; i + 2 < text.length(); ++i) {
+        result.insert(((quint64) data[i] << 32) | ((quint64) data[i + 1] << 16) | (quint64) data[i + 2]);
+    }
+    return result;
+}
+
+bool BinSearchIndex::updateItem(AbstractProjectItem *item, const QString &text)
+{
+    const QString lower = text.toLower();
+    QHash<AbstractProjectItem *, QString>::const_iterator it = m_texts.constFind(item);
+    if (it != m_texts.constEnd() && it.value() == lower) {
+        return false;
+    }
+    removeItem(item);
+    m_texts.insert(item, lower);
+    for (quint64 key : trigrams(lower)) {
+        m_trigrams[key].insert(item);
+    }
+    m_cacheValid = false;
+    return true;
+}
+
+void BinSearchIndex::removeItem(AbstractProjectItem *item)
+{
+    QHash<AbstractProjectItem *, QString>::iterator it = m_texts.find(item);
+    if (it == m_texts.end()) {
+        return;
+    }
+    for (quint64 key : trigrams(it.value())) {
+        QHash<quint64, QSet<AbstractProjectItem *> >::iterator t = m_trigrams.find(key);
+        if (t != m_trigrams.end()) {
+            t.value().remove(item);
+            if (t.value().isEmpty()) {
+                m_trigrams.erase(t);
+            }
+        }
+    }
+    m_texts.erase(it);
+    m_cacheValid = false;
+}
+
+void BinSearchIndex::clear()
+{
+    m_texts.clear();
+    m_trigrams.clear();
+    m_accepted.clear();
+    m_cacheValid = false;
+}
+
+void BinSearchIndex::search(const QString &query)
+{
+    m_accepted.clear();
+    m_cachedQuery = query;
+    m_cacheValid = true;
+    const QString lower = query.toLower();
+    QList<AbstractProjectItem *> matches;
+    if (lower.length() < 3) {
+        // Too short for trigram lookup, scan the indexed texts
+        for (auto it = m_texts.constBegin(); it != m_texts.constEnd(); ++it) {
+            if (it.value().contains(lower)) {
+                matches << it.key();
+            }
+        }
+    } else {
+        // Intersect the candidate sets, starting from the smallest one
+        const QSet<quint64> keys = trigrams(lower);
+        QList<const QSet<AbstractProjectItem *> *> sets;
+        for (quint64 key : keys) {
+            QHash<quint64, QSet<AbstractProjectItem *> >::const_iterator t = m_trigrams.constFind(key);
+            if (t == m_trigrams.constEnd()) {
+                return;
+            }
+            sets << &t.value();
+        }
+        std::sort(sets.begin(), sets.end(), [](const QSet<AbstractProjectItem *> *a, const QSet<AbstractProjectItem *> *b) {
+            return a->count() < b->count();
+        });
+        for (AbstractProjectItem *item : *sets.first()) {
+            bool candidate = true;
+            for (int i = 1; i < sets.count() && candidate; ++i) {
+                candidate = sets.at(i)->contains(item);
+            }
+            // Trigrams do not guarantee order, check the actual text
+            if (candidate && m_texts.value(item).contains(lower)) {
+                matches << item;
+            }
+        }
+    }
+    // Folders containing a match must stay visible
+    for (AbstractProjectItem *item : matches) {
+        while (item && !m_accepted.contains(item)) {
+            m_accepted.insert(item);
+            item = item->parent();
+        }
+    }
+}
+
+bool BinSearchIndex::accepts(AbstractProjectItem *item, const QString &searchString)
+{
+    if (!m_cacheValid || m_cachedQuery != searchString) {
+        search(searchString);
+    }
+    return m_accepted.contains(item);
+}
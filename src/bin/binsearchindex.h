@@ -0,0 +1,69 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BINSEARCHINDEX_H
+#define BINSEARCHINDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+class AbstractProjectItem;
+
+/**
+ * @class BinSearchIndex
+ * @brief Trigram index over the searchable text of bin items (name, date, description, markers).
+ *
+ * The index is maintained by ProjectItemModel when items are added, updated or removed,
+ * so that the bin filter does not need to query every column of every item on each keystroke.
+ * Search results for the current query are cached until the index changes.
+ */
+
+class BinSearchIndex
+{
+public:
+    BinSearchIndex();
+
+    /** @brief Index (or re-index) an item with its searchable text.
+     *  @return true if the indexed text changed */
+    bool updateItem(AbstractProjectItem *item, const QString &text);
+    /** @brief Remove an item from the index */
+    void removeItem(AbstractProjectItem *item);
+    void clear();
+    /** @brief Returns true if the item matches the search string or has a matching descendant */
+    bool accepts(AbstractProjectItem *item, const QString &searchString);
+
+private:
+    /** @brief Lower case searchable text for each indexed item */
+    QHash<AbstractProjectItem *, QString> m_texts;
+    /** @brief Items containing each trigram */
+    QHash<quint64, QSet<AbstractProjectItem *> > m_trigrams;
+    /** @brief Query for which m_accepted was computed */
+    QString m_cachedQuery;
+    bool m_cacheValid;
+    /** @brief Matching items and all their ancestors for the cached query */
+    QSet<AbstractProjectItem *> m_accepted;
+
+    static QSet<quint64> trigrams(const QString &text);
+    void search(const QString &query);
+};
+
+#endif
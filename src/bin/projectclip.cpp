@@ -39,6 +39,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDir>
 #include "kdenlive_debug.h"
 #include <QCryptographicHash>
+#include <QSysInfo>
 #include <QtConcurrent>
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -316,7 +317,7 @@ QDomElement ProjectClip::toXml(QDomDocument &document, bool includeMeta)
     }
 }
 
-void ProjectClip::setThumbnail(const QImage &img)
+void ProjectClip::setThumbnail(const QImage &img, bool notify)
 {
     QPixmap thumb = roundedPixmap(QPixmap::fromImage(img));
     if (hasProxy() && !thumb.isNull()) {
@@ -334,7 +335,9 @@ void ProjectClip::setThumbnail(const QImage &img)
     }
     m_thumbnail = QIcon(thumb);
     emit thumbUpdated(img);
-    bin()->emitItemUpdated(this);
+    if (notify) {
+        bin()->emitItemUpdated(this);
+    }
 }
 
 QPixmap ProjectClip::thumbnail(int width, int height)
@@ -598,6 +601,69 @@ const QString ProjectClip::getFileHash() const
     return result;
 }
 
+const QString ProjectClip::mediaSignature()
+{
+    if (m_type != Playlist || !m_controller) {
+        return QString();
+    }
+    // The playlist itself is included, the content hash being computed only once
+    QFileInfo info(m_controller->clipUrl());
+    QByteArray data = info.absoluteFilePath().toUtf8();
+    data.append(QByteArray::number(info.size()));
+    data.append(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    QStringList visited;
+    data.append(playlistMediaInfo(info.absoluteFilePath(), visited));
+    QString result = QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+    m_controller->setProperty(QStringLiteral("kdenlive:media_signature"), result);
+    return result;
+}
+
+// static
+QByteArray ProjectClip::playlistMediaInfo(const QString &path, QStringList &visited)
+{
+    QByteArray result;
+    QFileInfo info(path);
+    if (visited.contains(info.absoluteFilePath()) || visited.count() > 20) {
+        return result;
+    }
+    visited << info.absoluteFilePath();
+    QFile file(path);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file)) {
+        return result;
+    }
+    file.close();
+    QString root = doc.documentElement().attribute(QStringLiteral("root"));
+    if (root.isEmpty()) {
+        root = info.absolutePath();
+    }
+    QDir rootDir(root);
+    QDomNodeList props = doc.elementsByTagName(QStringLiteral("property"));
+    for (int i = 0; i < props.count(); ++i) {
+        QDomElement prop = props.at(i).toElement();
+        const QString name = prop.attribute(QStringLiteral("name"));
+        if (name != QLatin1String("resource") && name != QLatin1String("warp_resource")) {
+            continue;
+        }
+        const QString resource = prop.text().section(QLatin1Char('?'), 0, 0);
+        if (resource.isEmpty() || (resource.contains(QLatin1Char(':')) && !QFileInfo(resource).isAbsolute())) {
+            // Not a file (color, consumer, ...)
+            continue;
+        }
+        QFileInfo media(rootDir, resource);
+        if (!media.isFile()) {
+            continue;
+        }
+        result.append(media.absoluteFilePath().toUtf8());
+        result.append(QByteArray::number(media.size()));
+        result.append(QByteArray::number(media.lastModified().toMSecsSinceEpoch()));
+        if (media.suffix() == QLatin1String("mlt") || media.suffix() == QLatin1String("kdenlive")) {
+            result.append(playlistMediaInfo(media.absoluteFilePath(), visited));
+        }
+    }
+    return result;
+}
+
 double ProjectClip::getOriginalFps() const
 {
     if (!m_controller) {
@@ -606,6 +672,16 @@ double ProjectClip::getOriginalFps() const
     return m_controller->originalFps();
 }
 
+double ProjectClip::decodeSpeed() const
+{
+    // Measures from another computer are meaningless
+    if (getProducerProperty(QStringLiteral("kdenlive:decodehost")) != QSysInfo::machineHostName()) {
+        return -1;
+    }
+    double fps = getDoubleProducerProperty(QStringLiteral("kdenlive:decodefps"));
+    return fps > 0 ? fps : -1;
+}
+
 bool ProjectClip::hasProxy() const
 {
     QString proxy = getProducerProperty(QStringLiteral("kdenlive:proxy"));
@@ -838,6 +914,8 @@ void ProjectClip::addMarkers(QList<CommentedTime> &markers)
     bin()->refreshClipMarkers(m_id);
     // refresh markers in timeline clips
     emit refreshClipDisplay();
+    // markers text is part of the bin search index
+    bin()->emitItemUpdated(this);
 }
 
 void ProjectClip::addEffect(const ProfileInfo &pInfo, QDomElement &effect)
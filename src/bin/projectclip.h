@@ -109,6 +109,8 @@ public:
 
     /** @brief Returns the original clip's fps. */
     double getOriginalFps() const;
+    /** @brief Returns the number of frames per second this computer can decode, -1 if not measured. */
+    double decodeSpeed() const;
 
     /** @brief Calls AbstractProjectItem::setCurrent and sets the bin monitor to use the clip's producer. */
     void setCurrent(bool current, bool notify = true) Q_DECL_OVERRIDE;
@@ -119,8 +121,9 @@ public:
 
     QVariant data(DataType type) const Q_DECL_OVERRIDE;
 
-    /** @brief Sets thumbnail for this clip. */
-    void setThumbnail(const QImage &);
+    /** @brief Sets thumbnail for this clip.
+     *  @param notify if false, the bin model is not notified (used when updating thumbnails in batch) */
+    void setThumbnail(const QImage &, bool notify = true);
     QPixmap thumbnail(int width, int height);
 
     /** @brief Sets the MLT producer associated with this clip
@@ -149,6 +152,9 @@ public:
 
     /** @brief The clip hash created from the clip's resource. */
     const QString hash();
+    /** @brief For playlist clips, compute and store a signature of the playlist and of the media it uses.
+     *  It changes when nested media are modified and is only used to invalidate the proxy, hash() staying content only. */
+    const QString mediaSignature();
 
     /** @brief Set a property on the MLT producer. */
     void setProducerProperty(const QString &name, int data);
@@ -234,6 +240,9 @@ private:
     ClipController *m_controller;
     /** @brief Generate and store file hash if not available. */
     const QString getFileHash() const;
+    /** @brief Returns path, size and modification date of the media used in an MLT playlist, recursively.
+     *  @param visited the playlists already parsed, to stop on circular references */
+    static QByteArray playlistMediaInfo(const QString &path, QStringList &visited);
     /** @brief Store clip url temporarily while the clip controller has not been created. */
     QString m_temporaryUrl;
     ClipType m_type;
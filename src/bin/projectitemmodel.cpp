@@ -87,6 +87,7 @@ bool ProjectItemModel::setData(const QModelIndex &index, const QVariant &value,
 {
     AbstractProjectItem *item = static_cast<AbstractProjectItem *>(index.internalPointer());
     if (item->rename(value.toString(), index.column())) {
+        m_searchIndex.updateItem(item, searchText(item));
         emit dataChanged(index, index, QVector<int> () << role);
         return true;
     }
@@ -301,7 +302,7 @@ void ProjectItemModel::onAboutToAddItem(AbstractProjectItem *item)
 
 void ProjectItemModel::onItemAdded(AbstractProjectItem *item)
 {
-    Q_UNUSED(item)
+    indexItem(item);
     endInsertRows();
 }
 
@@ -315,7 +316,7 @@ void ProjectItemModel::onAboutToRemoveItem(AbstractProjectItem *item)
     if (parentItem != m_bin->rootFolder()) {
         parentIndex = createIndex(parentItem->index(), 0, parentItem);
     }
-
+    unindexItem(item);
     beginRemoveRows(parentIndex, item->index(), item->index());
 }
 
@@ -338,5 +339,81 @@ void ProjectItemModel::onItemUpdated(AbstractProjectItem *item)
     if (parentItem != m_bin->rootFolder()) {
         parentIndex = createIndex(parentItem->index(), 0, parentItem);
     }
+    if (m_searchIndex.updateItem(item, searchText(item))) {
+        // Searchable text changed, let the filter proxy re-evaluate this item and its folders
+        AbstractProjectItem *changed = item;
+        while (changed && changed != m_bin->rootFolder()) {
+            emit dataChanged(createIndex(changed->index(), 0, changed), createIndex(changed->index(), columnCount() - 1, changed));
+            changed = changed->parent();
+        }
+    }
     emit dataChanged(parentIndex, parentIndex);
 }
+
+void ProjectItemModel::onItemsUpdated(const QList<AbstractProjectItem *> &items)
+{
+    // Group items by parent to emit a single change for the range of updated rows
+    QHash<AbstractProjectItem *, QPair<int, int> > ranges;
+    for (AbstractProjectItem *item : items) {
+        AbstractProjectItem *parentItem = item->parent();
+        if (parentItem == nullptr || item->clipStatus() == AbstractProjectItem::StatusDeleting) {
+            continue;
+        }
+        int row = item->index();
+        if (ranges.contains(parentItem)) {
+            QPair<int, int> &range = ranges[parentItem];
+            range.first = qMin(range.first, row);
+            range.second = qMax(range.second, row);
+        } else {
+            ranges.insert(parentItem, QPair<int, int>(row, row));
+        }
+    }
+    QHashIterator<AbstractProjectItem *, QPair<int, int> > i(ranges);
+    while (i.hasNext()) {
+        i.next();
+        AbstractProjectItem *parentItem = i.key();
+        QModelIndex parentIndex;
+        if (parentItem != m_bin->rootFolder()) {
+            parentIndex = createIndex(parentItem->index(), 0, parentItem);
+        }
+        emit dataChanged(index(i.value().first, 0, parentIndex), index(i.value().second, 0, parentIndex), QVector<int>() << Qt::DecorationRole);
+    }
+}
+
+QString ProjectItemModel::searchText(AbstractProjectItem *item) const
+{
+    QStringList text;
+    text << item->data(AbstractProjectItem::DataName).toString();
+    text << item->data(AbstractProjectItem::DataDate).toString();
+    text << item->data(AbstractProjectItem::DataDescription).toString();
+    if (item->itemType() == AbstractProjectItem::ClipItem) {
+        ProjectClip *clip = static_cast<ProjectClip *>(item);
+        const QList<CommentedTime> markers = clip->commentedSnapMarkers();
+        for (const CommentedTime &marker : markers) {
+            text << marker.comment();
+        }
+    }
+    // Separator prevents matches spanning two fields
+    return text.join(QLatin1Char('\n'));
+}
+
+void ProjectItemModel::indexItem(AbstractProjectItem *item)
+{
+    m_searchIndex.updateItem(item, searchText(item));
+    for (int i = 0; i < item->count(); ++i) {
+        indexItem(item->at(i));
+    }
+}
+
+void ProjectItemModel::unindexItem(AbstractProjectItem *item)
+{
+    m_searchIndex.removeItem(item);
+    for (int i = 0; i < item->count(); ++i) {
+        unindexItem(item->at(i));
+    }
+}
+
+bool ProjectItemModel::searchAccepts(AbstractProjectItem *item, const QString &searchString)
+{
+    return m_searchIndex.accepts(item, searchString);
+}
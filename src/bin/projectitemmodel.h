@@ -23,6 +23,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef PROJECTITEMMODEL_H
 #define PROJECTITEMMODEL_H
 
+#include "binsearchindex.h"
+
 #include <QAbstractItemModel>
 #include <QSize>
 
@@ -72,8 +74,12 @@ public:
     void onAboutToRemoveItem(AbstractProjectItem *item);
     /** @brief Prepare some stuff after removing a new item */
     void onItemRemoved(AbstractProjectItem *item);
+    /** @brief Notify views of thumbnail changes for several items, with one update per parent folder */
+    void onItemsUpdated(const QList<AbstractProjectItem *> &items);
     bool dropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column, const QModelIndex &parent) Q_DECL_OVERRIDE;
     Qt::DropActions supportedDropActions() const Q_DECL_OVERRIDE;
+    /** @brief Returns true if the item or one of its children matches the bin search string, using the search index */
+    bool searchAccepts(AbstractProjectItem *item, const QString &searchString);
 
 public slots:
     /** @brief An item in the list was modified, notify */
@@ -84,6 +90,14 @@ private:
     Bin *m_bin;
     /** @brief Return reference to column specific data */
     int mapToColumn(int column) const;
+    /** @brief Index of the searchable text of all bin items */
+    BinSearchIndex m_searchIndex;
+    /** @brief Build the text matched by the bin search for an item */
+    QString searchText(AbstractProjectItem *item) const;
+    /** @brief Add an item and its children to the search index */
+    void indexItem(AbstractProjectItem *item);
+    /** @brief Remove an item and its children from the search index */
+    void unindexItem(AbstractProjectItem *item);
 
 signals:
     //TODO
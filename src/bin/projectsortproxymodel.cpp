@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "projectsortproxymodel.h"
 #include "abstractprojectitem.h"
+#include "projectitemmodel.h"
 
 #include <QItemSelectionModel>
 
@@ -37,55 +38,16 @@ ProjectSortProxyModel::ProjectSortProxyModel(QObject *parent)
 bool ProjectSortProxyModel::filterAcceptsRow(int sourceRow,
         const QModelIndex &sourceParent) const
 {
-    if (filterAcceptsRowItself(sourceRow, sourceParent)) {
+    if (m_searchString.isEmpty()) {
         return true;
     }
-    //accept if any of the children is accepted on it's own merits
-    if (hasAcceptedChildren(sourceRow, sourceParent)) {
-        return true;
-    }
-    return false;
-}
-
-bool ProjectSortProxyModel::filterAcceptsRowItself(int sourceRow,
-        const QModelIndex &sourceParent) const
-{
-    int cols = sourceModel()->columnCount();
-    for (int i = 0; i < cols; i++) {
-        QModelIndex index0 = sourceModel()->index(sourceRow, i, sourceParent);
-        if (!index0.isValid()) {
-            return false;
-        }
-        if (sourceModel()->data(index0).toString().contains(m_searchString, Qt::CaseInsensitive)) {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool ProjectSortProxyModel::hasAcceptedChildren(int sourceRow, const QModelIndex &source_parent) const
-{
-    QModelIndex item = sourceModel()->index(sourceRow, 0, source_parent);
-    if (!item.isValid()) {
-        return false;
-    }
-
-    //check if there are children
-    int childCount = item.model()->rowCount(item);
-    if (childCount == 0) {
+    ProjectItemModel *model = static_cast<ProjectItemModel *>(sourceModel());
+    QModelIndex index0 = model->index(sourceRow, 0, sourceParent);
+    if (!index0.isValid()) {
         return false;
     }
-
-    for (int i = 0; i < childCount; ++i) {
-        if (filterAcceptsRowItself(i, item)) {
-            return true;
-        }
-        //recursive call -> NOTICE that this is depth-first searching, you're probably better off with breadth first search...
-        if (hasAcceptedChildren(i, item)) {
-            return true;
-        }
-    }
-    return false;
+    // Accepted if the item itself or any of its children matches, as reported by the search index
+    return model->searchAccepts(static_cast<AbstractProjectItem *>(index0.internalPointer()), m_searchString);
 }
 
 bool ProjectSortProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
@@ -0,0 +1,99 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "framewriter.h"
+#include "kdenlive_debug.h"
+
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QtConcurrent>
+
+// Uncompressed 4K frames take 32MB each
+static const int maxPendingFrames = 4;
+
+FrameWriter::FrameWriter(QObject *parent) : QObject(parent)
+    , m_quality(-1)
+    , m_thumbnailHeight(90)
+{
+}
+
+FrameWriter::~FrameWriter()
+{
+    m_future.waitForFinished();
+}
+
+bool FrameWriter::write(const QImage &image, const QString &path)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_queue.count() >= maxPendingFrames) {
+        return false;
+    }
+    PendingFrame frame;
+    frame.image = image;
+    frame.path = path;
+    frame.quality = m_quality;
+    frame.thumbnailHeight = m_thumbnailHeight;
+    m_queue.enqueue(frame);
+    if (m_queue.count() == 1) {
+        // The worker stops when the queue is empty
+        m_future.waitForFinished();
+        m_future = QtConcurrent::run(this, &FrameWriter::processQueue);
+    }
+    return true;
+}
+
+bool FrameWriter::isFull() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_queue.count() >= maxPendingFrames;
+}
+
+void FrameWriter::setQuality(int quality)
+{
+    QMutexLocker lock(&m_mutex);
+    m_quality = quality;
+}
+
+void FrameWriter::setThumbnailHeight(int height)
+{
+    QMutexLocker lock(&m_mutex);
+    m_thumbnailHeight = height;
+}
+
+void FrameWriter::processQueue()
+{
+    QMutexLocker lock(&m_mutex);
+    while (!m_queue.isEmpty()) {
+        const PendingFrame frame = m_queue.head();
+        lock.unlock();
+        QImageWriter writer(frame.path, QFileInfo(frame.path).suffix().toLatin1());
+        writer.setQuality(frame.quality);
+        if (writer.write(frame.image)) {
+            QImage thumbnail;
+            if (frame.thumbnailHeight > 0) {
+                thumbnail = frame.image.scaledToHeight(frame.thumbnailHeight, Qt::SmoothTransformation);
+            }
+            emit frameWritten(frame.path, thumbnail);
+        } else {
+            qCDebug(KDENLIVE_LOG) << "Cannot write frame" << frame.path << writer.errorString();
+        }
+        lock.relock();
+        m_queue.dequeue();
+    }
+}
@@ -0,0 +1,79 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FRAMEWRITER_H
+#define FRAMEWRITER_H
+
+#include <QFuture>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+
+/**
+ * @class FrameWriter
+ * @brief Writes captured frames to disk in a background thread.
+ *
+ * Images are encoded in the order they were queued, in the format given by the file
+ * extension. The thumbnail displayed in the frame list is made from the image in memory,
+ * in the same thread, so that nothing is read back from disk.
+ * Only a few frames can wait: when the disk cannot keep up write() refuses new frames,
+ * the caller decides to retry later or to drop the frame. Methods are thread safe.
+ */
+class FrameWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameWriter(QObject *parent = nullptr);
+    /** @brief Writes the remaining frames before returning. */
+    ~FrameWriter();
+
+    /** @brief Queue a frame for writing. Returns false if too many frames are waiting. */
+    bool write(const QImage &image, const QString &path);
+    /** @brief True if write() would refuse a frame. */
+    bool isFull() const;
+    /** @brief Encoder quality (0-100) for the next frames, -1 for the format's default.
+     *  For PNG, lower values mean a stronger, slower compression. */
+    void setQuality(int quality);
+    /** @brief Height of the generated thumbnails, 0 to disable them. */
+    void setThumbnailHeight(int height);
+
+private:
+    struct PendingFrame {
+        QImage image;
+        QString path;
+        int quality;
+        int thumbnailHeight;
+    };
+    mutable QMutex m_mutex;
+    /** @brief The frame being written stays at the head of the queue until it is on disk. */
+    QQueue<PendingFrame> m_queue;
+    QFuture<void> m_future;
+    int m_quality;
+    int m_thumbnailHeight;
+
+    void processQueue();
+
+signals:
+    /** @brief A frame was written, with its thumbnail if enabled. */
+    void frameWritten(const QString &path, const QImage &thumbnail);
+};
+
+#endif
@@ -16,9 +16,11 @@
  ***************************************************************************/
 
 #include "mltdevicecapture.h"
+#include "framewriter.h"
 
 #include "kdenlivesettings.h"
 #include "definitions.h"
+#include "lib/video/yuvConverter.h"
 
 #include <mlt++/Mlt.h>
 
@@ -35,6 +37,13 @@ static void consumer_gl_frame_show(mlt_consumer, MltDeviceCapture *self, mlt_fra
 {
     // detect if the producer has finished playing. Is there a better way to do it?
     Mlt::Frame frame(frame_ptr);
+    if (self->doCapture > 0) {
+        // Skip a few frames after captureFrame(), until the overlay is hidden
+        self->doCapture--;
+        if (self->doCapture == 0) {
+            self->saveFrame(frame);
+        }
+    }
     self->showFrame(frame);
 }
 
@@ -47,7 +56,9 @@ MltDeviceCapture::MltDeviceCapture(QString profile, /*VideoSurface *surface, */Q
     m_mltProfile(nullptr),
     m_showFrameEvent(nullptr),
     m_droppedFrames(0),
-    m_livePreview(KdenliveSettings::enable_recording_preview())
+    m_livePreview(KdenliveSettings::enable_recording_preview()),
+    m_nextImage(0),
+    m_frameWriter(new FrameWriter(this))
 {
     analyseAudio = KdenliveSettings::monitor_audio();
     if (profile.isEmpty()) {
@@ -58,6 +69,8 @@ MltDeviceCapture::MltDeviceCapture(QString profile, /*VideoSurface *surface, */Q
     m_droppedFramesTimer.setSingleShot(false);
     m_droppedFramesTimer.setInterval(1000);
     connect(&m_droppedFramesTimer, &QTimer::timeout, this, &MltDeviceCapture::slotCheckDroppedFrames);
+    m_frameWriter->setQuality(KdenliveSettings::sm_imagequality());
+    connect(m_frameWriter, &FrameWriter::frameWritten, this, &MltDeviceCapture::frameSaved);
 }
 
 MltDeviceCapture::~MltDeviceCapture()
@@ -94,7 +107,7 @@ bool MltDeviceCapture::buildConsumer(const QString &profileName)
     // OpenGL monitor
     m_mltConsumer = new Mlt::Consumer(*m_mltProfile, KdenliveSettings::audiobackend().toUtf8().constData());
     m_mltConsumer->set("preview_off", 1);
-    m_mltConsumer->set("preview_format", mlt_image_rgb24);
+    m_mltConsumer->set("preview_format", mlt_image_yuv422);
     m_showFrameEvent = m_mltConsumer->listen("consumer-frame-show", this, (mlt_listener) consumer_gl_frame_show);
     //m_mltConsumer->set("resize", 1);
     //m_mltConsumer->set("terminate_on_pause", 1);
@@ -206,29 +219,76 @@ void MltDeviceCapture::emitFrameUpdated(Mlt::Frame &frame)
     }
     */
 
-    mlt_image_format format = mlt_image_rgb24;
-    int width = 0;
-    int height = 0;
-    const uchar *image = frame.get_image(format, width, height);
-    QImage qimage(width, height, QImage::Format_RGB888);
-    //QImage qimage(width, height, QImage::Format_ARGB32_Premultiplied);
-    memcpy(qimage.bits(), image, width * height * 3);
-    emit frameUpdated(qimage);
+    const QImage qimage = convertFrame(frame);
+    if (!qimage.isNull()) {
+        emit frameUpdated(qimage);
+    }
 }
 
 void MltDeviceCapture::showFrame(Mlt::Frame &frame)
 {
-    mlt_image_format format = mlt_image_rgb24;
+    const QImage qimage = convertFrame(frame);
+    if (qimage.isNull()) {
+        return;
+    }
+    emit showImageSignal(qimage);
+
+    if (sendFrameForAnalysis && frame.get_frame()->convert_image) {
+        // Scopes read RGB32 pixels directly, the image is shared without copy
+        emit frameUpdated(qimage);
+    }
+}
+
+QImage MltDeviceCapture::convertFrame(Mlt::Frame &frame)
+{
+    // Capture devices give 4:2:2, converting to RGB here is much faster than in MLT
+    mlt_image_format format = frame.get_int("format") == mlt_image_yuv420p ? mlt_image_yuv420p : mlt_image_yuv422;
     int width = 0;
     int height = 0;
     const uchar *image = frame.get_image(format, width, height);
-    QImage qimage(width, height, QImage::Format_RGB888);
-    memcpy(qimage.scanLine(0), image, static_cast<size_t>(width * height * 3));
-    emit showImageSignal(qimage);
+    if (image == nullptr || width <= 0 || height <= 0) {
+        return QImage();
+    }
+    QMutexLocker lock(&m_imageMutex);
+    QImage &qimage = frameBuffer(width, height);
+    switch (format) {
+    case mlt_image_yuv422:
+        YuvConverter::packed422ToRgb32(image, width * 2, qimage.bits(), qimage.bytesPerLine(), width, height, YuvConverter::YUYV);
+        break;
+    case mlt_image_yuv420p: {
+        // Chroma planes are rounded up for odd sizes
+        const int uvStride = (width + 1) / 2;
+        const uchar *u = image + width * height;
+        const uchar *v = u + uvStride * ((height + 1) / 2);
+        YuvConverter::planar420ToRgb32(image, width, u, v, uvStride, qimage.bits(), qimage.bytesPerLine(), width, height);
+        break;
+    }
+    case mlt_image_rgb24:
+        qimage = QImage(image, width, height, width * 3, QImage::Format_RGB888).convertToFormat(QImage::Format_RGB32);
+        break;
+    default:
+        qCDebug(KDENLIVE_LOG) << "Cannot display capture frame in format" << format;
+        return QImage();
+    }
+    return qimage;
+}
 
-    if (sendFrameForAnalysis && frame.get_frame()->convert_image) {
-        emit frameUpdated(qimage.rgbSwapped());
+QImage &MltDeviceCapture::frameBuffer(int width, int height)
+{
+    for (int i = 0; i < m_imagePool.count(); ++i) {
+        // A shared image is still displayed or analysed
+        if (m_imagePool.at(i).isDetached() && m_imagePool.at(i).width() == width && m_imagePool.at(i).height() == height) {
+            return m_imagePool[i];
+        }
+    }
+    if (m_imagePool.count() < 3) {
+        m_imagePool.append(QImage(width, height, QImage::Format_RGB32));
+        return m_imagePool.last();
     }
+    // All in use, the replaced image is released by its last user
+    m_nextImage = (m_nextImage + 1) % m_imagePool.count();
+    m_imagePool[m_nextImage] = QImage(width, height, QImage::Format_RGB32);
+    return m_imagePool[m_nextImage];
 }
 
 void MltDeviceCapture::showAudio(Mlt::Frame &frame)
@@ -302,24 +362,30 @@ void MltDeviceCapture::slotCheckDroppedFrames()
 
 void MltDeviceCapture::saveFrame(Mlt::Frame &frame)
 {
-    mlt_image_format format = mlt_image_rgb24;
-    int width = 0;
-    int height = 0;
-    const uchar *image = frame.get_image(format, width, height);
-    QImage qimage(width, height, QImage::Format_RGB888);
-    memcpy(qimage.bits(), image, static_cast<size_t>(width * height * 3));
+    const QImage qimage = convertFrame(frame);
+    if (qimage.isNull()) {
+        return;
+    }
+    // Encoding is done by the writer thread, the live feed goes on
+    if (!m_frameWriter->write(qimage, m_capturePath)) {
+        // The disk does not keep up, try again with the next frame
+        doCapture = 1;
+        return;
+    }
 
     // Re-enable overlay
     Mlt::Service service(m_mltProducer->parent().get_service());
     Mlt::Tractor tractor(service);
     Mlt::Producer trackProducer(tractor.track(0));
     trackProducer.set("hide", 0);
-
-    qimage.save(m_capturePath);
-    emit frameSaved(m_capturePath);
     m_capturePath.clear();
 }
 
+FrameWriter *MltDeviceCapture::frameWriter() const
+{
+    return m_frameWriter;
+}
+
 void MltDeviceCapture::captureFrame(const QString &path)
 {
     if (m_mltProducer == nullptr || !m_mltProducer->is_valid()) {
@@ -398,7 +464,7 @@ bool MltDeviceCapture::slotStartCapture(const QString &params, const QString &pa
         // OpenGL monitor
         previewProps->set("mlt_service", KdenliveSettings::audiobackend().toUtf8().constData());
         previewProps->set("preview_off", 1);
-        previewProps->set("preview_format", mlt_image_rgb24);
+        previewProps->set("preview_format", mlt_image_yuv422);
         previewProps->set("terminate_on_pause", 0);
         m_showFrameEvent = m_mltConsumer->listen("consumer-frame-show", this, (mlt_listener) consumer_gl_frame_show);
         //m_mltConsumer->set("resize", 1);
@@ -599,79 +665,8 @@ void MltDeviceCapture::mirror(bool activate)
 void MltDeviceCapture::uyvy2rgb(unsigned char *yuv_buffer, int width, int height)
 {
     processingImage = true;
-    QImage image(width, height, QImage::Format_RGB888);
-    unsigned char *rgb_buffer = image.bits();
-
-    int rgb_ptr = 0, y_ptr = 0;
-    int len = width * height / 2;
-
-    for (int t = 0; t < len; ++t) {
-        int Y = yuv_buffer[y_ptr];
-        int U = yuv_buffer[y_ptr + 1];
-        int Y2 = yuv_buffer[y_ptr + 2];
-        int V = yuv_buffer[y_ptr + 3];
-        y_ptr += 4;
-
-        int r = ((298 * (Y - 16)               + 409 * (V - 128) + 128) >> 8);
-
-        int g = ((298 * (Y - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8);
-
-        int b = ((298 * (Y - 16) + 516 * (U - 128)               + 128) >> 8);
-
-        if (r > 255) {
-            r = 255;
-        }
-        if (g > 255) {
-            g = 255;
-        }
-        if (b > 255) {
-            b = 255;
-        }
-
-        if (r < 0) {
-            r = 0;
-        }
-        if (g < 0) {
-            g = 0;
-        }
-        if (b < 0) {
-            b = 0;
-        }
-
-        rgb_buffer[rgb_ptr] = static_cast<uchar>(r);
-        rgb_buffer[rgb_ptr + 1] = static_cast<uchar>(g);
-        rgb_buffer[rgb_ptr + 2] = static_cast<uchar>(b);
-        rgb_ptr += 3;
-
-        r = ((298 * (Y2 - 16)               + 409 * (V - 128) + 128) >> 8);
-        g = ((298 * (Y2 - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8);
-        b = ((298 * (Y2 - 16) + 516 * (U - 128)               + 128) >> 8);
-
-        if (r > 255) {
-            r = 255;
-        }
-        if (g > 255) {
-            g = 255;
-        }
-        if (b > 255) {
-            b = 255;
-        }
-
-        if (r < 0) {
-            r = 0;
-        }
-        if (g < 0) {
-            g = 0;
-        }
-        if (b < 0) {
-            b = 0;
-        }
-
-        rgb_buffer[rgb_ptr] = static_cast<uchar>(r);
-        rgb_buffer[rgb_ptr + 1] = static_cast<uchar>(g);
-        rgb_buffer[rgb_ptr + 2] = static_cast<uchar>(b);
-        rgb_ptr += 3;
-    }
+    QImage image(width, height, QImage::Format_RGB32);
+    YuvConverter::packed422ToRgb32(yuv_buffer, width * 2, image.bits(), image.bytesPerLine(), width, height, YuvConverter::YUYV);
     //emit imageReady(image);
     //m_captureDisplayWidget->setImage(image);
     emit unblockPreview();
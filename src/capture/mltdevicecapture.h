@@ -30,8 +30,10 @@
 #include "definitions.h"
 #include "monitor/abstractmonitor.h"
 
+#include <QImage>
 #include <QTimer>
 #include <QMutex>
+#include <QVector>
 
 // include after QTimer to have C++ phtreads defined
 #include <mlt/framework/mlt_types.h>
@@ -44,6 +46,7 @@ class Event;
 class Producer;
 class Profile;
 }
+class FrameWriter;
 
 class MltDeviceCapture: public AbstractRender
 {
@@ -79,8 +82,11 @@ Q_OBJECT public:
      */
     bool slotStartCapture(const QString &params, const QString &path, const QString &playlist, bool livePreview, bool xmlPlaylist = true);
     bool slotStartPreview(const QString &producer, bool xmlFormat = false);
-    /** @brief Save current frame to file. */
+    /** @brief Save current frame to file. The file is written in a background thread,
+     *  frameSaved() is emitted once it is on disk. */
     void captureFrame(const QString &path);
+    /** @brief The queue of frames waiting to be written. */
+    FrameWriter *frameWriter() const;
 
     /** @brief This will add the video clip from path and add it in the overlay track. */
     void setOverlay(const QString &path);
@@ -110,6 +116,16 @@ private:
 
     void uyvy2rgb(unsigned char *yuv_buffer, int width, int height);
 
+    /** @brief Converted frames, reused once the monitor and scopes released them. */
+    QVector<QImage> m_imagePool;
+    int m_nextImage;
+    QMutex m_imageMutex;
+    /** @brief Converts the frame's image to RGB32 in a pooled image. */
+    QImage convertFrame(Mlt::Frame &frame);
+    /** @brief An image of the pool that is not shared anymore, a new one if all are in use. */
+    QImage &frameBuffer(int width, int height);
+    FrameWriter *m_frameWriter;
+
     QString m_capturePath;
 
     QTimer m_droppedFramesTimer;
@@ -133,7 +149,8 @@ signals:
      * Used in Mac OS X. */
     void showImageSignal(const QImage &);
 
-    void frameSaved(const QString &);
+    /** @brief A captured frame was written, the thumbnail is made from the image in memory. */
+    void frameSaved(const QString &path, const QImage &thumbnail);
 
     void droppedFrames(int);
 
@@ -19,6 +19,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include "mltcontroller/producerqueue.h"
 #include "bin/bin.h"
 #include "library/librarywidget.h"
+#include "project/jobs/jobscheduler.h"
 #include "kdenlive_debug.h"
 
 #include <QCoreApplication>
@@ -42,6 +43,7 @@ Core::Core() :
     , m_producerQueue(nullptr)
     , m_binWidget(nullptr)
     , m_library(nullptr)
+    , m_jobScheduler(nullptr)
 {
     connect(qApp, &QCoreApplication::aboutToQuit, this, &QObject::deleteLater);
 }
@@ -72,6 +74,8 @@ void Core::build(const QString &MltPath, const QUrl &Url, const QString &clipsTo
     qRegisterMetaType<QDomElement> ("QDomElement");
     qRegisterMetaType<requestClipInfo> ("requestClipInfo");
     qRegisterMetaType<MltVideoProfile> ("MltVideoProfile");
+    qRegisterMetaType<thumbMap> ("thumbMap");
+    qRegisterMetaType<LoudnessInfo> ("LoudnessInfo");
 
     m_self->initialize(MltPath);
     m_self->m_mainWindow->init(MltPath, Url, clipsToLoad);
@@ -128,6 +132,7 @@ void Core::initialize(const QString &mltPath)
     }
 
     m_projectManager = new ProjectManager(this);
+    m_jobScheduler = new JobScheduler(this);
     m_binWidget = new Bin();
     m_binController = new BinController();
     m_library = new LibraryWidget(m_projectManager);
@@ -138,12 +143,14 @@ void Core::initialize(const QString &mltPath)
     connect(m_binController, &BinController::requestAudioThumb, m_binWidget, &Bin::slotCreateAudioThumb);
     connect(m_binController, &BinController::abortAudioThumbs, m_binWidget, &Bin::abortAudioThumbs);
     connect(m_binController, SIGNAL(loadThumb(QString, QImage, bool)), m_binWidget, SLOT(slotThumbnailReady(QString, QImage, bool)));
+    connect(m_binController, &BinController::loadThumbs, m_binWidget, &Bin::slotThumbnailsReady, Qt::QueuedConnection);
     m_monitorManager = new MonitorManager(this);
     // Producer queue, creating MLT::Producers on request
     m_producerQueue = new ProducerQueue(m_binController);
     connect(m_producerQueue, SIGNAL(gotFileProperties(requestClipInfo, ClipController *)), m_binWidget, SLOT(slotProducerReady(requestClipInfo, ClipController *)), Qt::DirectConnection);
     connect(m_producerQueue, &ProducerQueue::replyGetImage, m_binWidget, &Bin::slotThumbnailReady);
     connect(m_producerQueue, &ProducerQueue::removeInvalidClip, m_binWidget, &Bin::slotRemoveInvalidClip, Qt::DirectConnection);
+    connect(m_producerQueue, &ProducerQueue::gotDecodeSpeed, m_binWidget, &Bin::slotGotDecodeSpeed);
     connect(m_producerQueue, SIGNAL(addClip(QString, QMap<QString, QString>)), m_binWidget, SLOT(slotAddUrl(QString, QMap<QString, QString>)));
     connect(m_binController, SIGNAL(createThumb(QDomElement, QString, int)), m_producerQueue, SLOT(getFileProperties(QDomElement, QString, int)));
     connect(m_binWidget, &Bin::producerReady, m_producerQueue, &ProducerQueue::slotProcessingDone, Qt::DirectConnection);
@@ -193,6 +200,11 @@ LibraryWidget *Core::library()
     return m_library;
 }
 
+JobScheduler *Core::jobScheduler()
+{
+    return m_jobScheduler;
+}
+
 void Core::initLocale()
 {
     QLocale systemLocale = QLocale();
@@ -23,6 +23,7 @@ class BinController;
 class Bin;
 class LibraryWidget;
 class ProducerQueue;
+class JobScheduler;
 class MltConnection;
 
 namespace Mlt
@@ -82,6 +83,8 @@ public:
     ProducerQueue *producerQueue();
     /** @brief Returns a pointer to the library. */
     LibraryWidget *library();
+    /** @brief Returns a pointer to the scheduler shared by render and clip jobs */
+    JobScheduler *jobScheduler();
 
     /** @brief Returns a pointer to MLT's repository */
     std::unique_ptr<Mlt::Repository>& getMltRepository();
@@ -103,6 +106,7 @@ private:
     ProducerQueue *m_producerQueue;
     Bin *m_binWidget;
     LibraryWidget *m_library;
+    JobScheduler *m_jobScheduler;
 
     std::unique_ptr<MltConnection> m_mltConnection;
 
@@ -174,7 +174,8 @@ enum CacheType {
     CachePreview = 2,
     CacheProxy = 3,
     CacheAudio = 4,
-    CacheThumbs = 5
+    CacheThumbs = 5,
+    CacheFreeze = 6
 };
 
 enum TrimMode {
@@ -25,6 +25,8 @@
 #include "utils/KoIconUtils.h"
 #include "profiles/profilerepository.hpp"
 #include "profiles/profilemodel.hpp"
+#include "project/jobs/jobscheduler.h"
+#include "core.h"
 
 #include "klocalizedstring.h"
 #include <KMessageBox>
@@ -87,6 +89,7 @@ const int ParametersRole = Qt::UserRole + 1;
 const int TimeRole = Qt::UserRole + 2;
 const int ProgressRole = Qt::UserRole + 3;
 const int ExtraInfoRole = Qt::UserRole + 5;
+const int TicketRole = Qt::UserRole + 6;
 
 const int DirectRenderType = QTreeWidgetItem::Type;
 const int ScriptRenderType = QTreeWidgetItem::UserType;
@@ -249,6 +252,9 @@ RenderWidget::RenderWidget(const QString &projectfolder, bool enableProxy, const
     m_view.encoder_threads->setMaximum(QThread::idealThreadCount());
     m_view.encoder_threads->setValue(KdenliveSettings::encodethreads());
     connect(m_view.encoder_threads, SIGNAL(valueChanged(int)), this, SLOT(slotUpdateEncodeThreads(int)));
+    m_view.render_segments->setMaximum(qMax(1, QThread::idealThreadCount()));
+    m_view.render_segments->setValue(KdenliveSettings::rendersegments());
+    connect(m_view.render_segments, SIGNAL(valueChanged(int)), this, SLOT(slotUpdateRenderSegments(int)));
 
     m_view.rescale_keep->setChecked(KdenliveSettings::rescalekeepratio());
     connect(m_view.rescale_width, SIGNAL(valueChanged(int)), this, SLOT(slotUpdateRescaleWidth(int)));
@@ -257,6 +263,8 @@ RenderWidget::RenderWidget(const QString &projectfolder, bool enableProxy, const
     m_view.rescale_keep->setToolTip(i18n("Preserve aspect ratio"));
     connect(m_view.rescale_keep, &QAbstractButton::clicked, this, &RenderWidget::slotSwitchAspectRatio);
 
+    connect(pCore->jobScheduler(), &JobScheduler::slotsAvailable, this, &RenderWidget::checkRenderStatus, Qt::QueuedConnection);
+
     connect(m_view.buttonRender, SIGNAL(clicked()), this, SLOT(slotPrepareExport()));
     connect(m_view.buttonGenerateScript, &QAbstractButton::clicked, this, &RenderWidget::slotGenerateScript);
 
@@ -1217,10 +1225,10 @@ void RenderWidget::slotExport(bool scriptExport, int zoneIn, int zoneOut,
             double fps = profile->fps();
             double guideStart = m_view.guide_start->itemData(m_view.guide_start->currentIndex()).toDouble();
             double guideEnd = m_view.guide_end->itemData(m_view.guide_end->currentIndex()).toDouble();
-            render_process_args << "in=" + QString::number((int) GenTime(guideStart).frames(fps)) << "out=" + QString::number((int) GenTime(guideEnd).frames(fps));
-        } else {
-            render_process_args << "in=" + QString::number(zoneIn) << "out=" + QString::number(zoneOut);
+            zoneIn = (int) GenTime(guideStart).frames(fps);
+            zoneOut = (int) GenTime(guideEnd).frames(fps);
         }
+        render_process_args << "in=" + QString::number(zoneIn) << "out=" + QString::number(zoneOut);
 
         if (!overlayargs.isEmpty()) {
             render_process_args << "preargs=" + overlayargs.join(QLatin1Char(' '));
@@ -1465,6 +1473,10 @@ void RenderWidget::slotExport(bool scriptExport, int zoneIn, int zoneOut,
         }*/
 
         renderItem->setData(1, ParametersRole, render_process_args);
+        m_segmentedRenders.remove(dest);
+        if (KdenliveSettings::rendersegments() > 1 && !imageSequences.contains(extension)) {
+            prepareSegmentedRender(dest, render_process_args, zoneIn, zoneOut, playlistPaths.at(stemIdx));
+        }
         if (exportAudio == false) {
             renderItem->setData(1, ExtraInfoRole, i18n("Video without audio track"));
         } else {
@@ -1485,39 +1497,72 @@ void RenderWidget::checkRenderStatus()
         return;
     }
 
-    RenderJobItem *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
-
-    // Make sure no other rendering is running
-    while (item) {
-        if (item->status() == RUNNINGJOB) {
+    // Parts of running segmented renders were queued before the jobs still waiting
+    const QStringList segmented = m_segmentedRenders.keys();
+    for (const QString &dest : segmented) {
+        if (!m_segmentedRenders.value(dest).tickets.isEmpty() && !startWaitingSegments(dest)) {
+            abortSegmentedRender(dest);
+            setRenderStatus(dest, -2, i18n("Cannot start the render process"));
             return;
         }
-        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
-    item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
-    bool waitingJob = false;
 
-    // Find first waiting job
+    JobScheduler *scheduler = pCore->jobScheduler();
+    RenderJobItem *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+    bool activeJob = false;
+
+    // Start waiting jobs in order while the scheduler has free slots
     while (item) {
-        if (item->status() == WAITINGJOB) {
+        if (item->status() == RUNNINGJOB || item->status() == STARTINGJOB) {
+            activeJob = true;
+        } else if (item->status() == WAITINGJOB) {
+            activeJob = true;
+            int ticket = item->data(1, TicketRole).toInt();
+            if (ticket == 0) {
+                ticket = scheduler->enqueue(JobScheduler::RenderResource, item->text(1));
+                item->setData(1, TicketRole, ticket);
+            }
+            if (!scheduler->tryStart(ticket)) {
+                break;
+            }
             item->setData(1, TimeRole, QDateTime::currentDateTime());
-            waitingJob = true;
-            startRendering(item);
             item->setStatus(STARTINGJOB);
-            break;
+            startRendering(item);
+            if (item->status() == FAILEDJOB) {
+                releaseRenderSlot(item);
+            }
         }
         item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
-    if (waitingJob == false && m_view.shutdown->isChecked()) {
+    if (!activeJob && m_view.shutdown->isChecked()) {
         emit shutdown();
     }
 }
 
+void RenderWidget::releaseRenderSlot(RenderJobItem *item)
+{
+    const int ticket = item->data(1, TicketRole).toInt();
+    if (ticket > 0) {
+        item->setData(1, TicketRole, 0);
+        pCore->jobScheduler()->finish(ticket);
+    }
+}
+
 void RenderWidget::startRendering(RenderJobItem *item)
 {
     if (item->type() == DirectRenderType) {
+        if (m_segmentedRenders.contains(item->text(1))) {
+            if (startSegmentedRender(item)) {
+                KNotification::event(QStringLiteral("RenderStarted"), i18n("Rendering <i>%1</i> started", item->text(1)), QPixmap(), this);
+            } else {
+                item->setStatus(FAILEDJOB);
+            }
+            return;
+        }
         // Normal render process
-        if (QProcess::startDetached(m_renderer, item->data(1, ParametersRole).toStringList()) == false) {
+        QString program = m_renderer;
+        QStringList args = item->data(1, ParametersRole).toStringList();
+        if (QProcess::startDetached(program, args) == false) {
             item->setStatus(FAILEDJOB);
         } else {
             KNotification::event(QStringLiteral("RenderStarted"), i18n("Rendering <i>%1</i> started", item->text(1)), QPixmap(), this);
@@ -1530,6 +1575,300 @@ void RenderWidget::startRendering(RenderJobItem *item)
     }
 }
 
+QList<QPair<int, int> > RenderWidget::segmentRanges(int in, int out, int count) const
+{
+    QList<QPair<int, int> > ranges;
+    const double fps = ProfileRepository::get()->getProfile(m_profile)->fps();
+    const int length = out - in + 1;
+    // Every process has to load the whole project, very short segments are not worth it
+    count = qMin(count, length / qMax(1, (int)(fps * 10)));
+    if (count < 2) {
+        return ranges;
+    }
+    QList<int> guides;
+    for (int i = 0; i < m_view.guide_start->count(); ++i) {
+        guides << (int) GenTime(m_view.guide_start->itemData(i).toDouble()).frames(fps);
+    }
+    // Each segment is a separate encode starting on a keyframe, so any cut point can be
+    // joined without re-encoding. Guides usually mark scene changes, prefer cutting there.
+    const int tolerance = length / count / 4;
+    int start = in;
+    for (int i = 1; i < count; ++i) {
+        int cut = in + (int)((qint64) length * i / count);
+        int best = -1;
+        for (int guide : guides) {
+            if (guide > start && guide < out && qAbs(guide - cut) <= tolerance && (best == -1 || qAbs(guide - cut) < qAbs(best - cut))) {
+                best = guide;
+            }
+        }
+        if (best != -1) {
+            cut = best;
+        }
+        ranges << qMakePair(start, cut - 1);
+        start = cut;
+    }
+    ranges << qMakePair(start, out);
+    return ranges;
+}
+
+void RenderWidget::prepareSegmentedRender(const QString &dest, const QStringList &args, int in, int out, const QString &playlist)
+{
+    if (args.contains(QStringLiteral("vn=1")) || QMimeDatabase().mimeTypeForFile(dest, QMimeDatabase::MatchExtension).name().startsWith(QLatin1String("audio/"))) {
+        // Audio encodes are fast, and cannot be cut on a keyframe
+        return;
+    }
+    const QList<QPair<int, int> > ranges = segmentRanges(in, out, KdenliveSettings::rendersegments());
+    const int destIndex = args.indexOf(QString(QUrl::fromLocalFile(dest).toEncoded()));
+    if (ranges.count() < 2 || destIndex < 2) {
+        return;
+    }
+    SegmentedRender render;
+    render.playlist = args.contains(QStringLiteral("-erase")) ? playlist : QString();
+    render.player = args.at(destIndex - 2);
+    render.joinProcess = nullptr;
+    render.aborted = false;
+    // The playlist is shared by all parts and deleted after joining, only the last step plays the result
+    QStringList partArgs = args;
+    partArgs.removeAll(QStringLiteral("-erase"));
+    partArgs.removeAll(QStringLiteral("-kuiserver"));
+    const int partDestIndex = destIndex - (args.count() - partArgs.count());
+    partArgs[partDestIndex - 2] = QStringLiteral("-");
+    const int inIndex = partArgs.indexOf(QStringLiteral("in=%1").arg(in));
+    QFileInfo info(dest);
+    // Audio encoders add priming samples at the start of each stream, joined audio
+    // segments would have small gaps. Audio is encoded once over the whole range.
+    const bool hasAudio = !args.contains(QStringLiteral("an=1"));
+    for (int i = 0; i < ranges.count(); ++i) {
+        const QString part = info.absolutePath() + QLatin1Char('/') + info.completeBaseName() + QStringLiteral(".part%1.").arg(i + 1, 2, 10, QLatin1Char('0')) + info.suffix();
+        QStringList videoArgs = partArgs;
+        if (inIndex >= 0) {
+            videoArgs[inIndex] = QStringLiteral("in=%1").arg(ranges.at(i).first);
+            videoArgs[inIndex + 1] = QStringLiteral("out=%1").arg(ranges.at(i).second);
+        }
+        videoArgs[partDestIndex] = QUrl::fromLocalFile(part).toEncoded();
+        if (hasAudio) {
+            videoArgs << QStringLiteral("an=1");
+        }
+        render.parts << part;
+        render.args << videoArgs;
+        render.lengths << ranges.at(i).second - ranges.at(i).first + 1;
+        render.progress << 0;
+    }
+    if (hasAudio) {
+        render.audioPart = info.absolutePath() + QLatin1Char('/') + info.completeBaseName() + QStringLiteral(".audio.") + info.suffix();
+        QStringList audioArgs = partArgs;
+        audioArgs[partDestIndex] = QUrl::fromLocalFile(render.audioPart).toEncoded();
+        audioArgs << QStringLiteral("vn=1");
+        render.parts << render.audioPart;
+        render.args << audioArgs;
+        // Audio alone encodes much faster than the video parts
+        render.lengths << qMax(1, (out - in + 1) / 20);
+        render.progress << 0;
+    }
+    m_segmentedRenders.insert(dest, render);
+}
+
+bool RenderWidget::startSegmentedRender(RenderJobItem *item)
+{
+    const QString dest = item->text(1);
+    SegmentedRender &render = m_segmentedRenders[dest];
+    JobScheduler *scheduler = pCore->jobScheduler();
+    render.tickets.clear();
+    for (int i = 0; i < render.parts.count(); ++i) {
+        render.progress[i] = 0;
+        // The first part runs in the render slot taken by the job. The user asked for parallel
+        // parts, so the other ones wait for processing slots, shared with clip jobs.
+        int ticket = i == 0 ? item->data(1, TicketRole).toInt() : 0;
+        if (ticket > 0) {
+            item->setData(1, TicketRole, 0);
+        } else {
+            ticket = scheduler->enqueue(i == 0 ? JobScheduler::RenderResource : JobScheduler::CpuResource, i18n("%1, part %2", dest, i + 1));
+        }
+        render.tickets << ticket;
+    }
+    if (!startWaitingSegments(dest)) {
+        abortSegmentedRender(dest);
+        return false;
+    }
+    return true;
+}
+
+bool RenderWidget::startWaitingSegments(const QString &dest)
+{
+    SegmentedRender &render = m_segmentedRenders[dest];
+    JobScheduler *scheduler = pCore->jobScheduler();
+    for (int i = 0; i < render.parts.count(); ++i) {
+        const QString &part = render.parts.at(i);
+        if (render.tickets.at(i) == 0 || m_segmentOwners.contains(part)) {
+            // Finished or already running
+            continue;
+        }
+        if (!scheduler->tryStart(render.tickets.at(i))) {
+            // Parts start in order
+            break;
+        }
+        QString program = m_renderer;
+        QStringList args = render.args.at(i);
+        if (!QProcess::startDetached(program, args)) {
+            return false;
+        }
+        m_segmentOwners.insert(part, dest);
+    }
+    return true;
+}
+
+void RenderWidget::setSegmentProgress(const QString &part, int progress)
+{
+    const QString dest = m_segmentOwners.value(part);
+    SegmentedRender &render = m_segmentedRenders[dest];
+    int ix = render.parts.indexOf(part);
+    if (ix < 0) {
+        return;
+    }
+    render.progress[ix] = progress;
+    qint64 done = 0;
+    qint64 total = 0;
+    for (int i = 0; i < render.parts.count(); ++i) {
+        done += (qint64) render.lengths.at(i) * render.progress.at(i);
+        total += render.lengths.at(i);
+    }
+    // Keep the last percent for the joining step
+    const int aggregated = (int)(done * 99 / (total * 100));
+    QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(dest, Qt::MatchExactly, 1);
+    if (aggregated == 0 && !existing.isEmpty() && static_cast<RenderJobItem *>(existing.at(0))->status() == RUNNINGJOB) {
+        return;
+    }
+    setRenderJob(dest, aggregated);
+}
+
+void RenderWidget::setSegmentStatus(const QString &part, int status, const QString &error)
+{
+    const QString dest = m_segmentOwners.take(part);
+    SegmentedRender &render = m_segmentedRenders[dest];
+    int ix = render.parts.indexOf(part);
+    if (status == -1 && ix >= 0) {
+        render.progress[ix] = 100;
+        pCore->jobScheduler()->finish(render.tickets.at(ix));
+        render.tickets[ix] = 0;
+        if (render.tickets.count(0) == render.tickets.count()) {
+            joinSegments(dest);
+        }
+        return;
+    }
+    if (status == -2 || status == -3) {
+        // The other segments are useless now
+        abortSegmentedRender(dest);
+        setRenderStatus(dest, -2, error);
+    }
+}
+
+void RenderWidget::abortSegmentedRender(const QString &dest)
+{
+    if (!m_segmentedRenders.contains(dest)) {
+        return;
+    }
+    SegmentedRender &render = m_segmentedRenders[dest];
+    for (const QString &part : render.parts) {
+        if (m_segmentOwners.remove(part) > 0) {
+            m_droppedSegments.insert(part);
+            emit abortProcess(part);
+        } else {
+            QFile::remove(part);
+        }
+    }
+    // Release the slots of running parts and remove the waiting ones from the queue
+    for (int i = 0; i < render.tickets.count(); ++i) {
+        if (render.tickets.at(i) > 0) {
+            pCore->jobScheduler()->finish(render.tickets.at(i));
+            render.tickets[i] = 0;
+        }
+    }
+    if (render.joinProcess) {
+        // The join process cleans up when it exits
+        render.aborted = true;
+        render.joinProcess->kill();
+        return;
+    }
+    if (!render.playlist.isEmpty()) {
+        QFile::remove(render.playlist);
+    }
+    m_segmentedRenders.remove(dest);
+}
+
+void RenderWidget::joinSegments(const QString &dest)
+{
+    SegmentedRender &render = m_segmentedRenders[dest];
+    QString ffmpeg = KdenliveSettings::ffmpegpath();
+    if (ffmpeg.isEmpty()) {
+        ffmpeg = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
+    }
+    QFileInfo info(dest);
+    const QString listFile = info.absolutePath() + QLatin1Char('/') + info.completeBaseName() + QStringLiteral(".segments.txt");
+    QFile file(listFile);
+    if (ffmpeg.isEmpty() || !file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        segmentsJoined(dest, false, ffmpeg.isEmpty() ? i18n("FFmpeg is required to join the rendered segments") : i18n("Cannot write to file %1", listFile));
+        return;
+    }
+    QTextStream stream(&file);
+    for (QString part : render.parts) {
+        if (part == render.audioPart) {
+            continue;
+        }
+        stream << "file '" << part.replace(QLatin1Char('\''), QLatin1String("'\\''")) << "'\n";
+    }
+    file.close();
+
+    QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(dest, Qt::MatchExactly, 1);
+    if (!existing.isEmpty()) {
+        existing.at(0)->setData(1, Qt::UserRole, i18n("Joining segments..."));
+    }
+    QProcess *process = new QProcess(this);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+    render.joinProcess = process;
+    connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [this, dest, listFile, process](int exitCode, QProcess::ExitStatus exitStatus) {
+        QFile::remove(listFile);
+        segmentsJoined(dest, exitStatus == QProcess::NormalExit && exitCode == 0, QString::fromUtf8(process->readAll()));
+        process->deleteLater();
+    });
+    QStringList args;
+    args << QStringLiteral("-y") << QStringLiteral("-hide_banner") << QStringLiteral("-loglevel") << QStringLiteral("error");
+    args << QStringLiteral("-f") << QStringLiteral("concat") << QStringLiteral("-safe") << QStringLiteral("0") << QStringLiteral("-i") << listFile;
+    if (render.audioPart.isEmpty()) {
+        args << QStringLiteral("-map") << QStringLiteral("0");
+    } else {
+        // Video parts joined, with the audio encoded in one pass
+        args << QStringLiteral("-i") << render.audioPart << QStringLiteral("-map") << QStringLiteral("0:v") << QStringLiteral("-map") << QStringLiteral("1:a");
+    }
+    args << QStringLiteral("-c") << QStringLiteral("copy") << dest;
+    process->start(ffmpeg, args);
+}
+
+void RenderWidget::segmentsJoined(const QString &dest, bool success, const QString &log)
+{
+    SegmentedRender render = m_segmentedRenders.value(dest);
+    m_segmentedRenders[dest].joinProcess = nullptr;
+    for (const QString &part : render.parts) {
+        QFile::remove(part);
+    }
+    if (!render.playlist.isEmpty()) {
+        QFile::remove(render.playlist);
+    }
+    if (render.aborted) {
+        QFile::remove(dest);
+        m_segmentedRenders.remove(dest);
+        return;
+    }
+    if (success && render.player.length() > 3 && render.player.contains(QLatin1Char(' '))) {
+        QStringList args = render.player.split(QLatin1Char(' '));
+        QString exec = args.takeFirst();
+        args.removeLast();
+        args << dest;
+        QProcess::startDetached(exec, args);
+    }
+    setRenderStatus(dest, success ? -1 : -2, log);
+    m_segmentedRenders.remove(dest);
+}
+
 int RenderWidget::waitingJobsCount() const
 {
     int count = 0;
@@ -2197,6 +2536,13 @@ void RenderWidget::parseFile(const QString &exportFile, bool editable)
 
 void RenderWidget::setRenderJob(const QString &dest, int progress)
 {
+    if (m_segmentOwners.contains(dest)) {
+        setSegmentProgress(dest, progress);
+        return;
+    }
+    if (m_droppedSegments.contains(dest)) {
+        return;
+    }
     RenderJobItem *item;
     QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(dest, Qt::MatchExactly, 1);
     if (!existing.isEmpty()) {
@@ -2230,6 +2576,14 @@ void RenderWidget::setRenderJob(const QString &dest, int progress)
 
 void RenderWidget::setRenderStatus(const QString &dest, int status, const QString &error)
 {
+    if (m_segmentOwners.contains(dest)) {
+        setSegmentStatus(dest, status, error);
+        return;
+    }
+    if (m_droppedSegments.remove(dest)) {
+        QFile::remove(dest);
+        return;
+    }
     RenderJobItem *item;
     QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(dest, Qt::MatchExactly, 1);
     if (!existing.isEmpty()) {
@@ -2240,6 +2594,9 @@ void RenderWidget::setRenderStatus(const QString &dest, int status, const QStrin
     if (!item) {
         return;
     }
+    if (status < 0) {
+        releaseRenderSlot(item);
+    }
     if (status == -1) {
         // Job finished successfully
         item->setStatus(FINISHEDJOB);
@@ -2254,6 +2611,38 @@ void RenderWidget::setRenderStatus(const QString &dest, int status, const QStrin
         QString t = i18n("Rendering finished in %1", est);
         item->setData(1, Qt::UserRole, t);
 
+        // Report the encoding speed, to compare segmented and single process renders
+        const QStringList args = item->data(1, ParametersRole).toStringList();
+        int frames = 0;
+        for (const QString &arg : args) {
+            if (arg.startsWith(QLatin1String("in="))) {
+                frames -= arg.section(QLatin1Char('='), 1).toInt();
+            } else if (arg.startsWith(QLatin1String("out="))) {
+                frames += arg.section(QLatin1Char('='), 1).toInt() + 1;
+                break;
+            }
+        }
+        const qint64 elapsedMs = startTime.msecsTo(QDateTime::currentDateTime());
+        if (frames > 0 && elapsedMs > 0) {
+            int processes = 1;
+            if (m_segmentedRenders.contains(dest)) {
+                const SegmentedRender &render = m_segmentedRenders[dest];
+                processes = render.parts.count() - (render.audioPart.isEmpty() ? 0 : 1);
+            }
+            const double speed = frames * 1000.0 / elapsedMs;
+            qCDebug(KDENLIVE_LOG) << "Rendered" << frames << "frames of" << dest << "in" << elapsedMs << "ms using" << processes << "processes:" << speed << "fps";
+            QString info = item->data(1, ExtraInfoRole).toString();
+            if (!info.isEmpty()) {
+                info.append(QStringLiteral(", "));
+            }
+            if (processes > 1) {
+                info.append(i18n("%1 segments, %2 fps", processes, QString::number(speed, 'f', 1)));
+            } else {
+                info.append(i18n("%1 fps", QString::number(speed, 'f', 1)));
+            }
+            item->setData(1, ExtraInfoRole, info);
+        }
+
 #ifdef KF5_USE_PURPOSE
         m_shareMenu->model()->setInputData(QJsonObject{ {QStringLiteral("mimeType"), QMimeDatabase().mimeTypeForFile(item->text(1)).name()}, {QStringLiteral("urls"), QJsonArray({item->text(1)})}});
         m_shareMenu->model()->setPluginType(QStringLiteral("Export"));
@@ -2286,6 +2675,7 @@ void RenderWidget::setRenderStatus(const QString &dest, int status, const QStrin
         // User aborted job
         item->setStatus(ABORTEDJOB);
     } else {
+        releaseRenderSlot(item);
         delete item;
     }
     slotCheckJob();
@@ -2296,9 +2686,13 @@ void RenderWidget::slotAbortCurrentJob()
 {
     RenderJobItem *current = static_cast<RenderJobItem *>(m_view.running_jobs->currentItem());
     if (current) {
-        if (current->status() == RUNNINGJOB) {
+        if (m_segmentedRenders.contains(current->text(1)) && (current->status() == RUNNINGJOB || current->status() == STARTINGJOB)) {
+            abortSegmentedRender(current->text(1));
+            setRenderStatus(current->text(1), -3, QString());
+        } else if (current->status() == RUNNINGJOB) {
             emit abortProcess(current->text(1));
         } else {
+            releaseRenderSlot(current);
             delete current;
             slotCheckJob();
             checkRenderStatus();
@@ -2687,6 +3081,11 @@ void RenderWidget::slotUpdateEncodeThreads(int val)
     KdenliveSettings::setEncodethreads(val);
 }
 
+void RenderWidget::slotUpdateRenderSegments(int val)
+{
+    KdenliveSettings::setRendersegments(val);
+}
+
 void RenderWidget::slotUpdateRescaleWidth(int val)
 {
     KdenliveSettings::setDefaultrescalewidth(val);
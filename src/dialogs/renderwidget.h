@@ -25,6 +25,7 @@
 #include <QPushButton>
 #include <QPainter>
 #include <QStyledItemDelegate>
+#include <QSet>
 
 #ifdef KF5_USE_PURPOSE
 namespace Purpose { class Menu; }
@@ -35,6 +36,7 @@ namespace Purpose { class Menu; }
 
 class QDomElement;
 class QKeyEvent;
+class QProcess;
 
 // RenderViewDelegate is used to draw the progress bars.
 class RenderViewDelegate : public QStyledItemDelegate
@@ -187,6 +189,7 @@ private slots:
     void slotStartCurrentJob();
     void slotCopyToFavorites();
     void slotUpdateEncodeThreads(int);
+    void slotUpdateRenderSegments(int);
     void slotUpdateRescaleHeight(int);
     void slotUpdateRescaleWidth(int);
     void slotSwitchAspectRatio();
@@ -217,6 +220,29 @@ private:
     KMessageWidget *m_jobInfoMessage;
     QMap<int, QString>m_errorMessages;
 
+    /** @brief A render split in several ranges, each encoded by its own process, then joined */
+    struct SegmentedRender {
+        QStringList parts;
+        QList<QStringList> args;
+        QList<int> lengths;
+        QList<int> progress;
+        /** @brief Scheduler ticket of each part, 0 once the part is finished */
+        QList<int> tickets;
+        /** @brief Audio encoded once over the whole range, also listed in parts. Empty if the render has no audio */
+        QString audioPart;
+        /** @brief Playlist to delete once the segments are joined, empty if it must be kept */
+        QString playlist;
+        QString player;
+        QProcess *joinProcess;
+        bool aborted;
+    };
+    /** @brief Segmented renders, by final destination */
+    QMap<QString, SegmentedRender> m_segmentedRenders;
+    /** @brief Final destination of the segments that are still rendering */
+    QMap<QString, QString> m_segmentOwners;
+    /** @brief Segments that were aborted because another part of their render failed */
+    QSet<QString> m_droppedSegments;
+
 #ifdef KF5_USE_PURPOSE
     Purpose::Menu *m_shareMenu;
 #endif
@@ -228,6 +254,22 @@ private:
     /** @brief Check if a job needs to be started. */
     void checkRenderStatus();
     void startRendering(RenderJobItem *item);
+    /** @brief Give the scheduler slot of a render job back. */
+    void releaseRenderSlot(RenderJobItem *item);
+    /** @brief Split the zone in the requested number of ranges, cutting on guides when one is close. */
+    QList<QPair<int, int> > segmentRanges(int in, int out, int count) const;
+    /** @brief Prepare the arguments of each segment render for @param dest. */
+    void prepareSegmentedRender(const QString &dest, const QStringList &args, int in, int out, const QString &playlist);
+    bool startSegmentedRender(RenderJobItem *item);
+    /** @brief Start the parts of @param dest that got a slot from the job scheduler, returns false if one cannot be started. */
+    bool startWaitingSegments(const QString &dest);
+    void setSegmentProgress(const QString &part, int progress);
+    void setSegmentStatus(const QString &part, int status, const QString &error);
+    /** @brief Abort the segments of @param dest that are still rendering and delete the parts. */
+    void abortSegmentedRender(const QString &dest);
+    /** @brief Join the rendered video segments of @param dest with FFmpeg's concat demuxer and add the audio, without re-encoding. */
+    void joinSegments(const QString &dest);
+    void segmentsJoined(const QString &dest, bool success, const QString &log);
     bool saveProfile(QDomElement newprofile);
     /** @brief Create a rendering profile from MLT preset. */
     QTreeWidgetItem *loadFromMltPreset(const QString &groupName, const QString &path, const QString &profileName);
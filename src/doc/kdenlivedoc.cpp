@@ -36,6 +36,9 @@
 #include "project/dialogs/noteswidget.h"
 #include "core.h"
 #include "bin/bin.h"
+#include "timeline/managers/previewcalibration.h"
+#include "project/projectmanager.h"
+#include "project/jobs/jobscheduler.h"
 #include "bin/projectclip.h"
 #include "utils/KoIconUtils.h"
 #include "mltcontroller/bincontroller.h"
@@ -61,6 +64,7 @@
 #include <mlt++/Mlt.h>
 #include <KJobWidgets/KJobWidgets>
 #include <QStandardPaths>
+#include <QtConcurrent>
 
 #include <locale>
 #ifdef Q_OS_MAC
@@ -91,7 +95,8 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
     m_render(render),
     m_notesWidget(notes->widget()),
     m_modified(false),
-    m_projectFolder(projectFolder)
+    m_projectFolder(projectFolder),
+    m_calibrationTicket(-1)
 {
     // init m_profile struct
     m_commandStack = new DocUndoStack(undoGroup);
@@ -113,6 +118,8 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
     connect(m_commandStack, &DocUndoStack::invalidate, this, &KdenliveDoc::checkPreviewStack);
     connect(m_render, &Render::setDocumentNotes, this, &KdenliveDoc::slotSetDocumentNotes);
     connect(pCore->producerQueue(), &ProducerQueue::switchProfile, this, &KdenliveDoc::switchProfile);
+    connect(&m_previewCalibration, &QFutureWatcherBase::finished, this, &KdenliveDoc::slotPreviewCalibrated);
+    connect(pCore->jobScheduler(), &JobScheduler::slotsAvailable, this, &KdenliveDoc::slotStartPreviewCalibration, Qt::QueuedConnection);
     //connect(m_commandStack, SIGNAL(cleanChanged(bool)), this, SLOT(setModified(bool)));
 
     // Init clip modification tracker
@@ -135,6 +142,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
     m_documentProperties[QStringLiteral("proxyminsize")] = QString::number(KdenliveSettings::proxyminsize());
     m_documentProperties[QStringLiteral("generateimageproxy")] = QString::number((int) KdenliveSettings::generateimageproxy());
     m_documentProperties[QStringLiteral("proxyimageminsize")] = QString::number(KdenliveSettings::proxyimageminsize());
+    m_documentProperties[QStringLiteral("generateslowproxy")] = QString::number((int) KdenliveSettings::proxyslowclips());
 
     // Load properties
     QMapIterator<QString, QString> i(properties);
@@ -142,6 +150,7 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, const QString &projectFolder, QUndoGro
         i.next();
         m_documentProperties[i.key()] = i.value();
     }
+    pCore->producerQueue()->setProbeDecodeSpeed(m_documentProperties.value(QStringLiteral("generateslowproxy")).toInt());
 
     // Load metadata
     QMapIterator<QString, QString> j(metadata);
@@ -302,6 +311,10 @@ KdenliveDoc::~KdenliveDoc()
             }
         }
     }
+    if (m_calibrationTicket > -1) {
+        // A running calibration only uses its own data, let it finish
+        pCore->jobScheduler()->finish(m_calibrationTicket);
+    }
     delete m_commandStack;
     //qCDebug(KDENLIVE_LOG) << "// DEL CLP MAN";
     delete m_clipManager;
@@ -328,7 +341,7 @@ int KdenliveDoc::setSceneList()
     bool ok = false;
     QDir thumbsFolder = getCacheDir(CacheThumbs, &ok);
     if (ok) {
-        pCore->binController()->checkThumbnails(thumbsFolder);
+        pCore->binController()->checkThumbnails(thumbsFolder, pCore->bin()->visibleClipIds());
     }
     m_documentProperties.remove(QStringLiteral("position"));
     pCore->monitorManager()->activateMonitor(Kdenlive::ClipMonitor, true);
@@ -560,6 +573,12 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
     return m_documentProperties.value(QStringLiteral("generateimageproxy")).toInt() && width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt();
 }
 
+bool KdenliveDoc::autoGenerateSlowProxy(double decodeFps) const
+{
+    // Keep some margin, effects and scaling also need time
+    return m_documentProperties.value(QStringLiteral("generateslowproxy")).toInt() && decodeFps > 0 && decodeFps < fps() * 1.2;
+}
+
 void KdenliveDoc::slotAutoSave()
 {
     if (m_render && m_autosave) {
@@ -1034,6 +1053,9 @@ void KdenliveDoc::setDocumentProperty(const QString &name, const QString &value)
         return;
     }
     m_documentProperties[name] = value;
+    if (name == QLatin1String("generateslowproxy")) {
+        pCore->producerQueue()->setProbeDecodeSpeed(value.toInt());
+    }
 }
 
 const QString KdenliveDoc::getDocumentProperty(const QString &name, const QString &defaultValue) const
@@ -1364,7 +1386,12 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<ProjectClip *> clipLi
 
             if (doProxy) {
                 newProps.clear();
-                QString path = dir.absoluteFilePath(item->hash() + (t == Image ? QStringLiteral(".png") : extension));
+                QString name = item->hash();
+                if (t == Playlist) {
+                    // A new proxy file is needed when the nested media change
+                    name.append(QLatin1Char('-') + item->mediaSignature());
+                }
+                QString path = dir.absoluteFilePath(name + (t == Image ? QStringLiteral(".png") : extension));
                 // insert required duration for proxy
                 newProps.insert(QStringLiteral("proxy_out"), item->getProducerProperty(QStringLiteral("out")));
                 newProps.insert(QStringLiteral("kdenlive:proxy"), path);
@@ -1499,6 +1526,7 @@ void KdenliveDoc::loadDocumentProperties()
             }
         }
     }
+    pCore->producerQueue()->setProbeDecodeSpeed(m_documentProperties.value(QStringLiteral("generateslowproxy")).toInt());
     QString path = m_documentProperties.value(QStringLiteral("storagefolder"));
     if (!path.isEmpty()) {
         QDir dir(path);
@@ -1682,6 +1710,45 @@ void KdenliveDoc::displayMessage(const QString &text, MessageType type, int time
     pCore->window()->displayMessage(text, type, timeOut);
 }
 
+void KdenliveDoc::slotStartPreviewCalibration()
+{
+    if (m_calibrationTicket == -1 || m_previewCalibration.isRunning()) {
+        return;
+    }
+    if (!pCore->jobScheduler()->tryStart(m_calibrationTicket)) {
+        // Wait for a free slot
+        return;
+    }
+    m_previewCalibration.setFuture(QtConcurrent::run(&PreviewCalibration::calibrate, m_previewCandidates, m_profile.path, fps()));
+}
+
+void KdenliveDoc::slotPreviewCalibrated()
+{
+    if (m_calibrationTicket > -1) {
+        pCore->jobScheduler()->finish(m_calibrationTicket);
+        m_calibrationTicket = -1;
+    }
+    if (!m_previewCalibration.result() || !KdenliveSettings::previewparams().isEmpty()) {
+        return;
+    }
+    // Only replace our automatic choice, not a profile selected by the user
+    const QString current = getDocumentProperty(QStringLiteral("previewparameters")) + QLatin1Char(';') + getDocumentProperty(QStringLiteral("previewextension"));
+    if (m_previewCandidates.isEmpty() || current != m_previewCandidates.first()) {
+        return;
+    }
+    const QString bestMatch = PreviewCalibration::bestProfile(m_previewCandidates, m_profile.path, fps());
+    Timeline *timeline = pCore->projectManager()->currentTimeline();
+    if (bestMatch.isEmpty() || bestMatch == current || !timeline) {
+        return;
+    }
+    if (timeline->hasRenderedPreview()) {
+        // Switching profile would delete the rendered previews, let the user decide
+        displayMessage(i18n("Faster timeline preview settings are available for this computer, select them in the project settings"), InformationMessage);
+        return;
+    }
+    timeline->updatePreviewSettings(bestMatch);
+}
+
 void KdenliveDoc::selectPreviewProfile()
 {
     // Read preview profiles and find the best match
@@ -1728,11 +1795,16 @@ void KdenliveDoc::selectPreviewProfile()
             fallBackProfiles << i.value();
         }
     }
-    QString bestMatch;
-    if (!matchingProfiles.isEmpty()) {
-        bestMatch = matchingProfiles.first();
-    } else if (!fallBackProfiles.isEmpty()) {
-        bestMatch = fallBackProfiles.first();
+    m_previewCandidates = matchingProfiles.isEmpty() ? fallBackProfiles : matchingProfiles;
+    // Use the fastest profile on this computer, if it was measured
+    QString bestMatch = PreviewCalibration::bestProfile(m_previewCandidates, m_profile.path, fps());
+    if (bestMatch.isEmpty() && !m_previewCandidates.isEmpty()) {
+        bestMatch = m_previewCandidates.first();
+        if (m_previewCandidates.count() > 1 && m_calibrationTicket == -1) {
+            // Measure in a background job slot, after the clip jobs
+            m_calibrationTicket = pCore->jobScheduler()->enqueue(JobScheduler::CpuResource, i18n("Timeline preview calibration"), -1);
+            slotStartPreviewCalibration();
+        }
     }
     if (!bestMatch.isEmpty()) {
         setDocumentProperty(QStringLiteral("previewparameters"), bestMatch.section(QLatin1Char(';'), 0, 0));
@@ -1774,6 +1846,7 @@ void KdenliveDoc::initCacheDirs()
     dir.mkdir(QStringLiteral("preview"));
     dir.mkdir(QStringLiteral("audiothumbs"));
     dir.mkdir(QStringLiteral("videothumbs"));
+    dir.mkdir(QStringLiteral("freeze"));
     QDir cacheDir(kdenliveCacheDir);
     cacheDir.mkdir(QStringLiteral("proxy"));
 }
@@ -1814,6 +1887,9 @@ QDir KdenliveDoc::getCacheDir(CacheType type, bool *ok) const
     case CacheThumbs:
         basePath.append(QStringLiteral("/videothumbs"));
         break;
+    case CacheFreeze:
+        basePath.append(QStringLiteral("/freeze"));
+        break;
     default:
         break;
     }
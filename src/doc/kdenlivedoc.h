@@ -32,6 +32,7 @@
 #include <QObject>
 #include <QTimer>
 #include <QUrl>
+#include <QFutureWatcher>
 
 #include <kautosavefile.h>
 #include <KDirWatch>
@@ -150,6 +151,8 @@ public:
     bool useProxy() const;
     bool autoGenerateProxy(int width) const;
     bool autoGenerateImageProxy(int width) const;
+    /** @brief Returns true if a clip decoded at this speed cannot be played in real time and should be proxied. */
+    bool autoGenerateSlowProxy(double decodeFps) const;
     QString documentNotes() const;
     /** @brief Saves effects embedded in project file. */
     void saveCustomEffects(const QDomNodeList &customeffects);
@@ -205,6 +208,12 @@ private:
     QList<int> m_undoChunks;
     QMap<QString, QString> m_documentProperties;
     QMap<QString, QString> m_documentMetadata;
+    /** @brief Background measure of the timeline preview profiles */
+    QFutureWatcher<bool> m_previewCalibration;
+    /** @brief Job scheduler ticket of the preview calibration, -1 if none */
+    int m_calibrationTicket;
+    /** @brief Preview profiles that can be used with the project format */
+    QStringList m_previewCandidates;
 
     QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const;
 
@@ -244,6 +253,10 @@ private slots:
     void slotSwitchProfile();
     /** @brief Check if we did a new action invalidating more recent undo items. */
     void checkPreviewStack();
+    /** @brief Preview profiles were measured, switch to the best one if the user did not choose another one. */
+    void slotPreviewCalibrated();
+    /** @brief Start the queued preview calibration when the job scheduler has a free slot. */
+    void slotStartPreviewCalibration();
 
 signals:
     void resetProjectList();
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+#include "effectscache.h"
+#include "kdenlive_debug.h"
+
+#include <config-kdenlive.h>
+#include <mlt++/Mlt.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTextStream>
+
+#include <locale>
+
+// Increase when the cached descriptions change
+static const int CACHE_FORMAT = 1;
+
+EffectsCache::EffectsCache(const QString &key)
+    : m_modified(false)
+{
+    QFile file(cacheFile());
+    if (file.open(QIODevice::ReadOnly)) {
+        m_doc.setContent(&file, false);
+        file.close();
+    }
+    QDomElement root = m_doc.documentElement();
+    if (!root.isNull() && root.attribute(QStringLiteral("key")) == key) {
+        for (QDomElement entry = root.firstChildElement(QStringLiteral("service")); !entry.isNull(); entry = entry.nextSiblingElement(QStringLiteral("service"))) {
+            m_services.insert(entry.attribute(QStringLiteral("type")) + QLatin1Char('/') + entry.attribute(QStringLiteral("name")), entry);
+        }
+        return;
+    }
+    if (!root.isNull()) {
+        qCDebug(KDENLIVE_LOG) << "Effects cache is outdated, reading MLT metadata";
+    }
+    m_doc = QDomDocument();
+    root = m_doc.createElement(QStringLiteral("effectscache"));
+    root.setAttribute(QStringLiteral("key"), key);
+    m_doc.appendChild(root);
+}
+
+QDomElement EffectsCache::service(const QString &type, const QString &name) const
+{
+    return m_services.value(type + QLatin1Char('/') + name);
+}
+
+QDomElement EffectsCache::addService(const QString &type, const QString &name)
+{
+    const QString id = type + QLatin1Char('/') + name;
+    QDomElement entry = m_services.value(id);
+    if (entry.isNull()) {
+        entry = m_doc.createElement(QStringLiteral("service"));
+        entry.setAttribute(QStringLiteral("type"), type);
+        entry.setAttribute(QStringLiteral("name"), name);
+        m_doc.documentElement().appendChild(entry);
+        m_services.insert(id, entry);
+    }
+    m_modified = true;
+    return entry;
+}
+
+bool EffectsCache::description(const QString &type, const QString &name, QDomDocument &description) const
+{
+    const QDomElement entry = service(type, name);
+    if (entry.attribute(QStringLiteral("described")) != QLatin1String("1")) {
+        return false;
+    }
+    description = QDomDocument();
+    const QDomElement effect = entry.firstChildElement();
+    if (!effect.isNull()) {
+        description.appendChild(description.importNode(effect, true));
+    }
+    return true;
+}
+
+void EffectsCache::setDescription(const QString &type, const QString &name, const QDomDocument &description)
+{
+    QDomElement entry = addService(type, name);
+    while (!entry.firstChildElement().isNull()) {
+        entry.removeChild(entry.firstChildElement());
+    }
+    if (!description.documentElement().isNull()) {
+        entry.appendChild(m_doc.importNode(description.documentElement(), true));
+    }
+    entry.setAttribute(QStringLiteral("described"), 1);
+}
+
+bool EffectsCache::version(const QString &type, const QString &name, double &version) const
+{
+    const QDomElement entry = service(type, name);
+    if (!entry.hasAttribute(QStringLiteral("version"))) {
+        return false;
+    }
+    version = entry.attribute(QStringLiteral("version")).toDouble();
+    return true;
+}
+
+void EffectsCache::setVersion(const QString &type, const QString &name, double version)
+{
+    addService(type, name).setAttribute(QStringLiteral("version"), QString::number(version));
+}
+
+void EffectsCache::save()
+{
+    if (!m_modified) {
+        return;
+    }
+    const QString path = cacheFile();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCDebug(KDENLIVE_LOG) << "Cannot write effects cache" << path;
+        return;
+    }
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out << m_doc.toString();
+    file.close();
+    m_modified = false;
+}
+
+// static
+QString EffectsCache::cacheKey(const QStringList &services, const QStringList &folders)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(CACHE_FORMAT));
+    hash.addData(KDENLIVE_VERSION);
+    hash.addData(QByteArray(mlt_version_get_string()));
+    // MLT versions are read as numbers
+    hash.addData(QByteArray(setlocale(LC_NUMERIC, nullptr)));
+    hash.addData(services.join(QLatin1Char(',')).toUtf8());
+    // Module metadata may be updated without a new MLT version
+    QStringList checked = folders;
+    const QString dataFolder = QString::fromUtf8(mlt_environment("MLT_DATA"));
+    if (!dataFolder.isEmpty()) {
+        QDir mltData(dataFolder);
+        const QStringList modules = mltData.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        for (const QString &module : modules) {
+            checked << mltData.absoluteFilePath(module);
+        }
+    }
+    for (const QString &folder : checked) {
+        const QFileInfoList files = QDir(folder).entryInfoList(QDir::Files, QDir::Name);
+        for (const QFileInfo &info : files) {
+            hash.addData(info.absoluteFilePath().toUtf8());
+            hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+        }
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+// static
+QString EffectsCache::cacheFile()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/effectscache.xml");
+}
@@ -0,0 +1,68 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+#ifndef EFFECTSCACHE_H
+#define EFFECTSCACHE_H
+
+#include <QDomDocument>
+#include <QHash>
+#include <QStringList>
+
+/**
+ * @class EffectsCache
+ * @brief On disk copy of the effect and transition information read from MLT's metadata.
+ *
+ * Loading the metadata of every MLT service is the slow part of the startup. The cache
+ * keeps the descriptions created by initEffects and the service versions. It is only used
+ * if its key matches, the key covers the MLT and Kdenlive versions, the installed
+ * services and the effect files.
+ */
+
+class EffectsCache
+{
+public:
+    /** @brief Load the cache file, its content is dropped if it was written with another key. */
+    explicit EffectsCache(const QString &key);
+
+    /** @brief Returns true if the description of the service is cached.
+     *  The description is null for services that cannot be used as effects. */
+    bool description(const QString &type, const QString &name, QDomDocument &description) const;
+    void setDescription(const QString &type, const QString &name, const QDomDocument &description);
+    /** @brief Returns true if the version of the service is cached, -1 means no metadata. */
+    bool version(const QString &type, const QString &name, double &version) const;
+    void setVersion(const QString &type, const QString &name, double version);
+
+    /** @brief Write the cache file if something was added. */
+    void save();
+
+    /** @brief Key for the current installation.
+     *  @param services names of the installed MLT services
+     *  @param folders folders of the effect and transition files */
+    static QString cacheKey(const QStringList &services, const QStringList &folders);
+
+private:
+    QDomDocument m_doc;
+    /** @brief Cache entries by type and service name */
+    QHash<QString, QDomElement> m_services;
+    bool m_modified;
+    QDomElement service(const QString &type, const QString &name) const;
+    QDomElement addService(const QString &type, const QString &name);
+    static QString cacheFile();
+};
+
+#endif
@@ -21,6 +21,7 @@
 #include <klocalizedstring.h>
 
 EffectsList::EffectsList(bool indexRequired) : m_useIndex(indexRequired)
+    , m_lookupValid(false)
 {
     m_baseElement = createElement(QStringLiteral("list"));
     appendChild(m_baseElement);
@@ -57,6 +58,12 @@ QDomElement EffectsList::getEffectByName(const QString &name) const
 
 QDomElement EffectsList::getEffectByTag(const QString &tag, const QString &id) const
 {
+    if (updateLookup()) {
+        if (!id.isEmpty()) {
+            return m_idLookup.value(id);
+        }
+        return tag.isEmpty() ? QDomElement() : m_tagLookup.value(tag);
+    }
     QDomNodeList effects = m_baseElement.childNodes();
     if (effects.isEmpty()) {
         return QDomElement();
@@ -65,13 +72,6 @@ QDomElement EffectsList::getEffectByTag(const QString &tag, const QString &id) c
         QDomElement effect =  effects.at(i).toElement();
         if (!id.isEmpty()) {
             if (effect.attribute(QStringLiteral("id")) == id) {
-                if (effect.tagName() == QLatin1String("effectgroup")) {
-                    // Effect group
-                    QDomNodeList subeffects = effect.elementsByTagName(QStringLiteral("effect"));
-                    for (int j = 0; j < subeffects.count(); ++j) {
-                        QDomElement sub = subeffects.at(j).toElement();
-                    }
-                }
                 return effect;
             }
         } else if (!tag.isEmpty()) {
@@ -85,6 +85,9 @@ QDomElement EffectsList::getEffectByTag(const QString &tag, const QString &id) c
 
 QDomElement EffectsList::effectById(const QString &id) const
 {
+    if (updateLookup()) {
+        return id.isEmpty() ? QDomElement() : m_idLookup.value(id);
+    }
     QDomNodeList effects = m_baseElement.childNodes();
     for (int i = 0; i < effects.count(); ++i) {
         QDomElement effect =  effects.at(i).toElement();
@@ -97,6 +100,9 @@ QDomElement EffectsList::effectById(const QString &id) const
 
 bool EffectsList::hasTransition(const QString &tag) const
 {
+    if (updateLookup()) {
+        return m_tagLookup.contains(tag);
+    }
     QDomNodeList trans = m_baseElement.childNodes();
     for (int i = 0; i < trans.count(); ++i) {
         QDomElement effect =  trans.at(i).toElement();
@@ -109,6 +115,10 @@ bool EffectsList::hasTransition(const QString &tag) const
 
 int EffectsList::hasEffect(const QString &tag, const QString &id) const
 {
+    if (updateLookup()) {
+        const QDomElement effect = getEffectByTag(tag, id);
+        return effect.isNull() ? -1 : effect.attribute(QStringLiteral("kdenlive_ix")).toInt();
+    }
     QDomNodeList effects = m_baseElement.childNodes();
     for (int i = 0; i < effects.count(); ++i) {
         QDomElement effect =  effects.at(i).toElement();
@@ -220,6 +230,7 @@ void EffectsList::clone(const EffectsList &original)
 {
     setContent(original.toString());
     m_baseElement = documentElement();
+    invalidateLookup();
 }
 
 void EffectsList::clearList()
@@ -227,6 +238,39 @@ void EffectsList::clearList()
     while (!m_baseElement.firstChild().isNull()) {
         m_baseElement.removeChild(m_baseElement.firstChild());
     }
+    invalidateLookup();
+}
+
+bool EffectsList::updateLookup() const
+{
+    if (m_useIndex) {
+        return false;
+    }
+    if (m_lookupValid) {
+        return true;
+    }
+    m_idLookup.clear();
+    m_tagLookup.clear();
+    for (QDomElement effect = m_baseElement.firstChildElement(); !effect.isNull(); effect = effect.nextSiblingElement()) {
+        // Keep the first match, like the list scan
+        const QString id = effect.attribute(QStringLiteral("id"));
+        if (!id.isEmpty() && !m_idLookup.contains(id)) {
+            m_idLookup.insert(id, effect);
+        }
+        const QString tag = effect.attribute(QStringLiteral("tag"));
+        if (!tag.isEmpty() && !m_tagLookup.contains(tag)) {
+            m_tagLookup.insert(tag, effect);
+        }
+    }
+    m_lookupValid = true;
+    return true;
+}
+
+void EffectsList::invalidateLookup()
+{
+    m_lookupValid = false;
+    m_idLookup.clear();
+    m_tagLookup.clear();
 }
 
 // static
@@ -352,6 +396,7 @@ QDomElement EffectsList::append(const QDomElement &e)
         if (m_useIndex) {
             updateIndexes(m_baseElement.childNodes(), m_baseElement.childNodes().count() - 1);
         }
+        invalidateLookup();
     }
     return result;
 }
@@ -385,6 +430,7 @@ void EffectsList::removeAt(int ix)
     if (m_useIndex) {
         updateIndexes(effects, ix - 1);
     }
+    invalidateLookup();
 }
 
 QDomElement EffectsList::itemFromIndex(int ix) const
@@ -411,6 +457,7 @@ QDomElement EffectsList::insert(const QDomElement &effect)
     if (m_useIndex && ix > 0) {
         updateIndexes(effects, ix - 1);
     }
+    invalidateLookup();
     return result;
 }
 
@@ -456,4 +503,5 @@ void EffectsList::updateEffect(const QDomElement &effect)
     } else {
         m_baseElement.appendChild(importNode(effect, true));
     }
+    invalidateLookup();
 }
@@ -26,6 +26,7 @@
 #define EFFECTSLIST_H
 
 #include <QDomDocument>
+#include <QHash>
 
 namespace Kdenlive
 {
@@ -102,6 +103,14 @@ public:
 private:
     QDomElement m_baseElement;
     bool m_useIndex;
+    /** @brief First effect for each id and tag, for the lists of available effects and transitions.
+     *  Effect stacks (indexRequired) are short and edited in place, they are scanned instead. */
+    mutable QHash<QString, QDomElement> m_idLookup;
+    mutable QHash<QString, QDomElement> m_tagLookup;
+    mutable bool m_lookupValid;
+    /** @brief Rebuild the id and tag lookup if the list changed, returns false for effect stacks. */
+    bool updateLookup() const;
+    void invalidateLookup();
 };
 
 #endif
@@ -19,6 +19,7 @@
 
 #include "initeffects.h"
 #include "effectslist.h"
+#include "effectscache.h"
 
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
@@ -35,6 +36,27 @@
 #include <xlocale.h>
 #endif
 
+// MLT metadata saved from a previous start, only set while parsing the effects
+static EffectsCache *s_cache = nullptr;
+
+static double serviceVersion(std::unique_ptr<Mlt::Repository> &repository, mlt_service_type type, const QString &name)
+{
+    const QString typeName = type == transition_type ? QStringLiteral("transitions") : QStringLiteral("filters");
+    double version = -1;
+    if (s_cache && s_cache->version(typeName, name, version)) {
+        return version;
+    }
+    Mlt::Properties *metadata = repository->metadata(type, name.toUtf8().data());
+    if (metadata && metadata->is_valid()) {
+        version = metadata->get_double("version");
+    }
+    delete metadata;
+    if (s_cache) {
+        s_cache->setVersion(typeName, name, version);
+    }
+    return version;
+}
+
 // static
 void initEffects::refreshLumas()
 {
@@ -195,6 +217,12 @@ bool initEffects::parseEffectFiles(std::unique_ptr<Mlt::Repository> &repository,
     }
     delete transitions;
 
+    // Reading MLT's metadata is slow, reuse the result of the last start if nothing changed
+    QStringList effectFolders = QStandardPaths::locateAll(QStandardPaths::AppDataLocation, QStringLiteral("effects"), QStandardPaths::LocateDirectory);
+    effectFolders << QStandardPaths::locateAll(QStandardPaths::AppDataLocation, QStringLiteral("transitions"), QStandardPaths::LocateDirectory);
+    EffectsCache cache(EffectsCache::cacheKey(filtersList + producersList + transitionsItemList, effectFolders));
+    s_cache = &cache;
+
     // Create structure holding all transitions descriptions so that if an XML file has no description, we take it from MLT
     QMap<QString, QString> transDescriptions;
     foreach (const QString &transname, transitionsItemList) {
@@ -382,6 +410,8 @@ bool initEffects::parseEffectFiles(std::unique_ptr<Mlt::Repository> &repository,
         MainWindow::videoEffects.append(effect);
     }
 
+    cache.save();
+    s_cache = nullptr;
     return movit;
 }
 
@@ -506,12 +536,7 @@ void initEffects::parseEffectFile(EffectsList *customEffectList, EffectsList *au
             }
         }
 
-        double version = -1;
-        Mlt::Properties *metadata = repository->metadata(filter_type, tag.toUtf8().data());
-        if (metadata && metadata->is_valid()) {
-            version = metadata->get_double("version");
-        }
-        delete metadata;
+        double version = serviceVersion(repository, filter_type, tag);
 
         if (documentElement.hasAttribute(QStringLiteral("version"))) {
             // a specific version of the filter is required
@@ -554,6 +579,10 @@ QDomDocument initEffects::createDescriptionFromMlt(std::unique_ptr<Mlt::Reposito
 {
 
     QDomDocument ret;
+    // The description always comes from the filter metadata, whatever the requested type
+    if (s_cache && s_cache->description(QStringLiteral("filters"), filtername, ret)) {
+        return ret;
+    }
     Mlt::Properties *metadata = repository->metadata(filter_type, filtername.toLatin1().data());
     ////qCDebug(KDENLIVE_LOG) << filtername;
     if (metadata && metadata->is_valid()) {
@@ -676,6 +705,9 @@ QDomDocument initEffects::createDescriptionFromMlt(std::unique_ptr<Mlt::Reposito
     }
     delete metadata;
     metadata = nullptr;
+    if (s_cache) {
+        s_cache->setDescription(QStringLiteral("filters"), filtername, ret);
+    }
     /*QString outstr;
      QTextStream str(&outstr);
      ret.save(str, 2);
@@ -702,6 +734,12 @@ void initEffects::fillTransitionsList(std::unique_ptr<Mlt::Repository> &reposito
 
     foreach (const QString &name, names) {
         QDomDocument ret;
+        // Transitions described from MLT's metadata are cached, the custom ones are translated
+        const bool cacheable = s_cache && !customTransitions.contains(name);
+        if (cacheable && s_cache->description(QStringLiteral("transitions"), name, ret) && !ret.isNull()) {
+            transitions->append(ret.documentElement());
+            continue;
+        }
         QDomElement ktrans = ret.createElement(QStringLiteral("transition"));
         ret.appendChild(ktrans);
         ktrans.setAttribute(QStringLiteral("tag"), name);
@@ -848,6 +886,9 @@ void initEffects::fillTransitionsList(std::unique_ptr<Mlt::Repository> &reposito
         }
         delete metadata;
         metadata = nullptr;
+        if (cacheable) {
+            s_cache->setDescription(QStringLiteral("transitions"), name, ret);
+        }
         // Add the transition to the global list.
         ////qCDebug(KDENLIVE_LOG) << ret.toString();
         transitions->append(ret.documentElement());
@@ -989,12 +1030,7 @@ void initEffects::parseTransitionFile(EffectsList *transitionList, const QString
             }
         }
 
-        double version = -1;
-        Mlt::Properties *metadata = repository->metadata(transition_type, id.toUtf8().data());
-        if (metadata && metadata->is_valid()) {
-            version = metadata->get_double("version");
-        }
-        delete metadata;
+        double version = serviceVersion(repository, transition_type, id);
 
         if (documentElement.hasAttribute(QStringLiteral("version"))) {
             // a specific version of the filter is required
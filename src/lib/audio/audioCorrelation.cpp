@@ -9,7 +9,7 @@ the Free Software Foundation, either version 3 of the License, or
 */
 
 #include "audioCorrelation.h"
-#include "fftCorrelation.h"
+#include "multiResolutionCorrelation.h"
 
 #include "klocalizedstring.h"
 #include "kdenlive_debug.h"
@@ -18,7 +18,9 @@ the Free Software Foundation, either version 3 of the License, or
 #include <iostream>
 
 AudioCorrelation::AudioCorrelation(AudioEnvelope *mainTrackEnvelope) :
-    m_mainTrackEnvelope(mainTrackEnvelope)
+    m_mainTrackEnvelope(mainTrackEnvelope),
+    m_engine(nullptr),
+    m_mainReady(false)
 {
     m_mainTrackEnvelope->normalizeEnvelope();
     connect(m_mainTrackEnvelope, &AudioEnvelope::envelopeReady, this, &AudioCorrelation::slotAnnounceEnvelope);
@@ -26,10 +28,13 @@ AudioCorrelation::AudioCorrelation(AudioEnvelope *mainTrackEnvelope) :
 
 AudioCorrelation::~AudioCorrelation()
 {
+    delete m_engine;
     delete m_mainTrackEnvelope;
     foreach (AudioEnvelope *envelope, m_children) {
         delete envelope;
     }
+    qDeleteAll(m_batch);
+    qDeleteAll(m_batchReady);
     foreach (AudioCorrelationInfo *info, m_correlations) {
         delete info;
     }
@@ -39,7 +44,9 @@ AudioCorrelation::~AudioCorrelation()
 
 void AudioCorrelation::slotAnnounceEnvelope()
 {
+    m_mainReady = true;
     emit displayMessage(i18n("Audio analysis finished"), OperationCompletedMessage);
+    processBatch();
 }
 
 void AudioCorrelation::addChild(AudioEnvelope *envelope)
@@ -48,37 +55,66 @@ void AudioCorrelation::addChild(AudioEnvelope *envelope)
     connect(envelope, &AudioEnvelope::envelopeReady, this, &AudioCorrelation::slotProcessChild);
 }
 
+void AudioCorrelation::addChildren(const QList<AudioEnvelope *> &envelopes)
+{
+    // All envelopes are decoded in parallel by the global thread pool
+    m_batch << envelopes;
+    foreach (AudioEnvelope *envelope, envelopes) {
+        connect(envelope, &AudioEnvelope::envelopeReady, this, &AudioCorrelation::slotProcessBatchChild);
+        envelope->normalizeEnvelope();
+    }
+}
+
+void AudioCorrelation::slotProcessBatchChild(AudioEnvelope *envelope)
+{
+    if (m_batch.removeOne(envelope)) {
+        m_batchReady << envelope;
+    }
+    processBatch();
+}
+
+void AudioCorrelation::processBatch()
+{
+    if (!m_mainReady) {
+        return;
+    }
+    while (!m_batchReady.isEmpty()) {
+        AudioEnvelope *envelope = m_batchReady.takeFirst();
+        AudioAlignment alignment;
+        alignment.track = envelope->track();
+        alignment.startPos = envelope->startPos();
+        alignment.shift = processChild(envelope);
+        m_batchResults << alignment;
+    }
+    if (m_batch.isEmpty() && !m_batchResults.isEmpty()) {
+        QList<AudioAlignment> results = m_batchResults;
+        m_batchResults.clear();
+        emit gotBatchAlignData(results);
+    }
+}
+
 void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
+{
+    int shift = processChild(envelope);
+    emit gotAudioAlignData(envelope->track(), envelope->startPos(), shift);
+}
+
+int AudioCorrelation::processChild(AudioEnvelope *envelope)
 {
     const int sizeMain = m_mainTrackEnvelope->envelopeSize();
     const int sizeSub = envelope->envelopeSize();
 
     AudioCorrelationInfo *info = new AudioCorrelationInfo(sizeMain, sizeSub);
-    qint64 *correlation = info->correlationVector();
-
-    const qint64 *envMain = m_mainTrackEnvelope->envelope();
-    const qint64 *envSub = envelope->envelope();
-    qint64 max = 0;
-
-    if (sizeSub > 200) {
-        FFTCorrelation::correlate(envMain, sizeMain,
-                                  envSub, sizeSub,
-                                  correlation);
-    } else {
-        correlate(envMain, sizeMain,
-                  envSub, sizeSub,
-                  correlation,
-                  &max);
-        info->setMax(max);
+    if (!m_engine) {
+        m_engine = new MultiResolutionCorrelation(m_mainTrackEnvelope->envelope(), sizeMain);
     }
+    m_engine->correlate(envelope->envelope(), sizeSub, info);
 
     m_children.append(envelope);
     m_correlations.append(info);
 
     Q_ASSERT(m_correlations.size() == m_children.size());
-    int index = m_children.indexOf(envelope);
-    int shift = getShift(index);
-    emit gotAudioAlignData(envelope->track(), envelope->startPos(), shift);
+    return getShift(m_children.count() - 1);
 }
 
 int AudioCorrelation::getShift(int childIndex) const
@@ -104,8 +140,18 @@ void AudioCorrelation::correlate(const qint64 *envMain, int sizeMain,
                                  const qint64 *envSub, int sizeSub,
                                  qint64 *correlation,
                                  qint64 *out_max)
+{
+    correlate(envMain, sizeMain, envSub, sizeSub, correlation, -sizeSub, sizeMain, out_max);
+}
+
+void AudioCorrelation::correlate(const qint64 *envMain, int sizeMain,
+                                 const qint64 *envSub, int sizeSub,
+                                 qint64 *correlation,
+                                 int fromShift, int toShift,
+                                 qint64 *out_max)
 {
     Q_ASSERT(correlation != nullptr);
+    Q_ASSERT(fromShift >= -sizeSub && toShift <= sizeMain);
 
     qint64 const *left;
     qint64 const *right;
@@ -130,7 +176,7 @@ void AudioCorrelation::correlate(const qint64 *envMain, int sizeMain,
 
     QTime t;
     t.start();
-    for (int shift = -sizeSub; shift <= sizeMain; ++shift) {
+    for (int shift = fromShift; shift <= toShift; ++shift) {
 
         if (shift <= 0) {
             left = envSub - shift;
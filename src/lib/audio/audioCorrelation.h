@@ -16,6 +16,15 @@
 #include "definitions.h"
 #include <QList>
 
+class MultiResolutionCorrelation;
+
+/** Result of the alignment of one child: the clip at startPos on track must be moved by shift frames. */
+struct AudioAlignment {
+    int track;
+    int startPos;
+    int shift;
+};
+
 /**
   This class does the correlation between two tracks
   in order to synchronize (align) them.
@@ -35,6 +44,11 @@ public:
       This object will take ownership of the passed envelope.
       */
     void addChild(AudioEnvelope *envelope);
+    /**
+      Aligns several envelopes at once, gotBatchAlignData is emitted when all
+      of them are processed. This object takes ownership of the envelopes.
+      */
+    void addChildren(const QList<AudioEnvelope *> &envelopes);
 
     const AudioCorrelationInfo *info(int childIndex) const;
     int getShift(int childIndex) const;
@@ -47,18 +61,44 @@ public:
                           const qint64 *envSub, int sizeSub,
                           qint64 *correlation,
                           qint64 *out_max = nullptr);
+
+    /**
+      Same as above for the shifts between \c fromShift and \c toShift
+      (included, within -sizeSub..sizeMain). Other entries of \c correlation
+      are not modified.
+      */
+    static void correlate(const qint64 *envMain, int sizeMain,
+                          const qint64 *envSub, int sizeSub,
+                          qint64 *correlation,
+                          int fromShift, int toShift,
+                          qint64 *out_max = nullptr);
 private:
     AudioEnvelope *m_mainTrackEnvelope;
 
     QList<AudioEnvelope *> m_children;
     QList<AudioCorrelationInfo *> m_correlations;
+    /** Correlation engine for the main envelope, with the FFT plans shared by all children */
+    MultiResolutionCorrelation *m_engine;
+    /** Children of the current batch still loading their envelope */
+    QList<AudioEnvelope *> m_batch;
+    /** Children of the current batch waiting for the main envelope */
+    QList<AudioEnvelope *> m_batchReady;
+    QList<AudioAlignment> m_batchResults;
+    bool m_mainReady;
+
+    /** Correlate the child with the main envelope and return its shift */
+    int processChild(AudioEnvelope *envelope);
+    /** Process the loaded children of the batch and announce the results once all are done */
+    void processBatch();
 
 private slots:
     void slotProcessChild(AudioEnvelope *envelope);
     void slotAnnounceEnvelope();
+    void slotProcessBatchChild(AudioEnvelope *envelope);
 
 signals:
     void gotAudioAlignData(int, int, int);
+    void gotBatchAlignData(const QList<AudioAlignment> &alignments);
     void displayMessage(const QString &, MessageType);
 };
 
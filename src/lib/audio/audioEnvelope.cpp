@@ -12,6 +12,7 @@
 
 #include "audioStreamInfo.h"
 #include "kdenlive_debug.h"
+#include <QFile>
 #include <QImage>
 #include <QTime>
 #include <QtConcurrent>
@@ -30,7 +31,8 @@ AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int of
     m_envelopeStdDevCalculated(false),
     m_envelopeIsNormalized(false)
 {
-    // make a copy of the producer to avoid audio playback issues
+    // The given producer is only read, the envelope is decoded from a private
+    // audio only producer so the timeline and other envelopes are not affected
     QString path = QString::fromUtf8(producer->get("resource"));
     if (path == QLatin1String("<playlist>") || path == QLatin1String("<tractor>") || path == QLatin1String("<producer>")) {
         path = url;
@@ -39,6 +41,11 @@ AudioEnvelope::AudioEnvelope(const QString &url, Mlt::Producer *producer, int of
     connect(&m_watcher, &QFutureWatcherBase::finished, this, &AudioEnvelope::slotProcessEnveloppe);
     if (!m_producer || !m_producer->is_valid()) {
         qCDebug(KDENLIVE_LOG) << "// Cannot create envelope for producer: " << path;
+    } else {
+        if (producer->get("audio_index")) {
+            m_producer->set("audio_index", producer->get_int("audio_index"));
+        }
+        m_producer->set("video_index", -1);
     }
     m_info = new AudioInfo(m_producer);
 
@@ -70,17 +77,50 @@ int AudioEnvelope::envelopeSize() const
     return m_envelopeSize;
 }
 
+void AudioEnvelope::setCacheFile(const QString &path)
+{
+    m_cacheFile = path;
+}
+
+bool AudioEnvelope::loadCachedEnvelope()
+{
+    if (m_cacheFile.isEmpty()) {
+        return false;
+    }
+    QFile file(m_cacheFile);
+    if (file.size() != (qint64) sizeof(qint64) * m_envelopeSize || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    if (file.read((char *) m_envelope, file.size()) != file.size()) {
+        return false;
+    }
+    m_envelopeMax = 0;
+    m_envelopeMean = 0;
+    for (int i = 0; i < m_envelopeSize; ++i) {
+        m_envelopeMean += m_envelope[i];
+        if (m_envelope[i] > m_envelopeMax) {
+            m_envelopeMax = m_envelope[i];
+        }
+    }
+    m_envelopeMean /= m_envelopeSize;
+    qCDebug(KDENLIVE_LOG) << "Envelope read from cache" << m_cacheFile;
+    return true;
+}
+
 void AudioEnvelope::loadEnvelope()
 {
     Q_ASSERT(m_envelope == nullptr);
 
     qCDebug(KDENLIVE_LOG) << "Loading envelope ...";
+    m_envelope = new qint64[m_envelopeSize];
+    if (loadCachedEnvelope()) {
+        return;
+    }
 
     int samplingRate = m_info->info(0)->samplingRate();
     mlt_audio_format format_s16 = mlt_audio_s16;
     int channels = 1;
 
-    m_envelope = new qint64[m_envelopeSize];
     m_envelopeMax = 0;
     m_envelopeMean = 0;
 
@@ -120,6 +160,12 @@ void AudioEnvelope::loadEnvelope()
     m_envelopeMean /= m_envelopeSize;
     qCDebug(KDENLIVE_LOG) << "Calculating the envelope (" << m_envelopeSize << " frames) took "
                           << t.elapsed() << " ms.";
+    if (!m_cacheFile.isEmpty()) {
+        QFile file(m_cacheFile);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write((const char *) m_envelope, (qint64) sizeof(qint64) * m_envelopeSize);
+        }
+    }
 }
 
 int AudioEnvelope::track() const
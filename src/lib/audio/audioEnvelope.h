@@ -31,6 +31,7 @@ class AudioEnvelope : public QObject
     Q_OBJECT
 
 public:
+    /** @brief Prepares the envelope of the clip played by producer, which is not modified. */
     explicit AudioEnvelope(const QString &url, Mlt::Producer *producer, int offset = 0, int length = 0, int track = 0, int startPos = 0);
     virtual ~AudioEnvelope();
 
@@ -48,6 +49,9 @@ public:
     int track() const;
     int startPos() const;
 
+    /** @brief Store the envelope in this file, and read it from there instead of decoding the clip if it exists. */
+    void setCacheFile(const QString &path);
+
 private:
     qint64 *m_envelope;
     Mlt::Producer *m_producer;
@@ -59,6 +63,7 @@ private:
     int m_length;
     int m_track;
     int m_startpos;
+    QString m_cacheFile;
 
     int m_envelopeSize;
     qint64 m_envelopeMax;
@@ -68,6 +73,9 @@ private:
     bool m_envelopeStdDevCalculated;
     bool m_envelopeIsNormalized;
 
+    /** @brief Read the envelope from the cache file, returns false if it is missing or does not match. */
+    bool loadCachedEnvelope();
+
 private slots:
     void slotProcessEnveloppe();
 
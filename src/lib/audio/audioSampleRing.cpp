@@ -0,0 +1,125 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "audioSampleRing.h"
+
+#include <string.h>
+
+AudioSampleRing::AudioSampleRing(int capacity) :
+    m_writePos(0),
+    m_readPos(0),
+    m_writerChannels(0),
+    m_writerFrequency(0),
+    m_channels(0),
+    m_frequency(0),
+    m_formatPos(0),
+    m_formatChanged(0),
+    m_readerChannels(0),
+    m_readerFrequency(0)
+{
+    int size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    m_buffer = new qint16[size];
+    m_mask = size - 1;
+}
+
+AudioSampleRing::~AudioSampleRing()
+{
+    delete[] m_buffer;
+}
+
+bool AudioSampleRing::write(const qint16 *data, int frames, int channels, int frequency)
+{
+    if (frames <= 0 || channels <= 0) {
+        return true;
+    }
+    const int count = frames * channels;
+    const uint writePos = m_writePos.load();
+    if (channels != m_writerChannels || frequency != m_writerFrequency) {
+        // Publish the new format, the reader will skip everything written before this position
+        m_writerChannels = channels;
+        m_writerFrequency = frequency;
+        m_channels.store(channels);
+        m_frequency.store(frequency);
+        m_formatPos.store(writePos);
+        m_formatChanged.storeRelease(1);
+    }
+    const int used = (int)(writePos - m_readPos.loadAcquire());
+    if (count > m_mask + 1 - used) {
+        return false;
+    }
+    const int start = (int)(writePos & (uint) m_mask);
+    const int first = qMin(count, m_mask + 1 - start);
+    memcpy(m_buffer + start, data, first * sizeof(qint16));
+    if (first < count) {
+        memcpy(m_buffer, data + first, (count - first) * sizeof(qint16));
+    }
+    m_writePos.storeRelease(writePos + (uint) count);
+    return true;
+}
+
+bool AudioSampleRing::checkFormat()
+{
+    if (!m_formatChanged.testAndSetAcquire(1, 0)) {
+        return false;
+    }
+    // Skip unread samples from the previous format, never move backwards
+    const uint formatPos = m_formatPos.load();
+    if ((int)(formatPos - m_readPos.load()) > 0) {
+        m_readPos.storeRelease(formatPos);
+    }
+    m_readerChannels = m_channels.load();
+    m_readerFrequency = m_frequency.load();
+    return true;
+}
+
+int AudioSampleRing::read(qint16 *data, int maxFrames)
+{
+    if (m_readerChannels <= 0) {
+        return 0;
+    }
+    const uint readPos = m_readPos.load();
+    int available = (int)(m_writePos.loadAcquire() - readPos);
+    if (m_formatChanged.loadAcquire()) {
+        // Do not read past the format switch until checkFormat() was called
+        available = qMin(available, (int)(m_formatPos.load() - readPos));
+    }
+    const int frames = qMin(available / m_readerChannels, maxFrames);
+    if (frames <= 0) {
+        return 0;
+    }
+    const int count = frames * m_readerChannels;
+    const int start = (int)(readPos & (uint) m_mask);
+    const int first = qMin(count, m_mask + 1 - start);
+    memcpy(data, m_buffer + start, first * sizeof(qint16));
+    if (first < count) {
+        memcpy(data + first, m_buffer, (count - first) * sizeof(qint16));
+    }
+    m_readPos.storeRelease(readPos + (uint) count);
+    return frames;
+}
+
+void AudioSampleRing::clear()
+{
+    checkFormat();
+    m_readPos.storeRelease(m_writePos.loadAcquire());
+}
+
+int AudioSampleRing::channels() const
+{
+    return m_readerChannels;
+}
+
+int AudioSampleRing::frequency() const
+{
+    return m_readerFrequency;
+}
@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef AUDIOSAMPLERING_H
+#define AUDIOSAMPLERING_H
+
+#include <QAtomicInt>
+#include <QtGlobal>
+
+/**
+  Lock-free ring buffer of interleaved 16 bit samples, with exactly one
+  writer thread (the MLT consumer) and one reader thread (the meter).
+
+  The buffer is allocated once, writing and reading never allocate nor block.
+  When the reader does not keep up, new audio is dropped instead of
+  overwriting unread samples.
+  */
+class AudioSampleRing
+{
+public:
+    /** @param capacity number of samples (all channels) the ring can hold, rounded up to a power of 2 */
+    explicit AudioSampleRing(int capacity = 1 << 18);
+    ~AudioSampleRing();
+
+    /** @brief Writer side: append @param frames frames of interleaved audio.
+     *  @return false if there was not enough room and the audio was dropped */
+    bool write(const qint16 *data, int frames, int channels, int frequency);
+
+    /** @brief Reader side: copy at most @param maxFrames frames to @param data.
+     *  Call checkFormat() first so that the data is read with the correct channel count.
+     *  @return the number of frames read */
+    int read(qint16 *data, int maxFrames);
+
+    /** @brief Reader side: returns true if the audio format changed since the last call.
+     *  Audio written in the previous format that was not read yet is discarded. */
+    bool checkFormat();
+    /** @brief Reader side: drop all pending audio */
+    void clear();
+
+    int channels() const;
+    int frequency() const;
+
+private:
+    qint16 *m_buffer;
+    int m_mask;
+    /** @brief Free running positions, only the writer stores m_writePos and only the reader stores m_readPos */
+    QAtomicInteger<uint> m_writePos;
+    QAtomicInteger<uint> m_readPos;
+    /** @brief Format of the written audio, owned by the writer */
+    int m_writerChannels;
+    int m_writerFrequency;
+    /** @brief Format published to the reader */
+    QAtomicInt m_channels;
+    QAtomicInt m_frequency;
+    QAtomicInteger<uint> m_formatPos;
+    QAtomicInt m_formatChanged;
+    /** @brief Format used by the reader */
+    int m_readerChannels;
+    int m_readerFrequency;
+};
+
+#endif // AUDIOSAMPLERING_H
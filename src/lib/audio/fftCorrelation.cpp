@@ -45,36 +45,105 @@ void FFTCorrelation::correlate(const qint64 *left, const int leftSize,
     float leftF[leftSize];
     float rightF[rightSize];
 
+    // One side needs to be reversed, since multiplication in frequency domain (fourier space)
+    // calculates the convolution: \sum l[x]r[N-x] and not the correlation: \sum l[x]r[x]
+    normalize(left, leftSize, leftF, false);
+    normalize(right, rightSize, rightF, true);
+
+    // Now we can convolve to get the correlation
+    convolve(leftF, leftSize, rightF, rightSize, out_correlated);
+
+    qCDebug(KDENLIVE_LOG) << "Correlation (FFT based) computed in " << t.elapsed() << " ms.";
+}
+
+void FFTCorrelation::normalize(const qint64 *data, const int size, float *out, bool reverse)
+{
     // First the qint64 values need to be normalized to floats
     // Dividing by the max value is maybe not the best solution, but the
     // maximum value after correlation should not be larger than the longest
     // vector since each value should be at most 1
-    qint64 maxLeft = 1;
-    qint64 maxRight = 1;
-    for (int i = 0; i < leftSize; ++i) {
-        if (labs(left[i]) > maxLeft) {
-            maxLeft = labs(left[i]);
+    qint64 max = 1;
+    for (int i = 0; i < size; ++i) {
+        if (labs(data[i]) > max) {
+            max = labs(data[i]);
         }
     }
-    for (int i = 0; i < rightSize; ++i) {
-        if (labs(right[i]) > maxRight) {
-            maxRight = labs(right[i]);
-        }
+    for (int i = 0; i < size; ++i) {
+        out[reverse ? size - 1 - i : i] = double(data[i]) / max;
     }
+}
 
-    // One side needs to be reversed, since multiplication in frequency domain (fourier space)
-    // calculates the convolution: \sum l[x]r[N-x] and not the correlation: \sum l[x]r[x]
-    for (int i = 0; i < leftSize; ++i) {
-        leftF[i] = double(left[i]) / maxLeft;
+int FFTCorrelation::fftSize(const int leftSize, const int rightSize)
+{
+    // Pad to at least twice the largest size, see convolve()
+    const int largestSize = std::max(leftSize, rightSize);
+    int size = 64;
+    while (size / 2 < largestSize) {
+        size = size << 1;
     }
-    for (int i = 0; i < rightSize; ++i) {
-        rightF[rightSize - 1 - i] = double(right[i]) / maxRight;
+    return size;
+}
+
+FFTCorrelation::Plan::Plan(const int fftSize) :
+    m_size(fftSize),
+    m_referenceSize(0),
+    m_reference(fftSize / 2 + 1),
+    m_spectrum(fftSize / 2 + 1),
+    m_buffer(fftSize),
+    m_output(fftSize + 1)
+{
+    m_fftConfig = kiss_fftr_alloc(m_size, false, nullptr, nullptr);
+    m_ifftConfig = kiss_fftr_alloc(m_size, true, nullptr, nullptr);
+}
+
+FFTCorrelation::Plan::~Plan()
+{
+    kiss_fftr_free(m_fftConfig);
+    kiss_fftr_free(m_ifftConfig);
+}
+
+int FFTCorrelation::Plan::fftSize() const
+{
+    return m_size;
+}
+
+void FFTCorrelation::Plan::setReference(const qint64 *left, const int leftSize)
+{
+    Q_ASSERT(2 * leftSize <= m_size);
+    std::fill(m_buffer.begin(), m_buffer.end(), 0);
+    normalize(left, leftSize, &m_buffer[0], false);
+    kiss_fftr(m_fftConfig, &m_buffer[0], &m_reference[0]);
+    m_referenceSize = leftSize;
+}
+
+void FFTCorrelation::Plan::correlate(const qint64 *right, const int rightSize, float *out_correlated)
+{
+    Q_ASSERT(FFTCorrelation::fftSize(m_referenceSize, rightSize) <= m_size);
+
+    std::fill(m_buffer.begin(), m_buffer.end(), 0);
+    normalize(right, rightSize, &m_buffer[0], true);
+    kiss_fftr(m_fftConfig, &m_buffer[0], &m_spectrum[0]);
+    for (size_t i = 0; i < m_spectrum.size(); ++i) {
+        const kiss_fft_cpx &l = m_reference[i];
+        const kiss_fft_cpx r = m_spectrum[i];
+        m_spectrum[i].r = l.r * r.r - l.i * r.i;
+        m_spectrum[i].i = l.r * r.i + l.i * r.r;
     }
+    kiss_fftri(m_ifftConfig, &m_spectrum[0], &m_buffer[0]);
 
-    // Now we can convolve to get the correlation
-    convolve(leftF, leftSize, rightF, rightSize, out_correlated);
+    // Same layout as convolve(): one leading element
+    const int out_size = m_referenceSize + rightSize + 1;
+    *out_correlated = 0;
+    std::copy(m_buffer.begin(), m_buffer.begin() + out_size - 1, out_correlated + 1);
+}
 
-    qCDebug(KDENLIVE_LOG) << "Correlation (FFT based) computed in " << t.elapsed() << " ms.";
+void FFTCorrelation::Plan::correlate(const qint64 *right, const int rightSize, qint64 *out_correlated)
+{
+    correlate(right, rightSize, &m_output[0]);
+    const int out_size = m_referenceSize + rightSize + 1;
+    for (int i = 0; i < out_size; ++i) {
+        out_correlated[i] = m_output[i];
+    }
 }
 
 void FFTCorrelation::convolve(const float *left, const int leftSize,
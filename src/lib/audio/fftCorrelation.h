@@ -12,6 +12,9 @@ the Free Software Foundation, either version 3 of the License, or
 #define FFTCORRELATION_H
 
 #include <QtGlobal>
+#include <vector>
+#include "../external/kiss_fft/tools/kiss_fftr.h"
+
 /**
   This class provides methods to calculate convolution
   and correlation of two vectors by means of FFT, which
@@ -43,6 +46,49 @@ public:
     static void correlate(const qint64 *left, const int leftSize,
                           const qint64 *right, const int rightSize,
                           qint64 *out_correlated);
+
+    /**
+      FFT size needed to correlate vectors of size \c leftSize and \c rightSize.
+      */
+    static int fftSize(const int leftSize, const int rightSize);
+
+    /**
+      FFT configurations and buffers for correlations of one size, reused for
+      every vector correlated against the same \c left (reference) vector.
+      */
+    class Plan
+    {
+    public:
+        explicit Plan(const int fftSize);
+        ~Plan();
+
+        int fftSize() const;
+
+        /** Transforms the reference vector, kept for the following correlations. */
+        void setReference(const qint64 *left, const int leftSize);
+
+        /**
+          Same as FFTCorrelation::correlate() with the reference as \c left vector.
+          \c rightSize must not be larger than the size this plan was made for.
+          */
+        void correlate(const qint64 *right, const int rightSize, float *out_correlated);
+        void correlate(const qint64 *right, const int rightSize, qint64 *out_correlated);
+
+    private:
+        Q_DISABLE_COPY(Plan)
+        int m_size;
+        int m_referenceSize;
+        kiss_fftr_cfg m_fftConfig;
+        kiss_fftr_cfg m_ifftConfig;
+        std::vector<kiss_fft_cpx> m_reference;
+        std::vector<kiss_fft_cpx> m_spectrum;
+        std::vector<float> m_buffer;
+        std::vector<float> m_output;
+    };
+
+private:
+    /** Copies \c data to \c out, divided by its maximum absolute value. */
+    static void normalize(const qint64 *data, const int size, float *out, bool reverse);
 };
 
 #endif // FFTCORRELATION_H
@@ -13,7 +13,9 @@
 #include <math.h>
 #include <iostream>
 
-#include <QString>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QThreadStorage>
 
 // Uncomment for debugging, like writing a GNU Octave .m file to /tmp
 //#define DEBUG_FFTTOOLS
@@ -24,26 +26,40 @@
 #include <fstream>
 #endif
 
-FFTTools::FFTTools() :
-    m_fftCfgs(),
-    m_windowFunctions()
+namespace {
+// FFT configurations and buffers of one thread. kiss_fftr configurations
+// contain a work buffer, so they cannot be shared between threads.
+struct FFTWorkspace {
+    ~FFTWorkspace()
+    {
+        for (kiss_fftr_cfg cfg : cfgs) {
+            free(cfg);
+        }
+    }
+    QHash<uint, kiss_fftr_cfg> cfgs;
+    QVector<float> data;
+    QVector<kiss_fft_cpx> freqData;
+};
+
+QThreadStorage<FFTWorkspace *> workspaces;
+
+// Window functions are never modified once built, all threads share them
+QReadWriteLock windowLock;
+QHash<quint64, QVector<float> > windowFunctions;
+}
+
+FFTTools::FFTTools()
 {
 }
 FFTTools::~FFTTools()
 {
-    QHash<QString, kiss_fftr_cfg>::iterator i;
-    for (i = m_fftCfgs.begin(); i != m_fftCfgs.end(); ++i) {
-        free(*i);
-    }
 }
 
-const QString FFTTools::windowSignature(const WindowType windowType, const int size, const float param)
+quint64 FFTTools::windowKey(const WindowType windowType, const int size, const float param)
 {
-    return QStringLiteral("s%1_t%2_p%3").arg(size).arg(windowType).arg(param, 0, 'f', 3);
-}
-const QString FFTTools::cfgSignature(const int size)
-{
-    return QStringLiteral("s%1").arg(size);
+    // Same precision as the parameter of the former string signature
+    const quint64 roundedParam = (quint32) qRound(param * 1000);
+    return ((quint64) size << 40) | ((quint64) windowType << 32) | roundedParam;
 }
 
 // http://cplusplus.syntaxerrors.info/index.php?title=Cannot_declare_member_function_%E2%80%98static_int_Foo::bar%28%29%E2%80%99_to_have_static_linkage
@@ -124,23 +140,20 @@ void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint chan
         return;
     }
 
-    const QString cfgSig = cfgSignature(windowSize);
-    const QString winSig = windowSignature(windowType, windowSize, param);
+    if (!workspaces.hasLocalData()) {
+        workspaces.setLocalData(new FFTWorkspace);
+    }
+    FFTWorkspace *workspace = workspaces.localData();
 
     // Get the kiss_fft configuration from the config cache
     // or build a new configuration if the requested one is not available.
-    kiss_fftr_cfg myCfg;
-    if (m_fftCfgs.contains(cfgSig)) {
-#ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Re-using FFT configuration with size " << windowSize;
-#endif
-        myCfg = m_fftCfgs.value(cfgSig);
-    } else {
+    kiss_fftr_cfg myCfg = workspace->cfgs.value(windowSize);
+    if (!myCfg) {
 #ifdef DEBUG_FFTTOOLS
         qCDebug(KDENLIVE_LOG) << "Creating FFT configuration with size " << windowSize;
 #endif
         myCfg = kiss_fftr_alloc(windowSize, false, nullptr, nullptr);
-        m_fftCfgs.insert(cfgSig, myCfg);
+        workspace->cfgs.insert(windowSize, myCfg);
     }
 
     // Get the window function from the cache
@@ -148,40 +161,46 @@ void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint chan
     QVector<float> window;
     float windowScaleFactor = 1;
     if (windowType != FFTTools::Window_Rect) {
-
-        if (m_windowFunctions.contains(winSig)) {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Re-using window function with signature " << winSig;
-#endif
-            window = m_windowFunctions.value(winSig);
-        } else {
+        const quint64 key = windowKey(windowType, windowSize, param);
+        windowLock.lockForRead();
+        window = windowFunctions.value(key);
+        windowLock.unlock();
+        if (window.isEmpty()) {
 #ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Building new window function with signature " << winSig;
+            qCDebug(KDENLIVE_LOG) << "Building new window function with key " << key;
 #endif
-            window = FFTTools::window(windowType, windowSize, 0);
-            m_windowFunctions.insert(winSig, window);
+            window = FFTTools::window(windowType, windowSize, param);
+            windowLock.lockForWrite();
+            windowFunctions.insert(key, window);
+            windowLock.unlock();
         }
         windowScaleFactor = 1.0 / window[windowSize];
     }
 
     // Prepare frequency space vector. The resulting FFT vector is only half as long.
-    kiss_fft_cpx freqData[windowSize / 2];
-    float data[windowSize];
+    if ((uint) workspace->data.size() < windowSize) {
+        workspace->data.resize(windowSize);
+        workspace->freqData.resize(windowSize / 2 + 1);
+    }
+    float *data = workspace->data.data();
+    kiss_fft_cpx *freqData = workspace->freqData.data();
 
     // Copy the first channel's audio into a vector for the FFT display;
     // Fill the data vector indices that cannot be covered with sample data with 0
     if (numSamples < windowSize) {
-        std::fill(&data[numSamples], &data[windowSize - 1], 0);
+        std::fill(data + numSamples, data + windowSize, 0);
     }
     // Normalize signals to [0,1] to get correct dB values later on
-    for (uint i = 0; i < numSamples && i < windowSize; ++i) {
-        // Performance note: Benchmarking has shown that using the if/else inside the loop
-        // does not do noticeable worse than keeping it outside (perhaps the branch predictor
-        // is good enough), so it remains in there for better readability.
-        if (windowType != FFTTools::Window_Rect) {
-            data[i] = (float) audioFrame.data()[i * numChannels + channel] / 32767.0f * window[i];
-        } else {
-            data[i] = (float) audioFrame.data()[i * numChannels + channel] / 32767.0f;
+    const qint16 *samples = audioFrame.constData() + channel;
+    const uint count = qMin(numSamples, windowSize);
+    if (windowType != FFTTools::Window_Rect) {
+        const float *factors = window.constData();
+        for (uint i = 0; i < count; ++i) {
+            data[i] = (float) samples[i * numChannels] / 32767.0f * factors[i];
+        }
+    } else {
+        for (uint i = 0; i < count; ++i) {
+            data[i] = (float) samples[i * numChannels] / 32767.0f;
         }
     }
 
@@ -189,11 +208,13 @@ void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint chan
     kiss_fftr(myCfg, data, freqData);
 
     // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-    // with N = FFT size (after FFT, 1/2 window size)
+    // with N = FFT size (after FFT, 1/2 window size),
+    // computed as 10 * log(r² + i²) - 20 * log(N / 2) to avoid the square root
+    const float offset = 20 * log10f((float) windowSize / 2.0f);
     for (uint i = 0; i < windowSize / 2; ++i) {
-        // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-        // with N = FFT size (after FFT, 1/2 window size)
-        freqSpectrum[i] = 20 * log(pow(pow(fabs(freqData[i].r * windowScaleFactor), 2) + pow(fabs(freqData[i].i * windowScaleFactor), 2), .5) / ((float)windowSize / 2.0f)) / log(10);;
+        const float r = freqData[i].r * windowScaleFactor;
+        const float im = freqData[i].i * windowScaleFactor;
+        freqSpectrum[i] = 10 * log10f(r * r + im * im) - offset;
     }
 
 #ifdef DEBUG_FFTTOOLS
@@ -226,19 +247,25 @@ void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint chan
 }
 
 const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left, uint right, float fill)
+{
+    Q_ASSERT(targetSize > 0);
+    QVector<float> out(targetSize);
+    interpolatePeakPreserving(in.constData(), in.size(), out.data(), targetSize, left, right, fill);
+    return out;
+}
+
+void FFTTools::interpolatePeakPreserving(const float *in, const uint inSize, float *out, const uint targetSize, uint left, uint right, float fill)
 {
 #ifdef DEBUG_FFTTOOLS
     QTime start = QTime::currentTime();
 #endif
 
     if (right == 0) {
-        right = in.size() - 1;
+        right = inSize - 1;
     }
     Q_ASSERT(targetSize > 0);
     Q_ASSERT(left < right);
 
-    QVector<float> out(targetSize);
-
     float x;
     uint xi;
     uint i;
@@ -254,14 +281,14 @@ const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &i
             x = ((float) i) / (targetSize - 1) * (right - left) + left;
             xi = (int) floor(x);
 
-            if (x > in.size() - 1) {
+            if (x > inSize - 1) {
                 // This may happen if right > in.size()-1; Fill the rest of the vector
                 // with the default value now.
                 break;
             }
 
             // Use linear interpolation in order to get smoother display
-            if (xi == 0 || xi == (uint) in.size() - 1) {
+            if (xi == 0 || xi == inSize - 1) {
                 // ... except if we are at the left or right border of the input sigal.
                 // Special case here since we consider previous and future values as well for
                 // the actual interpolation (not possible here).
@@ -297,7 +324,7 @@ const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &i
 
             out[i] = fill;
 
-            for (; src < xi && src < (uint) in.size(); ++src) {
+            for (; src < xi && src < inSize; ++src) {
                 if (out[i] < in[src]) {
                     out[i] = in[src];
                 }
@@ -313,10 +340,8 @@ const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &i
     }
 
 #ifdef DEBUG_FFTTOOLS
-    qCDebug(KDENLIVE_LOG) << "Interpolated " << targetSize << " nodes from " << in.size() << " input points in " << start.elapsed() << " ms";
+    qCDebug(KDENLIVE_LOG) << "Interpolated " << targetSize << " nodes from " << inSize << " input points in " << start.elapsed() << " ms";
 #endif
-
-    return out;
 }
 
 #ifdef DEBUG_FFTTOOLS
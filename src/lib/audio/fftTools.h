@@ -12,7 +12,6 @@
 #define FFTTOOLS_H
 
 #include <QVector>
-#include <QHash>
 #include "../../definitions.h"
 #include "../external/kiss_fft/tools/kiss_fftr.h"
 
@@ -39,11 +38,8 @@ public:
     */
     static const QVector<float> window(const WindowType windowType, const int size, const float param = 0);
 
-    static const QString windowSignature(const WindowType windowType, const int size, const float param = 0);
-
-    /** Returns a signature for a kiss_fft configuration
-        used as a hash in the cache */
-    static const QString cfgSignature(const int size);
+    /** Returns the key of a window function in the window cache. */
+    static quint64 windowKey(const WindowType windowType, const int size, const float param = 0);
 
     /** Calculates the Fourier Tranformation of the input audio frame.
         The resulting values will be given in relative dezibel: The maximum power is 0 dB, lower powers have
@@ -53,6 +49,8 @@ public:
         * windowSize must be divisible by 2,
         * freqSpectrum has to be of size windowSize/2
         For windowType and param see the FFTTools::window() function above.
+        This is thread safe. FFT configurations and buffers are kept per thread, window functions
+        are shared, so that no allocation is done once a size has been used.
     */
     void fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum,
                        const WindowType windowType, const uint windowSize, const float param = 0);
@@ -72,10 +70,8 @@ public:
                             will be used for filling the missing information.
         */
     static const QVector<float> interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left = 0, uint right = 0, float fill = 0.0);
-
-private:
-    QHash<QString, kiss_fftr_cfg> m_fftCfgs; // FFT cfg cache
-    QHash<QString, QVector<float> > m_windowFunctions; // Window function cache
+    /** Same as above, writing the targetSize values to out instead of allocating a vector. */
+    static void interpolatePeakPreserving(const float *in, const uint inSize, float *out, const uint targetSize, uint left = 0, uint right = 0, float fill = 0.0);
 
 };
 
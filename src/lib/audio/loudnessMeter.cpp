@@ -0,0 +1,403 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "loudnessMeter.h"
+
+#include <math.h>
+
+const double LoudnessMeter::AbsoluteGate = -70.0;
+const double LoudnessMeter::TruePeakFloor = -120.0;
+
+LoudnessInfo::LoudnessInfo() :
+    momentary(-HUGE_VAL),
+    shortTerm(-HUGE_VAL),
+    integrated(-HUGE_VAL),
+    range(0),
+    truePeak(-HUGE_VAL)
+{
+}
+
+LoudnessMeter::LoudnessMeter() :
+    m_channels(0),
+    m_frequency(0),
+    m_blockLength(0),
+    m_blockFill(0),
+    m_blockIndex(0),
+    m_blockCount(0),
+    m_momentary(-HUGE_VAL),
+    m_shortTerm(-HUGE_VAL),
+    m_oversampling(1),
+    m_historyPos(0)
+{
+}
+
+void LoudnessMeter::configure(int channels, int frequency)
+{
+    m_channels = qMax(1, channels);
+    m_frequency = qMax(8000, frequency);
+
+    // Channel weights from BS.1770, assuming the MLT 5.1 order L R C LFE Ls Rs
+    m_weights.fill(1.0, m_channels);
+    if (m_channels == 6) {
+        m_weights[3] = 0.0;
+        m_weights[4] = 1.41;
+        m_weights[5] = 1.41;
+    }
+
+    // K-weighting: high shelf pre-filter followed by the RLB high pass,
+    // coefficients recomputed for the actual sample rate
+    double f0 = 1681.974450955533;
+    double gain = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = tan(M_PI * f0 / m_frequency);
+    double vh = pow(10.0, gain / 20.0);
+    double vb = pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    m_b[0][0] = (vh + vb * k / q + k * k) / a0;
+    m_b[0][1] = 2.0 * (k * k - vh) / a0;
+    m_b[0][2] = (vh - vb * k / q + k * k) / a0;
+    m_a[0][0] = 1.0;
+    m_a[0][1] = 2.0 * (k * k - 1.0) / a0;
+    m_a[0][2] = (1.0 - k / q + k * k) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = tan(M_PI * f0 / m_frequency);
+    a0 = 1.0 + k / q + k * k;
+    m_b[1][0] = 1.0;
+    m_b[1][1] = -2.0;
+    m_b[1][2] = 1.0;
+    m_a[1][0] = 1.0;
+    m_a[1][1] = 2.0 * (k * k - 1.0) / a0;
+    m_a[1][2] = (1.0 - k / q + k * k) / a0;
+
+    m_blockLength = m_frequency / 10;
+    m_blocks.fill(0.0, 30);
+    m_blockSums.fill(0.0, m_channels);
+    m_filterState.fill(0.0, 4 * m_channels);
+    m_momentaryHistogram.fill(0, HistogramBins);
+    m_momentaryEnergy.fill(0.0, HistogramBins);
+    m_shortTermHistogram.fill(0, HistogramBins);
+    m_shortTermEnergy.fill(0.0, HistogramBins);
+
+    // Windowed sinc interpolator, one phase per oversampled position
+    if (m_frequency < 96000) {
+        m_oversampling = 4;
+    } else if (m_frequency < 192000) {
+        m_oversampling = 2;
+    } else {
+        m_oversampling = 1;
+    }
+    const int length = m_oversampling * TruePeakTaps;
+    const double center = (length - 1) / 2.0;
+    m_interpolator.fill(0.0, length);
+    for (int phase = 0; phase < m_oversampling; ++phase) {
+        double sum = 0;
+        for (int j = 0; j < TruePeakTaps; ++j) {
+            const int n = phase + j * m_oversampling;
+            const double x = (n - center) / m_oversampling;
+            const double sinc = qFuzzyIsNull(x) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            const double window = 0.42 - 0.5 * cos(2 * M_PI * (n + 0.5) / length) + 0.08 * cos(4 * M_PI * (n + 0.5) / length);
+            // History is read oldest sample first
+            m_interpolator[phase * TruePeakTaps + TruePeakTaps - 1 - j] = sinc * window;
+            sum += sinc * window;
+        }
+        for (int j = 0; j < TruePeakTaps; ++j) {
+            m_interpolator[phase * TruePeakTaps + j] /= sum;
+        }
+    }
+    m_history.fill(0.0, 2 * TruePeakTaps * m_channels);
+    m_truePeaks.fill(0.0, m_channels);
+    m_recentPeaks.fill(0.0, m_channels);
+    reset();
+}
+
+void LoudnessMeter::reset()
+{
+    m_blockFill = 0;
+    m_blockIndex = 0;
+    m_blockCount = 0;
+    m_historyPos = 0;
+    m_momentary = -HUGE_VAL;
+    m_shortTerm = -HUGE_VAL;
+    m_blocks.fill(0.0);
+    m_blockSums.fill(0.0);
+    m_filterState.fill(0.0);
+    m_history.fill(0.0);
+    clearMeasurements();
+}
+
+void LoudnessMeter::clearMeasurements()
+{
+    m_momentaryHistogram.fill(0);
+    m_momentaryEnergy.fill(0.0);
+    m_shortTermHistogram.fill(0);
+    m_shortTermEnergy.fill(0.0);
+    m_truePeaks.fill(0.0);
+    m_recentPeaks.fill(0.0);
+}
+
+void LoudnessMeter::process(const qint16 *data, int frames)
+{
+    if (m_channels == 0) {
+        return;
+    }
+    double *state = m_filterState.data();
+    double *sums = m_blockSums.data();
+    double *history = m_history.data();
+    double *truePeaks = m_truePeaks.data();
+    double *recentPeaks = m_recentPeaks.data();
+    const double *interpolator = m_interpolator.constData();
+    for (int i = 0; i < frames; ++i) {
+        for (int c = 0; c < m_channels; ++c) {
+            const double x = data[i * m_channels + c] / 32768.0;
+            const double level = fabs(x);
+            if (level > recentPeaks[c]) {
+                recentPeaks[c] = level;
+            }
+            // True peak
+            double peak = level;
+            if (m_oversampling > 1) {
+                double *channelHistory = history + 2 * TruePeakTaps * c;
+                channelHistory[m_historyPos] = x;
+                channelHistory[m_historyPos + TruePeakTaps] = x;
+                const double *window = channelHistory + m_historyPos + 1;
+                for (int phase = 0; phase < m_oversampling; ++phase) {
+                    const double *coeffs = interpolator + phase * TruePeakTaps;
+                    double y = 0;
+                    for (int j = 0; j < TruePeakTaps; ++j) {
+                        y += coeffs[j] * window[j];
+                    }
+                    peak = qMax(peak, fabs(y));
+                }
+            }
+            if (peak > truePeaks[c]) {
+                truePeaks[c] = peak;
+            }
+            // K-weighting, transposed direct form II
+            double *z = state + 4 * c;
+            double y = m_b[0][0] * x + z[0];
+            z[0] = m_b[0][1] * x - m_a[0][1] * y + z[1];
+            z[1] = m_b[0][2] * x - m_a[0][2] * y;
+            const double w = m_b[1][0] * y + z[2];
+            z[2] = m_b[1][1] * y - m_a[1][1] * w + z[3];
+            z[3] = m_b[1][2] * y - m_a[1][2] * w;
+            sums[c] += w * w;
+        }
+        if (m_oversampling > 1) {
+            m_historyPos = (m_historyPos + 1) % TruePeakTaps;
+        }
+        if (++m_blockFill == m_blockLength) {
+            finishBlock();
+        }
+    }
+}
+
+void LoudnessMeter::merge(const LoudnessMeter &other)
+{
+    if (other.m_channels != m_channels || other.m_frequency != m_frequency) {
+        return;
+    }
+    for (int i = 0; i < HistogramBins; ++i) {
+        m_momentaryHistogram[i] += other.m_momentaryHistogram.at(i);
+        m_momentaryEnergy[i] += other.m_momentaryEnergy.at(i);
+        m_shortTermHistogram[i] += other.m_shortTermHistogram.at(i);
+        m_shortTermEnergy[i] += other.m_shortTermEnergy.at(i);
+    }
+    for (int c = 0; c < m_channels; ++c) {
+        m_truePeaks[c] = qMax(m_truePeaks.at(c), other.m_truePeaks.at(c));
+        m_recentPeaks[c] = qMax(m_recentPeaks.at(c), other.m_recentPeaks.at(c));
+    }
+}
+
+void LoudnessMeter::finishBlock()
+{
+    double energy = 0;
+    for (int c = 0; c < m_channels; ++c) {
+        energy += m_weights.at(c) * m_blockSums.at(c);
+        m_blockSums[c] = 0.0;
+    }
+    m_blockFill = 0;
+    m_blocks[m_blockIndex] = energy;
+    m_blockIndex = (m_blockIndex + 1) % m_blocks.size();
+    m_blockCount = qMin(m_blockCount + 1, m_blocks.size());
+    if (m_blockCount >= 4) {
+        // 400ms gating block, overlapping by 75%
+        double sum = 0;
+        for (int i = 1; i <= 4; ++i) {
+            sum += m_blocks.at((m_blockIndex - i + m_blocks.size()) % m_blocks.size());
+        }
+        const double mean = sum / (4.0 * m_blockLength);
+        m_momentary = energyToLoudness(mean);
+        addToHistogram(m_momentaryHistogram, m_momentaryEnergy, m_momentary, mean);
+    }
+    if (m_blockCount == m_blocks.size()) {
+        double sum = 0;
+        for (double block : m_blocks) {
+            sum += block;
+        }
+        const double mean = sum / ((double) m_blocks.size() * m_blockLength);
+        m_shortTerm = energyToLoudness(mean);
+        addToHistogram(m_shortTermHistogram, m_shortTermEnergy, m_shortTerm, mean);
+    }
+}
+
+void LoudnessMeter::addToHistogram(QVector<quint32> &histogram, QVector<double> &energies, double loudness, double energy)
+{
+    if (loudness < AbsoluteGate) {
+        return;
+    }
+    const int bin = histogramBin(loudness);
+    histogram[bin]++;
+    energies[bin] += energy;
+}
+
+double LoudnessMeter::energyToLoudness(double energy)
+{
+    if (energy <= 0) {
+        return -HUGE_VAL;
+    }
+    return -0.691 + 10.0 * log10(energy);
+}
+
+int LoudnessMeter::histogramBin(double loudness)
+{
+    return qBound(0, (int)((loudness - AbsoluteGate) * 10.0), HistogramBins - 1);
+}
+
+int LoudnessMeter::channels() const
+{
+    return m_channels;
+}
+
+int LoudnessMeter::frequency() const
+{
+    return m_frequency;
+}
+
+double LoudnessMeter::momentary() const
+{
+    return m_momentary < AbsoluteGate ? -HUGE_VAL : m_momentary;
+}
+
+double LoudnessMeter::shortTerm() const
+{
+    return m_shortTerm < AbsoluteGate ? -HUGE_VAL : m_shortTerm;
+}
+
+double LoudnessMeter::integrated() const
+{
+    if (m_momentaryHistogram.isEmpty()) {
+        return -HUGE_VAL;
+    }
+    quint64 count = 0;
+    double energy = 0;
+    for (int i = 0; i < HistogramBins; ++i) {
+        count += m_momentaryHistogram.at(i);
+        energy += m_momentaryEnergy.at(i);
+    }
+    if (count == 0) {
+        return -HUGE_VAL;
+    }
+    // Relative gate, 10 LU below the absolute gated loudness
+    const double gate = energyToLoudness(energy / count) - 10.0;
+    const int start = histogramBin(gate);
+    count = 0;
+    energy = 0;
+    for (int i = start; i < HistogramBins; ++i) {
+        count += m_momentaryHistogram.at(i);
+        energy += m_momentaryEnergy.at(i);
+    }
+    if (count == 0) {
+        return -HUGE_VAL;
+    }
+    return energyToLoudness(energy / count);
+}
+
+double LoudnessMeter::loudnessRange() const
+{
+    if (m_shortTermHistogram.isEmpty()) {
+        return 0;
+    }
+    quint64 count = 0;
+    double energy = 0;
+    for (int i = 0; i < HistogramBins; ++i) {
+        count += m_shortTermHistogram.at(i);
+        energy += m_shortTermEnergy.at(i);
+    }
+    if (count == 0) {
+        return 0;
+    }
+    // Relative gate, 20 LU below the absolute gated loudness
+    const int start = histogramBin(energyToLoudness(energy / count) - 20.0);
+    count = 0;
+    for (int i = start; i < HistogramBins; ++i) {
+        count += m_shortTermHistogram.at(i);
+    }
+    if (count == 0) {
+        return 0;
+    }
+    // Distance between the 10th and 95th percentiles
+    const quint64 lowCount = qMax<quint64>(1, count / 10);
+    const quint64 highCount = qMax<quint64>(1, (count * 95) / 100);
+    int low = start;
+    int high = start;
+    quint64 cumulated = 0;
+    for (int i = start; i < HistogramBins; ++i) {
+        const quint64 previous = cumulated;
+        cumulated += m_shortTermHistogram.at(i);
+        if (previous < lowCount && cumulated >= lowCount) {
+            low = i;
+        }
+        if (previous < highCount && cumulated >= highCount) {
+            high = i;
+            break;
+        }
+    }
+    return (high - low) / 10.0;
+}
+
+double LoudnessMeter::truePeak() const
+{
+    double peak = 0;
+    for (double value : m_truePeaks) {
+        peak = qMax(peak, value);
+    }
+    return peak > 0 ? 20.0 * log10(peak) : -HUGE_VAL;
+}
+
+double LoudnessMeter::truePeak(int channel) const
+{
+    if (channel < 0 || channel >= m_truePeaks.size() || m_truePeaks.at(channel) <= 0) {
+        return -HUGE_VAL;
+    }
+    return 20.0 * log10(m_truePeaks.at(channel));
+}
+
+LoudnessInfo LoudnessMeter::info() const
+{
+    LoudnessInfo result;
+    result.momentary = momentary();
+    result.shortTerm = shortTerm();
+    result.integrated = integrated();
+    result.range = loudnessRange();
+    result.truePeak = truePeak();
+    return result;
+}
+
+const QVector<double> &LoudnessMeter::recentPeaks() const
+{
+    return m_recentPeaks;
+}
+
+void LoudnessMeter::clearRecentPeaks()
+{
+    m_recentPeaks.fill(0.0);
+}
@@ -0,0 +1,129 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *   This file is part of kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef LOUDNESSMETER_H
+#define LOUDNESSMETER_H
+
+#include <QMetaType>
+#include <QVector>
+
+/** @brief Snapshot of the loudness measurements, in LUFS / LU / dBTP */
+struct LoudnessInfo {
+    LoudnessInfo();
+    double momentary;
+    double shortTerm;
+    double integrated;
+    double range;
+    double truePeak;
+};
+Q_DECLARE_METATYPE(LoudnessInfo)
+
+/**
+  Loudness measurement following EBU R128 / ITU-R BS.1770.
+
+  Audio is K-weighted and accumulated in 100ms blocks, from which the momentary
+  (400ms) and short-term (3s) loudness are derived. Gated blocks are stored in
+  histograms with 0.1 LU resolution, so that the integrated loudness and the
+  loudness range can be computed at any time without keeping the whole history.
+  The true peak is measured on a 4x oversampled signal (2x above 96kHz).
+
+  All buffers are allocated in configure(), process() never allocates.
+  */
+class LoudnessMeter
+{
+public:
+    LoudnessMeter();
+
+    /** @brief Setup the filters for the given format, this also resets all measurements */
+    void configure(int channels, int frequency);
+    /** @brief Reset all measurements, keeping the current format */
+    void reset();
+    /** @brief Forget the gated blocks and peaks measured so far, keeping the filter and block state.
+     *  Audio processed before this call only primes the 400ms and 3s windows */
+    void clearMeasurements();
+    /** @brief Analyse interleaved 16 bit audio */
+    void process(const qint16 *data, int frames);
+    /** @brief Add the gated blocks and peaks measured by another meter with the same format,
+     *  used to combine the analysis of consecutive parts of a clip */
+    void merge(const LoudnessMeter &other);
+
+    int channels() const;
+    int frequency() const;
+
+    /** @brief Loudness of the last 400ms, in LUFS */
+    double momentary() const;
+    /** @brief Loudness of the last 3s, in LUFS */
+    double shortTerm() const;
+    /** @brief Gated loudness since the last reset, in LUFS */
+    double integrated() const;
+    /** @brief Loudness range since the last reset, in LU */
+    double loudnessRange() const;
+    /** @brief Highest true peak since the last reset over all channels, in dBTP */
+    double truePeak() const;
+    /** @brief Highest true peak since the last reset for a channel, in dBTP */
+    double truePeak(int channel) const;
+    LoudnessInfo info() const;
+
+    /** @brief Linear sample peak for each channel since the last call to clearRecentPeaks() */
+    const QVector<double> &recentPeaks() const;
+    void clearRecentPeaks();
+
+    /** @brief Lowest loudness taken into account, anything below is reported as -HUGE_VAL */
+    static const double AbsoluteGate;
+    /** @brief Lowest true peak displayed, in dBTP, anything below is shown as silence */
+    static const double TruePeakFloor;
+
+private:
+    int m_channels;
+    int m_frequency;
+    QVector<double> m_weights;
+
+    /** @brief K-weighting filter coefficients (pre-filter and RLB high pass) */
+    double m_b[2][3];
+    double m_a[2][3];
+    /** @brief Filter state, 4 values per channel */
+    QVector<double> m_filterState;
+
+    /** @brief Samples in a 100ms block */
+    int m_blockLength;
+    int m_blockFill;
+    QVector<double> m_blockSums;
+    /** @brief Weighted energy of the last 30 blocks */
+    QVector<double> m_blocks;
+    int m_blockIndex;
+    int m_blockCount;
+    double m_momentary;
+    double m_shortTerm;
+
+    /** @brief Histograms of gated 400ms blocks and 3s windows: count and energy sum per 0.1 LU bin */
+    QVector<quint32> m_momentaryHistogram;
+    QVector<double> m_momentaryEnergy;
+    QVector<quint32> m_shortTermHistogram;
+    QVector<double> m_shortTermEnergy;
+
+    /** @brief Polyphase interpolation filter, m_oversampling phases of TruePeakTaps coefficients */
+    int m_oversampling;
+    QVector<double> m_interpolator;
+    /** @brief Last input samples, stored twice per channel to always read them contiguously */
+    QVector<double> m_history;
+    int m_historyPos;
+    QVector<double> m_truePeaks;
+    QVector<double> m_recentPeaks;
+
+    static const int TruePeakTaps = 12;
+    static const int HistogramBins = 800;
+
+    void finishBlock();
+    void addToHistogram(QVector<quint32> &histogram, QVector<double> &energies, double loudness, double energy);
+    static double energyToLoudness(double energy);
+    static int histogramBin(double loudness);
+};
+
+#endif // LOUDNESSMETER_H
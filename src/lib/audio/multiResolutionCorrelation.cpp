@@ -0,0 +1,143 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "multiResolutionCorrelation.h"
+#include "audioCorrelation.h"
+#include "audioCorrelationInfo.h"
+
+#include "kdenlive_debug.h"
+#include <QList>
+#include <QTime>
+#include <algorithm>
+
+// Main envelopes shorter than this many entries are correlated at full resolution
+static const int coarseSize = 4096;
+// Minimum size of the decimated child envelope, smaller ones give unreliable peaks
+static const int minCoarseSubSize = 64;
+// Number of coarse peaks checked at full resolution
+static const int coarsePeaks = 3;
+// Above this number of multiplications, correlate with FFT instead of directly
+static const qint64 directCorrelationLimit = 1 << 22;
+
+MultiResolutionCorrelation::MultiResolutionCorrelation(const qint64 *envMain, int sizeMain) :
+    m_envMain(envMain),
+    m_sizeMain(sizeMain),
+    m_multiResolution(true)
+{
+}
+
+MultiResolutionCorrelation::~MultiResolutionCorrelation()
+{
+    qDeleteAll(m_plans);
+}
+
+void MultiResolutionCorrelation::setMultiResolution(bool enable)
+{
+    m_multiResolution = enable;
+}
+
+int MultiResolutionCorrelation::decimation(int sizeSub) const
+{
+    if (!m_multiResolution || m_sizeMain <= coarseSize) {
+        return 1;
+    }
+    const int factor = std::min((m_sizeMain + coarseSize - 1) / coarseSize, sizeSub / minCoarseSubSize);
+    // Not worth a second pass
+    return factor < 4 ? 1 : factor;
+}
+
+void MultiResolutionCorrelation::decimate(const qint64 *envelope, int size, int factor, std::vector<qint64> &out)
+{
+    out.assign((size + factor - 1) / factor, 0);
+    for (int i = 0; i < size; ++i) {
+        out[i / factor] += envelope[i];
+    }
+}
+
+FFTCorrelation::Plan *MultiResolutionCorrelation::plan(int factor, const qint64 *envMain, int sizeMain, int sizeSub)
+{
+    const QPair<int, int> key(factor, FFTCorrelation::fftSize(sizeMain, sizeSub));
+    FFTCorrelation::Plan *result = m_plans.value(key);
+    if (!result) {
+        result = new FFTCorrelation::Plan(key.second);
+        result->setReference(envMain, sizeMain);
+        m_plans.insert(key, result);
+    }
+    return result;
+}
+
+void MultiResolutionCorrelation::correlate(const qint64 *envSub, int sizeSub, AudioCorrelationInfo *info)
+{
+    QTime t;
+    t.start();
+    qint64 *correlation = info->correlationVector();
+    const int factor = decimation(sizeSub);
+    if (factor == 1) {
+        if ((qint64) sizeSub * (m_sizeMain + sizeSub) <= directCorrelationLimit) {
+            qint64 max = 0;
+            AudioCorrelation::correlate(m_envMain, m_sizeMain, envSub, sizeSub, correlation, &max);
+            info->setMax(max);
+        } else {
+            plan(1, m_envMain, m_sizeMain, sizeSub)->correlate(envSub, sizeSub, correlation);
+        }
+        return;
+    }
+
+    // Coarse search on the decimated envelopes
+    std::vector<qint64> &coarseMain = m_decimatedMain[factor];
+    if (coarseMain.empty()) {
+        decimate(m_envMain, m_sizeMain, factor, coarseMain);
+    }
+    decimate(envSub, sizeSub, factor, m_decimatedSub);
+    const int coarseSizeMain = coarseMain.size();
+    const int coarseSizeSub = m_decimatedSub.size();
+    m_coarse.resize(coarseSizeMain + coarseSizeSub + 1);
+    plan(factor, &coarseMain[0], coarseSizeMain, coarseSizeSub)->correlate(&m_decimatedSub[0], coarseSizeSub, &m_coarse[0]);
+
+    // Refine around the best peaks, a coarse entry covers factor shifts and the
+    // decimation blocks of both envelopes may be misaligned by up to one entry
+    std::fill(correlation, correlation + info->size(), 0);
+    QList<int> peaks;
+    for (int n = 0; n < coarsePeaks; ++n) {
+        int best = -1;
+        for (int i = 0; i < (int) m_coarse.size(); ++i) {
+            if (best >= 0 && m_coarse[i] <= m_coarse[best]) {
+                continue;
+            }
+            bool close = false;
+            for (int peak : peaks) {
+                if (qAbs(peak - i) <= 2) {
+                    close = true;
+                    break;
+                }
+            }
+            if (!close) {
+                best = i;
+            }
+        }
+        if (best < 0 || m_coarse[best] <= 0) {
+            break;
+        }
+        peaks << best;
+        const int shift = (best - coarseSizeSub) * factor;
+        AudioCorrelation::correlate(m_envMain, m_sizeMain, envSub, sizeSub, correlation,
+                                    std::max(-sizeSub, shift - 2 * factor), std::min(m_sizeMain, shift + 2 * factor));
+    }
+    qCDebug(KDENLIVE_LOG) << "Multi resolution correlation (factor" << factor << ") computed in" << t.elapsed() << "ms.";
+}
@@ -0,0 +1,74 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef MULTIRESOLUTIONCORRELATION_H
+#define MULTIRESOLUTIONCORRELATION_H
+
+#include "fftCorrelation.h"
+
+#include <QMap>
+#include <QPair>
+#include <vector>
+
+class AudioCorrelationInfo;
+
+/**
+  Correlates envelopes against one main envelope, for long recordings.
+
+  The shift is first searched on decimated envelopes (one entry for several
+  frames), then refined at frame resolution around the best coarse peaks.
+  Short envelopes are correlated at full resolution, with FFT or directly.
+  FFT plans and buffers are kept for the next envelopes of the same size.
+  */
+class MultiResolutionCorrelation
+{
+public:
+    /** The main envelope is not copied and must stay valid. */
+    MultiResolutionCorrelation(const qint64 *envMain, int sizeMain);
+    ~MultiResolutionCorrelation();
+
+    /** Disable the coarse search, always correlate at full resolution (for comparison). */
+    void setMultiResolution(bool enable);
+
+    /**
+      Fills the correlation vector of \c info. With the coarse search, only the
+      refined windows are computed and the other entries are 0.
+      */
+    void correlate(const qint64 *envSub, int sizeSub, AudioCorrelationInfo *info);
+
+    /** Number of frames per entry used for the coarse search, 1 if there is none. */
+    int decimation(int sizeSub) const;
+
+private:
+    Q_DISABLE_COPY(MultiResolutionCorrelation)
+    const qint64 *m_envMain;
+    int m_sizeMain;
+    bool m_multiResolution;
+    /** Decimated main envelope, by decimation factor */
+    QMap<int, std::vector<qint64> > m_decimatedMain;
+    /** FFT plans by decimation factor and FFT size, their reference is the (decimated) main envelope */
+    QMap<QPair<int, int>, FFTCorrelation::Plan *> m_plans;
+    std::vector<qint64> m_decimatedSub;
+    std::vector<float> m_coarse;
+
+    FFTCorrelation::Plan *plan(int factor, const qint64 *envMain, int sizeMain, int sizeSub);
+    static void decimate(const qint64 *envelope, int size, int factor, std::vector<qint64> &out);
+};
+
+#endif // MULTIRESOLUTIONCORRELATION_H
@@ -0,0 +1,287 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "yuvConverter.h"
+
+#include <QRgb>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YUVCONVERTER_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 code is built with a function attribute, the rest of the program does not require it
+#if defined(YUVCONVERTER_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define YUVCONVERTER_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+
+namespace {
+// Converts a row from the given pixel to the end of the row.
+typedef void (*Packed422Row)(const uchar *src, uchar *dst, int width, YuvConverter::PackedOrder order, int from);
+typedef void (*Planar420Row)(const uchar *y, const uchar *u, const uchar *v, uchar *dst, int width, int from);
+
+inline int clampByte(int value)
+{
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+inline void scalarPixel(int y, int u, int v, uchar *dst)
+{
+    const int c = 298 * (y - 16) + 128;
+    const int d = u - 128;
+    const int e = v - 128;
+    *reinterpret_cast<QRgb *>(dst) = qRgb(clampByte((c + 409 * e) >> 8), clampByte((c - 100 * d - 208 * e) >> 8), clampByte((c + 516 * d) >> 8));
+}
+
+void packed422RowScalar(const uchar *src, uchar *dst, int width, YuvConverter::PackedOrder order, int from)
+{
+    const int yOffset = order == YuvConverter::YUYV ? 0 : 1;
+    const int uOffset = order == YuvConverter::YUYV ? 1 : 0;
+    int x = from;
+    for (; x + 2 <= width; x += 2) {
+        const uchar *pair = src + x * 2;
+        const int u = pair[uOffset];
+        const int v = pair[uOffset + 2];
+        scalarPixel(pair[yOffset], u, v, dst + x * 4);
+        scalarPixel(pair[yOffset + 2], u, v, dst + x * 4 + 4);
+    }
+    if (x < width) {
+        // Odd width, the last pixel has no chroma of its own
+        const uchar *pair = src + x * 2;
+        if (x > 0) {
+            scalarPixel(pair[yOffset], pair[uOffset - 4], pair[uOffset - 2], dst + x * 4);
+        } else {
+            scalarPixel(pair[yOffset], 128, 128, dst + x * 4);
+        }
+    }
+}
+
+void planar420RowScalar(const uchar *y, const uchar *u, const uchar *v, uchar *dst, int width, int from)
+{
+    for (int x = from; x < width; ++x) {
+        scalarPixel(y[x], u[x / 2], v[x / 2], dst + x * 4);
+    }
+}
+
+#ifdef YUVCONVERTER_SSE2
+// Two 16 bit coefficients, for _mm_madd_epi16
+inline int coefficientPair(int low, int high)
+{
+    return (int)((quint32)(quint16)low | ((quint32)(quint16)high << 16));
+}
+
+/* Converts 8 pixels: y holds 8 luma values and c 4 (U, V) pairs, as 16 bit integers.
+   Products are summed in 32 bit so that results are exactly the scalar ones. */
+inline void convert8Sse2(__m128i y, __m128i c, uchar *dst)
+{
+    const __m128i luma = _mm_sub_epi16(y, _mm_set1_epi16(16));
+    const __m128i chroma = _mm_sub_epi16(c, _mm_set1_epi16(128));
+    // 298 * (Y - 16) + 128, from (Y - 16, 128) pairs
+    const __m128i yCoef = _mm_set1_epi32(coefficientPair(298, 1));
+    const __m128i rounding = _mm_set1_epi16(128);
+    const __m128i yLow = _mm_madd_epi16(_mm_unpacklo_epi16(luma, rounding), yCoef);
+    const __m128i yHigh = _mm_madd_epi16(_mm_unpackhi_epi16(luma, rounding), yCoef);
+    // Chroma terms of each pair, used for both pixels of the pair
+    const __m128i rChroma = _mm_madd_epi16(chroma, _mm_set1_epi32(coefficientPair(0, 409)));
+    const __m128i gChroma = _mm_madd_epi16(chroma, _mm_set1_epi32(coefficientPair(-100, -208)));
+    const __m128i bChroma = _mm_madd_epi16(chroma, _mm_set1_epi32(coefficientPair(516, 0)));
+    const __m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLow, _mm_unpacklo_epi32(rChroma, rChroma)), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(yHigh, _mm_unpackhi_epi32(rChroma, rChroma)), 8));
+    const __m128i g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLow, _mm_unpacklo_epi32(gChroma, gChroma)), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(yHigh, _mm_unpackhi_epi32(gChroma, gChroma)), 8));
+    const __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLow, _mm_unpacklo_epi32(bChroma, bChroma)), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(yHigh, _mm_unpackhi_epi32(bChroma, bChroma)), 8));
+    // Saturate to bytes and interleave as B, G, R, A: QRgb in memory on little endian
+    const __m128i bg = _mm_packus_epi16(b, g);
+    const __m128i ra = _mm_packus_epi16(r, _mm_set1_epi16(255));
+    const __m128i bgPairs = _mm_unpacklo_epi8(bg, _mm_srli_si128(bg, 8));
+    const __m128i raPairs = _mm_unpacklo_epi8(ra, _mm_srli_si128(ra, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi16(bgPairs, raPairs));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_unpackhi_epi16(bgPairs, raPairs));
+}
+
+void packed422RowSse2(const uchar *src, uchar *dst, int width, YuvConverter::PackedOrder order, int from)
+{
+    const __m128i lowBytes = _mm_set1_epi16(0xff);
+    int x = from;
+    for (; x + 8 <= width; x += 8) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 2));
+        if (order == YuvConverter::YUYV) {
+            convert8Sse2(_mm_and_si128(pixels, lowBytes), _mm_srli_epi16(pixels, 8), dst + x * 4);
+        } else {
+            convert8Sse2(_mm_srli_epi16(pixels, 8), _mm_and_si128(pixels, lowBytes), dst + x * 4);
+        }
+    }
+    packed422RowScalar(src, dst, width, order, x);
+}
+
+void planar420RowSse2(const uchar *y, const uchar *u, const uchar *v, uchar *dst, int width, int from)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int x = from;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+        const __m128i chroma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2)),
+                                                 _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2)));
+        convert8Sse2(_mm_unpacklo_epi8(luma, zero), _mm_unpacklo_epi8(chroma, zero), dst + x * 4);
+        convert8Sse2(_mm_unpackhi_epi8(luma, zero), _mm_unpackhi_epi8(chroma, zero), dst + x * 4 + 32);
+    }
+    planar420RowScalar(y, u, v, dst, width, x);
+}
+#endif
+
+#ifdef YUVCONVERTER_AVX2
+/* Same as convert8Sse2 for 16 pixels. Each 128 bit lane holds 8 pixels and is
+   processed like in the SSE2 version, the lanes are reordered when storing. */
+AVX2_TARGET inline void convert16Avx2(__m256i y, __m256i c, uchar *dst)
+{
+    const __m256i luma = _mm256_sub_epi16(y, _mm256_set1_epi16(16));
+    const __m256i chroma = _mm256_sub_epi16(c, _mm256_set1_epi16(128));
+    const __m256i yCoef = _mm256_set1_epi32(coefficientPair(298, 1));
+    const __m256i rounding = _mm256_set1_epi16(128);
+    const __m256i yLow = _mm256_madd_epi16(_mm256_unpacklo_epi16(luma, rounding), yCoef);
+    const __m256i yHigh = _mm256_madd_epi16(_mm256_unpackhi_epi16(luma, rounding), yCoef);
+    const __m256i rChroma = _mm256_madd_epi16(chroma, _mm256_set1_epi32(coefficientPair(0, 409)));
+    const __m256i gChroma = _mm256_madd_epi16(chroma, _mm256_set1_epi32(coefficientPair(-100, -208)));
+    const __m256i bChroma = _mm256_madd_epi16(chroma, _mm256_set1_epi32(coefficientPair(516, 0)));
+    const __m256i r = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLow, _mm256_unpacklo_epi32(rChroma, rChroma)), 8),
+                                         _mm256_srai_epi32(_mm256_add_epi32(yHigh, _mm256_unpackhi_epi32(rChroma, rChroma)), 8));
+    const __m256i g = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLow, _mm256_unpacklo_epi32(gChroma, gChroma)), 8),
+                                         _mm256_srai_epi32(_mm256_add_epi32(yHigh, _mm256_unpackhi_epi32(gChroma, gChroma)), 8));
+    const __m256i b = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLow, _mm256_unpacklo_epi32(bChroma, bChroma)), 8),
+                                         _mm256_srai_epi32(_mm256_add_epi32(yHigh, _mm256_unpackhi_epi32(bChroma, bChroma)), 8));
+    const __m256i bg = _mm256_packus_epi16(b, g);
+    const __m256i ra = _mm256_packus_epi16(r, _mm256_set1_epi16(255));
+    const __m256i bgPairs = _mm256_unpacklo_epi8(bg, _mm256_srli_si256(bg, 8));
+    const __m256i raPairs = _mm256_unpacklo_epi8(ra, _mm256_srli_si256(ra, 8));
+    // Pixels 0-3 and 8-11, then 4-7 and 12-15
+    const __m256i low = _mm256_unpacklo_epi16(bgPairs, raPairs);
+    const __m256i high = _mm256_unpackhi_epi16(bgPairs, raPairs);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_permute2x128_si256(low, high, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 32), _mm256_permute2x128_si256(low, high, 0x31));
+}
+
+AVX2_TARGET void packed422RowAvx2(const uchar *src, uchar *dst, int width, YuvConverter::PackedOrder order, int from)
+{
+    const __m256i lowBytes = _mm256_set1_epi16(0xff);
+    int x = from;
+    for (; x + 16 <= width; x += 16) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2));
+        if (order == YuvConverter::YUYV) {
+            convert16Avx2(_mm256_and_si256(pixels, lowBytes), _mm256_srli_epi16(pixels, 8), dst + x * 4);
+        } else {
+            convert16Avx2(_mm256_srli_epi16(pixels, 8), _mm256_and_si256(pixels, lowBytes), dst + x * 4);
+        }
+    }
+    packed422RowSse2(src, dst, width, order, x);
+}
+
+AVX2_TARGET void planar420RowAvx2(const uchar *y, const uchar *u, const uchar *v, uchar *dst, int width, int from)
+{
+    int x = from;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+        const __m128i chroma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2)),
+                                                 _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2)));
+        convert16Avx2(_mm256_cvtepu8_epi16(luma), _mm256_cvtepu8_epi16(chroma), dst + x * 4);
+    }
+    planar420RowScalar(y, u, v, dst, width, x);
+}
+#endif
+}
+
+YuvConverter::Kernel YuvConverter::bestKernel()
+{
+    static const Kernel best = isSupported(Avx2) ? Avx2 : (isSupported(Sse2) ? Sse2 : Scalar);
+    return best;
+}
+
+bool YuvConverter::isSupported(Kernel kernel)
+{
+    switch (kernel) {
+    case Sse2:
+#ifdef YUVCONVERTER_SSE2
+        return true;
+#else
+        return false;
+#endif
+    case Avx2:
+#ifdef YUVCONVERTER_AVX2
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    default:
+        return true;
+    }
+}
+
+const char *YuvConverter::kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Sse2:
+        return "SSE2";
+    case Avx2:
+        return "AVX2";
+    default:
+        return "scalar";
+    }
+}
+
+void YuvConverter::packed422ToRgb32(const uchar *src, int srcStride, uchar *dst, int dstStride,
+                                    int width, int height, PackedOrder order, Kernel kernel)
+{
+    Packed422Row convertRow = packed422RowScalar;
+#ifdef YUVCONVERTER_SSE2
+    if (kernel == Sse2) {
+        convertRow = packed422RowSse2;
+    }
+#endif
+#ifdef YUVCONVERTER_AVX2
+    if (kernel == Avx2 && bestKernel() == Avx2) {
+        convertRow = packed422RowAvx2;
+    }
+#endif
+    for (int line = 0; line < height; ++line) {
+        convertRow(src + (qptrdiff) line * srcStride, dst + (qptrdiff) line * dstStride, width, order, 0);
+    }
+}
+
+void YuvConverter::planar420ToRgb32(const uchar *y, int yStride, const uchar *u, const uchar *v, int uvStride,
+                                    uchar *dst, int dstStride, int width, int height, Kernel kernel)
+{
+    Planar420Row convertRow = planar420RowScalar;
+#ifdef YUVCONVERTER_SSE2
+    if (kernel == Sse2) {
+        convertRow = planar420RowSse2;
+    }
+#endif
+#ifdef YUVCONVERTER_AVX2
+    if (kernel == Avx2 && bestKernel() == Avx2) {
+        convertRow = planar420RowAvx2;
+    }
+#endif
+    for (int line = 0; line < height; ++line) {
+        const qptrdiff chromaOffset = (qptrdiff)(line / 2) * uvStride;
+        convertRow(y + (qptrdiff) line * yStride, u + chromaOffset, v + chromaOffset, dst + (qptrdiff) line * dstStride, width, 0);
+    }
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef YUVCONVERTER_H
+#define YUVCONVERTER_H
+
+#include <QtGlobal>
+
+/**
+  Converts YUV images, as given by MLT and capture devices, to the 32 bit RGB layout
+  of QImage::Format_RGB32 (alpha set to 255).
+
+  BT.601 coefficients with video range (Y 16-235), the same as the conversion that was
+  done in the capture code. Chroma is not interpolated: both pixels of a pair use the same
+  U and V. The vectorized kernels give exactly the same result as the scalar one.
+  The fastest kernel supported by the CPU is picked at runtime.
+  */
+class YuvConverter
+{
+public:
+    enum Kernel {
+        Scalar = 0,
+        Sse2,
+        Avx2
+    };
+
+    /** Byte order of packed 4:2:2 images. MLT's mlt_image_yuv422 is YUYV. */
+    enum PackedOrder {
+        YUYV = 0,
+        UYVY
+    };
+
+    /** @brief The fastest kernel supported by this CPU, detected on first use. */
+    static Kernel bestKernel();
+    /** @brief True if the kernel was built in and can run on this CPU. */
+    static bool isSupported(Kernel kernel);
+    static const char *kernelName(Kernel kernel);
+
+    /** @brief Converts a packed 4:2:2 image.
+     *  @param srcStride bytes per line in @p src, usually width * 2
+     *  @param dstStride bytes per line in @p dst, usually width * 4 */
+    static void packed422ToRgb32(const uchar *src, int srcStride, uchar *dst, int dstStride,
+                                 int width, int height, PackedOrder order, Kernel kernel = bestKernel());
+
+    /** @brief Converts a planar 4:2:0 image (I420, like mlt_image_yuv420p).
+     *  Chroma planes have half the width and height of the luma plane, rounded up. */
+    static void planar420ToRgb32(const uchar *y, int yStride, const uchar *u, const uchar *v, int uvStride,
+                                 uchar *dst, int dstStride, int width, int height, Kernel kernel = bestKernel());
+};
+
+#endif
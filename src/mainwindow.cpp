@@ -24,6 +24,7 @@
 #include "bin/generators/generators.h"
 #include "library/librarywidget.h"
 #include "monitor/scopes/audiographspectrum.h"
+#include "monitor/scopes/loudnesspanel.h"
 #include "mltcontroller/clipcontroller.h"
 #include "kdenlivesettings.h"
 #include "dialogs/kdenlivesettingsdialog.h"
@@ -59,6 +60,7 @@
 #include "hidetitlebars.h"
 #include "mltconnection.h"
 #include "project/projectmanager.h"
+#include "project/jobs/jobscheduler.h"
 #include "timeline/timelinesearch.h"
 #include <config-kdenlive.h>
 #include "utils/thememanager.h"
@@ -315,9 +317,12 @@ void MainWindow::init(const QString &MltPath, const QUrl &Url, const QString &cl
     m_audioSpectrum = new AudioGraphSpectrum(pCore->monitorManager());
     QDockWidget *spectrumDock = addDock(i18n("Audio Spectrum"), QStringLiteral("audiospectrum"), m_audioSpectrum);
     connect(this, &MainWindow::reloadTheme, m_audioSpectrum, &AudioGraphSpectrum::refreshPixmap);
-    // Close library and audiospectrum on first run
+    // Loudness measurements from the monitor audio meter
+    QDockWidget *loudnessDock = addDock(i18n("Loudness"), QStringLiteral("loudness"), new LoudnessPanel(pCore->monitorManager()));
+    // Close library, audiospectrum and loudness on first run
     libraryDock->close();
     spectrumDock->close();
+    loudnessDock->close();
 
     m_projectBinDock = addDock(i18n("Project Bin"), QStringLiteral("project_bin"), pCore->bin());
     m_effectStack = new EffectStackView2(m_projectMonitor, this);
@@ -544,6 +549,7 @@ void MainWindow::init(const QString &MltPath, const QUrl &Url, const QString &cl
     m_timelineContextClipMenu->addAction(actionCollection()->action(QStringLiteral("cut_timeline_clip")));
     m_timelineContextClipMenu->addAction(actionCollection()->action(KStandardAction::name(KStandardAction::Copy)));
     m_timelineContextClipMenu->addAction(actionCollection()->action(QStringLiteral("paste_effects")));
+    m_timelineContextClipMenu->addAction(actionCollection()->action(QStringLiteral("freeze_timeline_clip")));
     m_timelineContextClipMenu->addSeparator();
 
     QMenu *markersMenu = static_cast<QMenu *>(factory()->container(QStringLiteral("marker_menu"), this));
@@ -581,6 +587,12 @@ void MainWindow::init(const QString &MltPath, const QUrl &Url, const QString &cl
     autoRender->setChecked(KdenliveSettings::autopreview());
     connect(autoRender, &QAction::triggered, this, &MainWindow::slotToggleAutoPreview);
     tlMenu->addAction(autoRender);
+    QAction *ramPreview = new QAction(i18n("Preview in Memory"), this);
+    ramPreview->setToolTip(i18n("Keep the timeline preview in memory, for short zones played many times"));
+    ramPreview->setCheckable(true);
+    ramPreview->setChecked(KdenliveSettings::rampreview());
+    connect(ramPreview, &QAction::triggered, this, &MainWindow::slotToggleRamPreview);
+    tlMenu->addAction(ramPreview);
     tlMenu->addSeparator();
     tlMenu->addAction(actionCollection()->action(QStringLiteral("disable_preview")));
     tlMenu->addAction(actionCollection()->action(QStringLiteral("manage_cache")));
@@ -1264,6 +1276,16 @@ void MainWindow::setupActions()
 
     addAction(QStringLiteral("stop_project_render"), i18n("Stop Render"), this, SLOT(slotStopRenderProject()), KoIconUtils::themedIcon(QStringLiteral("media-record")));
 
+    // Pausing the queue lets running jobs finish but does not start new renders or clip jobs
+    QAction *pauseJobs = new QAction(KoIconUtils::themedIcon(QStringLiteral("media-playback-pause")), i18n("Pause Job Queue"), this);
+    pauseJobs->setCheckable(true);
+    addAction(QStringLiteral("pause_job_queue"), pauseJobs);
+    connect(pauseJobs, &QAction::toggled, pCore->jobScheduler(), &JobScheduler::setPaused);
+    connect(pCore->jobScheduler(), &JobScheduler::pausedChanged, pauseJobs, &QAction::setChecked);
+    connect(pCore->jobScheduler(), &JobScheduler::slotsAvailable, pauseJobs, [pauseJobs]() {
+        pauseJobs->setToolTip(pCore->jobScheduler()->metrics());
+    }, Qt::QueuedConnection);
+
     addAction(QStringLiteral("project_clean"), i18n("Clean Project"), this, SLOT(slotCleanProject()), KoIconUtils::themedIcon(QStringLiteral("edit-clear")));
     //TODO
     //addAction("project_adjust_profile", i18n("Adjust Profile to Current Clip"), pCore->bin(), SLOT(adjustProjectProfileToItem()));
@@ -1281,6 +1303,7 @@ void MainWindow::setupActions()
     addAction(QStringLiteral("archive_project"), i18n("Archive Project"), this, SLOT(slotArchiveProject()), KoIconUtils::themedIcon(QStringLiteral("document-save-all")));
     addAction(QStringLiteral("switch_monitor"), i18n("Switch monitor"), this, SLOT(slotSwitchMonitors()), QIcon(), Qt::Key_T);
     addAction(QStringLiteral("expand_timeline_clip"), i18n("Expand Clip"), pCore->projectManager(), SLOT(slotExpandClip()), KoIconUtils::themedIcon(QStringLiteral("document-open")));
+    addAction(QStringLiteral("freeze_timeline_clip"), i18n("Freeze Clip Effects"), pCore->projectManager(), SLOT(slotFreezeClip()), KoIconUtils::themedIcon(QStringLiteral("run-build")));
 
     QAction *overlayInfo =  new QAction(KoIconUtils::themedIcon(QStringLiteral("help-hint")), i18n("Monitor Info Overlay"), this);
     addAction(QStringLiteral("monitor_overlay"), overlayInfo);
@@ -1738,6 +1761,10 @@ void MainWindow::slotEditProjectSettings()
             modified = true;
             project->setDocumentProperty(QStringLiteral("proxyimageminsize"), QString::number(w->proxyImageMinSize()));
         }
+        if (project->getDocumentProperty(QStringLiteral("generateslowproxy")) != QString::number((int) w->generateSlowProxy())) {
+            modified = true;
+            project->setDocumentProperty(QStringLiteral("generateslowproxy"), QString::number((int) w->generateSlowProxy()));
+        }
         if (QString::number((int) w->useProxy()) != project->getDocumentProperty(QStringLiteral("enableproxy"))) {
             project->setDocumentProperty(QStringLiteral("enableproxy"), QString::number((int) w->useProxy()));
             modified = true;
@@ -3253,6 +3280,14 @@ void MainWindow::buildDynamicActions()
     action->setData(stabJob);
     ts->addAction(action->text(), action);
     connect(action, &QAction::triggered, pCore->bin(), &Bin::slotStartClipJob);
+    action = new QAction(i18n("Analyse loudness"), m_extraFactory->actionCollection());
+    action->setData(QStringList() << QString::number((int) AbstractClipJob::LOUDNESSJOB));
+    ts->addAction(action->text(), action);
+    connect(action, &QAction::triggered, pCore->bin(), &Bin::slotStartClipJob);
+    action = new QAction(i18n("Normalize loudness (-23 LUFS)"), m_extraFactory->actionCollection());
+    action->setData(QStringList() << QString::number((int) AbstractClipJob::LOUDNESSJOB) << QStringLiteral("-23"));
+    ts->addAction(action->text(), action);
+    connect(action, &QAction::triggered, pCore->bin(), &Bin::slotStartClipJob);
     kdenliveCategoryMap.insert(QStringLiteral("clipjobs"), ts);
 
     if (kdenliveCategoryMap.contains(QStringLiteral("transcoderslist"))) {
@@ -3761,7 +3796,10 @@ void MainWindow::slotArchiveProject()
     QList<ClipController *> list = pCore->binController()->getControllerList();
     KdenliveDoc *doc = pCore->projectManager()->current();
     pCore->binController()->saveDocumentProperties(pCore->projectManager()->currentTimeline()->documentProperties(), doc->metadata(), pCore->projectManager()->currentTimeline()->projectView()->guidesData());
+    Timeline *timeline = pCore->projectManager()->currentTimeline();
+    timeline->connectOverlayTrack(false);
     QDomDocument xmlDoc = doc->xmlSceneList(m_projectMonitor->sceneList(doc->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile()));
+    timeline->connectOverlayTrack(true);
     QPointer<ArchiveWidget> d = new ArchiveWidget(doc->url().fileName(), xmlDoc, list, pCore->projectManager()->currentTimeline()->projectView()->extractTransitionsLumas(), this);
     if (d->exec()) {
         m_messageLabel->setMessage(i18n("Archiving project"), OperationCompletedMessage);
@@ -3937,6 +3975,14 @@ void MainWindow::slotToggleAutoPreview(bool enable)
     }
 }
 
+void MainWindow::slotToggleRamPreview(bool enable)
+{
+    KdenliveSettings::setRampreview(enable);
+    if (pCore->projectManager()->currentTimeline()) {
+        pCore->projectManager()->currentTimeline()->setRamPreview(enable);
+    }
+}
+
 void MainWindow::configureToolbars()
 {
     // Since our timeline toolbar is a non-standard toolbar (as it is docked in a custom widget, not
@@ -456,6 +456,8 @@ private slots:
     void slotCheckTabPosition();
     /** @brief Toggle automatic timeline preview on/off */
     void slotToggleAutoPreview(bool enable);
+    /** @brief Store timeline preview in memory or in the project cache. */
+    void slotToggleRamPreview(bool enable);
     /** @brief Rebuild/reload timeline toolbar. */
     void rebuildTimlineToolBar();
     void showTimelineToolbarMenu(const QPoint &pos);
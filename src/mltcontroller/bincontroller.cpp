@@ -22,12 +22,21 @@
 #include "kdenlivesettings.h"
 #include "timeline/clip.h"
 
+#include <QtConcurrent>
+#include <QThread>
+
 static const char *kPlaylistTrackId = "main bin";
 
+static QImage readThumbnail(const QPair<QString, QString> &file)
+{
+    return QImage(file.second);
+}
+
 BinController::BinController(const QString &profileName) :
     QObject()
 {
     m_binPlaylist = nullptr;
+    connect(this, &BinController::missingThumbs, this, &BinController::slotCreateThumbs, Qt::QueuedConnection);
     //resetProfile(profileName.isEmpty() ? KdenliveSettings::current_profile() : profileName);
 }
 
@@ -44,6 +53,7 @@ Mlt::Profile *BinController::profile()
 
 void BinController::destroyBin()
 {
+    abortThumbnails();
     if (m_binPlaylist) {
         m_binPlaylist->clear();
         delete m_binPlaylist;
@@ -483,9 +493,14 @@ void BinController::updateTrackProducer(const QString &id)
     emit updateTimelineProducer(id);
 }
 
-void BinController::checkThumbnails(const QDir &thumbFolder)
+void BinController::checkThumbnails(const QDir &thumbFolder, const QStringList &priorityIds)
 {
-    // Parse all controllers and load thumbnails
+    abortThumbnails();
+    // Collect cached thumbnail files, visible clips first
+    const QSet<QString> priority = priorityIds.toSet();
+    QList<QPair<QString, QString> > files;
+    QList<QPair<QString, QString> > otherFiles;
+    QStringList missing;
     QMapIterator<QString, ClipController *> i(m_clipList);
     while (i.hasNext()) {
         i.next();
@@ -494,24 +509,78 @@ void BinController::checkThumbnails(const QDir &thumbFolder)
             //no thumbnails for audio clip
             continue;
         }
-        bool foundFile = false;
-        if (!ctrl->getClipHash().isEmpty()) {
-            QImage img(thumbFolder.absoluteFilePath(ctrl->getClipHash() + QStringLiteral(".png")));
-            if (!img.isNull()) {
-                emit loadThumb(ctrl->clipId(), img, true);
-                foundFile = true;
-            }
+        if (ctrl->getClipHash().isEmpty()) {
+            missing << ctrl->clipId();
+            continue;
+        }
+        QPair<QString, QString> file(ctrl->clipId(), thumbFolder.absoluteFilePath(ctrl->getClipHash() + QStringLiteral(".png")));
+        if (priority.contains(ctrl->clipId())) {
+            files << file;
+        } else {
+            otherFiles << file;
+        }
+    }
+    files << otherFiles;
+    if (!missing.isEmpty()) {
+        slotCreateThumbs(missing);
+    }
+    if (!files.isEmpty()) {
+        m_thumbsThread = QtConcurrent::run(this, &BinController::loadThumbnails, files);
+    }
+}
+
+void BinController::abortThumbnails()
+{
+    if (m_thumbsThread.isRunning()) {
+        m_abortThumbs.store(1);
+        m_thumbsThread.waitForFinished();
+    }
+    m_abortThumbs.store(0);
+}
+
+void BinController::loadThumbnails(const QList<QPair<QString, QString> > &files)
+{
+    // Send results in batches so that the bin view is not refreshed for each clip
+    const int batchSize = qMax(16, 4 * QThread::idealThreadCount());
+    for (int ix = 0; ix < files.count(); ix += batchSize) {
+        if (m_abortThumbs.load() != 0) {
+            return;
         }
-        if (!foundFile) {
-            // Add clip id to thumbnail generation thread
-            QDomDocument doc;
-            ctrl->getProducerXML(doc);
-            QDomElement xml = doc.documentElement().firstChildElement(QStringLiteral("producer"));
-            if (!xml.isNull()) {
-                xml.setAttribute(QStringLiteral("thumbnailOnly"), 1);
-                emit createThumb(xml, ctrl->clipId(), 150);
+        const QList<QPair<QString, QString> > batch = files.mid(ix, batchSize);
+        const QList<QImage> images = QtConcurrent::blockingMapped(batch, readThumbnail);
+        thumbMap thumbs;
+        QStringList missing;
+        for (int j = 0; j < batch.count(); ++j) {
+            if (images.at(j).isNull()) {
+                missing << batch.at(j).first;
+            } else {
+                thumbs.insert(batch.at(j).first, images.at(j));
             }
         }
+        if (!thumbs.isEmpty()) {
+            emit loadThumbs(thumbs);
+        }
+        if (!missing.isEmpty()) {
+            emit missingThumbs(missing);
+        }
+    }
+}
+
+void BinController::slotCreateThumbs(const QStringList &ids)
+{
+    for (const QString &id : ids) {
+        ClipController *ctrl = m_clipList.value(id);
+        if (!ctrl) {
+            continue;
+        }
+        // Add clip id to thumbnail generation thread
+        QDomDocument doc;
+        ctrl->getProducerXML(doc);
+        QDomElement xml = doc.documentElement().firstChildElement(QStringLiteral("producer"));
+        if (!xml.isNull()) {
+            xml.setAttribute(QStringLiteral("thumbnailOnly"), 1);
+            emit createThumb(xml, ctrl->clipId(), 150);
+        }
     }
 }
 
@@ -25,6 +25,9 @@
 #include <QString>
 #include <QStringList>
 #include <QDir>
+#include <QImage>
+#include <QFuture>
+#include <QAtomicInt>
 #include "definitions.h"
 
 class ClipController;
@@ -43,6 +46,8 @@ class Profile;
  * The project profile, used to build the monitors renderers is stored here
  */
 
+typedef QMap<QString, QImage> thumbMap;
+
 class BinController : public QObject
 {
     Q_OBJECT
@@ -140,8 +145,12 @@ public:
     /** @brief A Bin clip effect was changed, update track producers */
     void updateTrackProducer(const QString &id);
 
-    /** @brief Load thumbnails for all producers */
-    void checkThumbnails(const QDir &thumbFolder);
+    /** @brief Load thumbnails for all producers
+     *  Cached thumbnail files are decoded in parallel in a background thread and sent in batches.
+     *  @param priorityIds clips that should be processed first (for example visible in the Bin view) */
+    void checkThumbnails(const QDir &thumbFolder, const QStringList &priorityIds = QStringList());
+    /** @brief Abort a running thumbnail restore pass */
+    void abortThumbnails();
 
     /** @brief Request audio thumbnails for all producers */
     void checkAudioThumbs();
@@ -168,6 +177,8 @@ public:
     QStringList getProjectHashes();
 
 public slots:
+    /** @brief Request thumbnail creation for clips that have no cached thumbnail */
+    void slotCreateThumbs(const QStringList &ids);
     /** @brief Stored a Bin Folder id / name to MLT's bin playlist. Using an empry folderName deletes the property */
     void slotStoreFolder(const QString &folderId, const QString &parentId, const QString &oldParentId, const QString &folderName);
 
@@ -196,9 +207,20 @@ private:
     /** @brief Duplicate effects from stored producer */
     void pasteEffects(const QString &id, Mlt::Producer &producer);
 
+    /** @brief Background thumbnail restore pass */
+    QFuture<void> m_thumbsThread;
+    /** @brief Set to abort the background thumbnail restore pass */
+    QAtomicInt m_abortThumbs;
+    /** @brief Decode cached thumbnail files (clip id / file path pairs) in parallel, in batches */
+    void loadThumbnails(const QList<QPair<QString, QString> > &files);
+
 signals:
     void loadFolders(const QMap<QString, QString> &);
     void loadThumb(const QString &, const QImage&, bool);
+    /** @brief A batch of cached thumbnails was decoded */
+    void loadThumbs(const thumbMap &);
+    /** @brief Some clips have no cached thumbnail */
+    void missingThumbs(const QStringList &);
     void createThumb(const QDomElement &, const QString &, int);
     void requestAudioThumb(const QString &);
     void abortAudioThumbs();
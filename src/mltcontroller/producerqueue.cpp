@@ -30,9 +30,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "timeline/clip.h"
 
 #include <QtConcurrent>
+#include <QElapsedTimer>
+#include <QSysInfo>
+
+// Length of clip decoded to measure decoding speed, in seconds
+static const int DECODE_PROBE_LENGTH = 3;
+// Give up measuring after this delay (ms), the clip is slow anyways
+static const int DECODE_PROBE_TIMEOUT = 6000;
 
 ProducerQueue::ProducerQueue(BinController *controller) : QObject(controller)
     , m_binController(controller)
+    , m_probeDecodeSpeed(false)
 {
     connect(this, SIGNAL(multiStreamFound(QString, QList<int>, QList<int>, stringMap)), this, SLOT(slotMultiStreamProducerFound(QString, QList<int>, QList<int>, stringMap)));
     connect(this, &ProducerQueue::refreshTimelineProducer, m_binController, &BinController::replaceTimelineProducer);
@@ -74,6 +82,11 @@ void ProducerQueue::forceProcessing(const QString &id)
 {
     // Make sure we load the clip producer now so that we can use it in timeline
     QList<requestClipInfo> requestListCopy;
+    // Don't wait for decoding speed measures
+    m_infoMutex.lock();
+    const QList<QPair<QString, QString> > probeListCopy = m_probeList;
+    m_probeList.clear();
+    m_infoMutex.unlock();
     if (m_processingClipId.contains(id)) {
         m_infoMutex.lock();
         requestListCopy = m_requestList;
@@ -103,6 +116,7 @@ void ProducerQueue::forceProcessing(const QString &id)
 
     m_infoMutex.lock();
     m_requestList.append(requestListCopy);
+    m_probeList.append(probeListCopy);
     m_infoMutex.unlock();
     if (!m_infoThread.isRunning()) {
         m_infoThread = QtConcurrent::run(this, &ProducerQueue::processFileProperties);
@@ -135,8 +149,22 @@ void ProducerQueue::processFileProperties()
     QLocale locale;
     locale.setNumberOptions(QLocale::OmitGroupSeparator);
     bool forceThumbScale = m_binController->profile()->sar() != 1;
-    while (!m_requestList.isEmpty()) {
+    while (!m_requestList.isEmpty() || !m_probeList.isEmpty()) {
         m_infoMutex.lock();
+        if (m_requestList.isEmpty()) {
+            // All clips are loaded, measure the decoding speed of new video clips
+            if (m_probeList.isEmpty()) {
+                m_infoMutex.unlock();
+                break;
+            }
+            QPair<QString, QString> probe = m_probeList.takeFirst();
+            m_infoMutex.unlock();
+            double fps = measureDecodeSpeed(probe.second);
+            if (fps > 0) {
+                emit gotDecodeSpeed(probe.first, fps);
+            }
+            continue;
+        }
         info = m_requestList.takeFirst();
         if (info.xml.hasAttribute(QStringLiteral("thumbnailOnly")) || info.xml.hasAttribute(QStringLiteral("refreshOnly"))) {
             m_infoMutex.unlock();
@@ -840,14 +868,90 @@ void ProducerQueue::processFileProperties()
             m_binController->addClipToBin(info.clipId, controller);
             emit gotFileProperties(info, controller);
         }
+        if ((type == AV || type == Video) && ProjectClip::getXmlProperty(info.xml, QStringLiteral("kdenlive:decodehost")) != QSysInfo::machineHostName()) {
+            // Speed was never measured on this machine, measure the original file and not its proxy
+            QString source = ProjectClip::getXmlProperty(info.xml, QStringLiteral("kdenlive:originalurl"));
+            if (source.isEmpty() && !proxyProducer) {
+                source = ProjectClip::getXmlProperty(info.xml, QStringLiteral("resource"));
+            }
+            if (!source.isEmpty() && QFileInfo(source).isRelative()) {
+                source.prepend(m_binController->documentRoot());
+            }
+            m_infoMutex.lock();
+            if (m_probeDecodeSpeed && !source.isEmpty()) {
+                m_probeList.append(QPair<QString, QString>(info.clipId, source));
+            }
+            m_infoMutex.unlock();
+        }
         m_processingClipId.removeAll(info.clipId);
     }
 }
 
+double ProducerQueue::measureDecodeSpeed(const QString &path)
+{
+    Mlt::Producer producer(*m_binController->profile(), nullptr, path.toUtf8().constData());
+    if (!producer.is_valid() || producer.get_int("video_index") < 0) {
+        return -1;
+    }
+    const int frames = qMin(producer.get_playtime() - 1, (int)(DECODE_PROBE_LENGTH * m_binController->profile()->fps()));
+    if (frames < 2) {
+        return -1;
+    }
+    // Start in the middle of the clip, the first frames are often easier to decode
+    const int start = (producer.get_playtime() - frames) / 2;
+    QElapsedTimer timer;
+    int decoded = 0;
+    for (int i = 0; i < frames; ++i) {
+        producer.seek(start + i);
+        Mlt::Frame *frame = producer.get_frame();
+        if (frame == nullptr || !frame->is_valid()) {
+            delete frame;
+            break;
+        }
+        mlt_image_format format = mlt_image_yuv422;
+        int width = m_binController->profile()->width();
+        int height = m_binController->profile()->height();
+        frame->get_image(format, width, height);
+        delete frame;
+        if (i == 0) {
+            // Don't count the initial seek
+            timer.start();
+            continue;
+        }
+        decoded++;
+        if (timer.elapsed() > DECODE_PROBE_TIMEOUT) {
+            break;
+        }
+        m_infoMutex.lock();
+        const bool newRequests = !m_requestList.isEmpty();
+        m_infoMutex.unlock();
+        if (newRequests && decoded > 10) {
+            // New clips to load, this measure is good enough
+            break;
+        }
+    }
+    if (decoded == 0 || !timer.isValid()) {
+        return -1;
+    }
+    double fps = decoded * 1000.0 / qMax((qint64) 1, timer.elapsed());
+    qCDebug(KDENLIVE_LOG) << "Decoding speed for" << path << ":" << fps << "fps";
+    return fps;
+}
+
+void ProducerQueue::setProbeDecodeSpeed(bool probe)
+{
+    QMutexLocker lock(&m_infoMutex);
+    m_probeDecodeSpeed = probe;
+    if (!probe) {
+        m_probeList.clear();
+    }
+}
+
 void ProducerQueue::abortOperations()
 {
     m_infoMutex.lock();
     m_requestList.clear();
+    m_probeList.clear();
     m_infoMutex.unlock();
     m_infoThread.waitForFinished();
 }
@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QMutex>
 #include <QFuture>
+#include <QPair>
 
 class ClipController;
 class BinController;
@@ -56,17 +57,25 @@ public:
     bool isProcessing(const QString &id);
     /** @brief Make sure to close running threads before closing document */
     void abortOperations();
+    /** @brief Enable decoding speed measures for new video clips, follows the project's slow clips proxy setting */
+    void setProbeDecodeSpeed(bool probe);
 
 private:
     QMutex m_infoMutex;
     QList<requestClipInfo> m_requestList;
+    /** @brief Clips (id, path) waiting for a decoding speed measure, done once all requests are processed */
+    QList<QPair<QString, QString> > m_probeList;
     /** @brief The ids of the clips that are currently being loaded for info query */
     QStringList m_processingClipId;
     QFuture <void> m_infoThread;
     BinController *m_binController;
+    /** @brief Whether new video clips are added to m_probeList */
+    bool m_probeDecodeSpeed;
     ClipType getTypeForService(const QString &id, const QString &path) const;
     /** @brief Pass xml values to an MLT producer at build time */
     void processProducerProperties(Mlt::Producer *prod, const QDomElement &xml);
+    /** @brief Decode a few seconds of a clip and return the number of frames decoded per second, -1 on error */
+    double measureDecodeSpeed(const QString &path);
 
 public slots:
     /** @brief Requests the file properties for the specified URL (will be put in a queue list)
@@ -91,6 +100,8 @@ signals:
 
     /** @brief The renderer received a reply to a getImage request. */
     void replyGetImage(const QString &, const QImage &, bool fromFile = false);
+    /** @brief Decoding speed of a clip on this machine was measured, in frames per second. */
+    void gotDecodeSpeed(const QString &id, double fps);
     /** @brief A proxy clip is missing, ask for creation. */
     void requestProxy(const QString &);
     void infoProcessingFinished();
@@ -31,6 +31,7 @@
 #include "qml/qmlaudiothumb.h"
 #include "kdenlivesettings.h"
 #include "mltcontroller/bincontroller.h"
+#include "lib/audio/audioSampleRing.h"
 
 #ifndef GL_UNPACK_ROW_LENGTH
 # ifdef GL_UNPACK_ROW_LENGTH_EXT
@@ -86,6 +87,8 @@ GLWidget::GLWidget(int id, QObject *parent)
     , m_offscreenSurface(nullptr)
     , m_shareContext(nullptr)
     , m_audioWaveDisplayed(false)
+    , m_audioRing(new AudioSampleRing())
+    , m_audioMetering(0)
     , m_fbo(nullptr)
 {
     m_texture[0] = m_texture[1] = m_texture[2] = 0;
@@ -137,6 +140,7 @@ GLWidget::~GLWidget()
     delete m_shareContext;
     delete m_shader;
     delete m_monitorProfile;
+    delete m_audioRing;
 }
 
 void GLWidget::updateAudioForAnalysis()
@@ -1243,12 +1247,41 @@ void GLWidget::updateTexture(GLuint yName, GLuint uName, GLuint vName)
     //update();
 }
 
+AudioSampleRing *GLWidget::audioRing()
+{
+    return m_audioRing;
+}
+
+void GLWidget::setAudioMetering(bool enable)
+{
+    m_audioMetering.storeRelease(enable ? 1 : 0);
+}
+
+void GLWidget::meterAudio(Mlt::Frame &frame)
+{
+    if (!m_audioMetering.loadAcquire() || frame.get_int("test_audio") != 0) {
+        return;
+    }
+    int samples = frame.get_int("audio_samples");
+    if (samples <= 0) {
+        return;
+    }
+    mlt_audio_format format = mlt_audio_s16;
+    int frequency = frame.get_int("audio_frequency");
+    int channels = frame.get_int("audio_channels");
+    const qint16 *data = (const qint16 *) frame.get_audio(format, frequency, channels, samples);
+    if (data && samples > 0) {
+        m_audioRing->write(data, samples, channels, frequency);
+    }
+}
+
 // MLT consumer-frame-show event handler
 void GLWidget::on_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr)
 {
     Mlt::Frame frame(frame_ptr);
     if (frame.get_int("rendered")) {
         GLWidget *widget = static_cast<GLWidget *>(self);
+        widget->meterAudio(frame);
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
         if (widget->m_frameRenderer && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
@@ -1261,6 +1294,7 @@ void GLWidget::on_gl_nosync_frame_show(mlt_consumer, void *self, mlt_frame frame
     Mlt::Frame frame(frame_ptr);
     if (frame.get_int("rendered")) {
         GLWidget *widget = static_cast<GLWidget *>(self);
+        widget->meterAudio(frame);
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
         if (widget->m_frameRenderer && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showGLNoSyncFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
@@ -1273,6 +1307,7 @@ void GLWidget::on_gl_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr)
     Mlt::Frame frame(frame_ptr);
     if (frame.get_int("rendered")) {
         GLWidget *widget = static_cast<GLWidget *>(self);
+        widget->meterAudio(frame);
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
         if (widget->m_frameRenderer && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showGLFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
@@ -29,6 +29,7 @@
 #include <QMutex>
 #include <QThread>
 #include <QRect>
+#include <QAtomicInt>
 
 #include "scopes/sharedframe.h"
 #include "definitions.h"
@@ -44,6 +45,7 @@ class Filter;
 
 class RenderThread;
 class FrameRenderer;
+class AudioSampleRing;
 
 typedef void *(*thread_function_t)(void *);
 
@@ -113,6 +115,10 @@ public:
     void setAudioThumb(int channels = 0, const QVariantList &audioCache = QList<QVariant>());
     int droppedFrames() const;
     void resetDrops();
+    /** @brief Ring buffer receiving the played audio when metering is enabled */
+    AudioSampleRing *audioRing();
+    /** @brief Enable copying the played audio to the audio ring from the consumer thread */
+    void setAudioMetering(bool enable);
 
 protected:
     void mouseReleaseEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
@@ -187,6 +193,10 @@ private:
     QOffscreenSurface *m_offscreenSurface;
     QOpenGLContext *m_shareContext;
     bool m_audioWaveDisplayed;
+    AudioSampleRing *m_audioRing;
+    QAtomicInt m_audioMetering;
+    /** @brief Copy the frame audio to the audio ring, called from the consumer thread */
+    void meterAudio(Mlt::Frame &frame);
     static void on_frame_show(mlt_consumer, void *self, mlt_frame frame);
     static void on_gl_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr);
     static void on_gl_nosync_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr);
@@ -24,6 +24,7 @@
 #include "smallruler.h"
 #include "mltcontroller/clipcontroller.h"
 #include "mltcontroller/bincontroller.h"
+#include "monitormanager.h"
 #include "scopes/monitoraudiolevel.h"
 #include "lib/audio/audioStreamInfo.h"
 #include "kdenlivesettings.h"
@@ -335,7 +336,9 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
     int tm = 0;
     int bm = 0;
     m_toolbar->getContentsMargins(nullptr, &tm, nullptr, &bm);
-    m_audioMeterWidget = new MonitorAudioLevel(m_glMonitor->profile(), m_toolbar->height() - tm - bm, this);
+    m_audioMeterWidget = new MonitorAudioLevel(m_toolbar->height() - tm - bm, this);
+    m_audioMeterWidget->setAudioRing(m_glMonitor->audioRing());
+    connect(m_audioMeterWidget, &MonitorAudioLevel::loudnessUpdated, m_monitorManager, &MonitorManager::loudnessUpdated);
     m_toolbar->addWidget(m_audioMeterWidget);
     if (!m_audioMeterWidget->isValid) {
         KdenliveSettings::setMonitoraudio(0x01);
@@ -2169,6 +2172,7 @@ void Monitor::slotSwitchAudioMonitor()
 void Monitor::displayAudioMonitor(bool isActive)
 {
     bool enable = isActive && (KdenliveSettings::monitoraudio() & m_id);
+    m_glMonitor->setAudioMetering(enable);
     if (enable) {
         connect(m_monitorManager, &MonitorManager::frameDisplayed, m_audioMeterWidget, &ScopeWidget::onNewFrame, Qt::UniqueConnection);
     } else {
@@ -2177,6 +2181,11 @@ void Monitor::displayAudioMonitor(bool isActive)
     m_audioMeterWidget->setVisibility((KdenliveSettings::monitoraudio() & m_id) != 0);
 }
 
+void Monitor::resetLoudness()
+{
+    m_audioMeterWidget->resetLoudness();
+}
+
 void Monitor::updateQmlDisplay(int currentOverlay)
 {
     m_glMonitor->rootObject()->setVisible(currentOverlay & 0x01);
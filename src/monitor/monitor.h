@@ -148,6 +148,8 @@ public:
     /** @brief Set a property on the Qml scene **/
     void setQmlProperty(const QString &name, const QVariant &value);
     void displayAudioMonitor(bool isActive);
+    /** @brief Restart the loudness measurements of the audio meter */
+    void resetLoudness();
     /** @brief Prepare split effect from timeline clip producer **/
     void activateSplit();
     /** @brief Clear monitor display **/
@@ -309,6 +309,16 @@ void MonitorManager::slotUpdateAudioMonitoring()
     }
 }
 
+void MonitorManager::resetLoudness()
+{
+    if (m_clipMonitor) {
+        m_clipMonitor->resetLoudness();
+    }
+    if (m_projectMonitor) {
+        m_projectMonitor->resetLoudness();
+    }
+}
+
 void MonitorManager::clearScopeSource()
 {
     emit clearScopes();
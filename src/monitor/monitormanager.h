@@ -22,6 +22,7 @@
 
 #include "monitor.h"
 #include "recmonitor.h"
+#include "lib/audio/loudnessMeter.h"
 
 #include "timecode.h"
 #include <QDir>
@@ -103,6 +104,8 @@ public slots:
      * @param activateClip whether to activate the clip monitor */
     void slotSwitchMonitors(bool activateClip);
     void slotUpdateAudioMonitoring();
+    /** @brief Restart the loudness measurements of both monitors */
+    void resetLoudness();
     /** @brief Export the current monitor's frame to image file. */
     void slotExtractCurrentFrame();
     /** @brief Export the current monitor's frame to image file and add it to the current project */
@@ -142,6 +145,8 @@ signals:
     void updateOverlayInfos(int, int);
     /** @brief info is available for audio spectum widget */
     void frameDisplayed(const SharedFrame &);
+    /** @brief New loudness measurements from the active monitor's audio meter */
+    void loudnessUpdated(const LoudnessInfo &info);
 };
 
 #endif
@@ -0,0 +1,79 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "loudnesspanel.h"
+#include "monitor/monitormanager.h"
+
+#include "klocalizedstring.h"
+
+#include <QFormLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+LoudnessPanel::LoudnessPanel(MonitorManager *manager, QWidget *parent) : QWidget(parent)
+    , m_manager(manager)
+{
+    QVBoxLayout *lay = new QVBoxLayout(this);
+    QFormLayout *form = new QFormLayout;
+    m_momentary = new QLabel(this);
+    m_shortTerm = new QLabel(this);
+    m_integrated = new QLabel(this);
+    m_range = new QLabel(this);
+    m_truePeak = new QLabel(this);
+    form->addRow(i18n("Momentary:"), m_momentary);
+    form->addRow(i18n("Short term:"), m_shortTerm);
+    form->addRow(i18n("Integrated:"), m_integrated);
+    form->addRow(i18n("Loudness range:"), m_range);
+    form->addRow(i18n("True peak:"), m_truePeak);
+    lay->addLayout(form);
+    QPushButton *reset = new QPushButton(i18n("Reset"), this);
+    reset->setToolTip(i18n("Restart the integrated loudness, loudness range and true peak measurements"));
+    connect(reset, &QPushButton::clicked, this, &LoudnessPanel::slotReset);
+    lay->addWidget(reset);
+    lay->addStretch(10);
+    setToolTip(i18n("Enable the audio level meter of a monitor to measure its loudness"));
+    updateLoudness(LoudnessInfo());
+    connect(m_manager, &MonitorManager::loudnessUpdated, this, &LoudnessPanel::updateLoudness);
+}
+
+QString LoudnessPanel::formatLevel(double value, double floor, const QString &unit)
+{
+    if (value < floor) {
+        return QStringLiteral("-∞ %1").arg(unit);
+    }
+    return QStringLiteral("%1 %2").arg(value, 0, 'f', 1).arg(unit);
+}
+
+void LoudnessPanel::updateLoudness(const LoudnessInfo &info)
+{
+    m_momentary->setText(formatLevel(info.momentary, LoudnessMeter::AbsoluteGate, i18n("LUFS")));
+    m_shortTerm->setText(formatLevel(info.shortTerm, LoudnessMeter::AbsoluteGate, i18n("LUFS")));
+    m_integrated->setText(formatLevel(info.integrated, LoudnessMeter::AbsoluteGate, i18n("LUFS")));
+    m_range->setText(QStringLiteral("%1 %2").arg(info.range, 0, 'f', 1).arg(i18n("LU")));
+    m_truePeak->setText(formatLevel(info.truePeak, LoudnessMeter::TruePeakFloor, i18n("dBTP")));
+}
+
+void LoudnessPanel::slotReset()
+{
+    m_manager->resetLoudness();
+    updateLoudness(LoudnessInfo());
+}
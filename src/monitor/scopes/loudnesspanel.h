@@ -0,0 +1,60 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/*!
+* @class LoudnessPanel
+* @brief Displays the EBU R128 measurements of the active monitor's audio meter
+*/
+
+#ifndef LOUDNESSPANEL_H
+#define LOUDNESSPANEL_H
+
+#include "lib/audio/loudnessMeter.h"
+
+#include <QWidget>
+
+class MonitorManager;
+class QLabel;
+
+class LoudnessPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit LoudnessPanel(MonitorManager *manager, QWidget *parent = nullptr);
+
+public slots:
+    void updateLoudness(const LoudnessInfo &info);
+
+private:
+    MonitorManager *m_manager;
+    QLabel *m_momentary;
+    QLabel *m_shortTerm;
+    QLabel *m_integrated;
+    QLabel *m_range;
+    QLabel *m_truePeak;
+    /** @brief Level with one decimal, or -∞ below floor */
+    static QString formatLevel(double value, double floor, const QString &unit);
+
+private slots:
+    void slotReset();
+};
+
+#endif
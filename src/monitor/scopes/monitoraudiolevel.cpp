@@ -20,9 +20,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "monitoraudiolevel.h"
+#include "lib/audio/audioSampleRing.h"
 
-#include "mlt++/Mlt.h"
-
+#include <algorithm>
 #include <math.h>
 
 #include <QPainter>
@@ -39,58 +39,75 @@ static inline double levelToDB(double dB)
     return 100 * (1.0 - log10(dB) * log_factor);
 }
 
-MonitorAudioLevel::MonitorAudioLevel(Mlt::Profile *profile, int height, QWidget *parent) : ScopeWidget(parent)
+MonitorAudioLevel::MonitorAudioLevel(int height, QWidget *parent) : ScopeWidget(parent)
     , audioChannels(2)
+    , isValid(true)
+    , m_ring(nullptr)
+    , m_samples(16384)
+    , m_resetRequested(0)
     , m_height(height)
     , m_channelHeight(height / 2)
     , m_channelDistance(2)
     , m_channelFillHeight(m_channelHeight)
 {
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Preferred);
-    m_filter = new Mlt::Filter(*profile, "audiolevel");
-    if (!m_filter->is_valid()) {
-        isValid = false;
-        return;
-    }
-    m_filter->set("iec_scale", 0);
-    isValid = true;
 }
 
 MonitorAudioLevel::~MonitorAudioLevel()
 {
-    delete m_filter;
+}
+
+void MonitorAudioLevel::setAudioRing(AudioSampleRing *ring)
+{
+    m_ring = ring;
+}
+
+void MonitorAudioLevel::resetLoudness()
+{
+    m_resetRequested.storeRelease(1);
+    requestRefresh();
 }
 
 void MonitorAudioLevel::refreshScope(const QSize & /*size*/, bool /*full*/)
 {
-    SharedFrame sFrame;
-    while (m_queue.count() > 0) {
-        sFrame = m_queue.pop();
-        if (sFrame.is_valid() && sFrame.get_audio_samples() > 0) {
-            mlt_audio_format format = mlt_audio_s16;
-            int channels = sFrame.get_audio_channels();
-            int frequency = sFrame.get_audio_frequency();
-            int samples = sFrame.get_audio_samples();
-            Mlt::Frame mFrame = sFrame.clone(true, false, false);
-            m_filter->process(mFrame);
-            mFrame.get_audio(format, frequency, channels, samples);
-            if (samples == 0) {
-                // There was an error processing audio from frame
-                continue;
-            }
-            QVector<int> levels;
-            for (int i = 0; i < audioChannels; i++) {
-                QString s = QStringLiteral("meta.media.audio_level.%1").arg(i);
-                double audioLevel = mFrame.get_double(s.toLatin1().constData());
-                if (audioLevel == 0.0) {
-                    levels << -100;
-                } else {
-                    levels << (int) levelToDB(audioLevel);
-                }
-            }
-            QMetaObject::invokeMethod(this, "setAudioValues", Qt::QueuedConnection, Q_ARG(const QVector<int> &, levels));
-        }
+    // Displayed frames only trigger the refresh, audio comes from the ring
+    SharedFrame frame;
+    while (m_queue.tryPop(frame)) {
+    }
+    if (!m_ring) {
+        return;
+    }
+    if (m_ring->checkFormat() && m_ring->channels() > 0) {
+        m_meter.configure(m_ring->channels(), m_ring->frequency());
+    }
+    if (m_resetRequested.testAndSetAcquire(1, 0)) {
+        m_meter.reset();
+    }
+    if (m_meter.channels() == 0) {
+        return;
+    }
+    const int maxFrames = m_samples.size() / m_meter.channels();
+    bool processed = false;
+    int frames;
+    while ((frames = m_ring->read(m_samples.data(), maxFrames)) > 0) {
+        m_meter.process(m_samples.constData(), frames);
+        processed = true;
+    }
+    if (!processed) {
+        return;
+    }
+    const QVector<double> &peaks = m_meter.recentPeaks();
+    m_levelsMutex.lock();
+    // Only reallocated when the channel count changes
+    m_levels.resize(audioChannels);
+    for (int i = 0; i < audioChannels; i++) {
+        double audioLevel = i < peaks.size() ? peaks.at(i) : 0.0;
+        m_levels[i] = audioLevel == 0.0 ? -100 : (int) levelToDB(audioLevel);
     }
+    m_levelsMutex.unlock();
+    m_meter.clearRecentPeaks();
+    QMetaObject::invokeMethod(this, "setAudioValues", Qt::QueuedConnection);
+    emit loudnessUpdated(m_meter.info());
 }
 
 void MonitorAudioLevel::resizeEvent(QResizeEvent *event)
@@ -194,12 +211,17 @@ void MonitorAudioLevel::drawBackground(int channels)
 }
 
 // cppcheck-suppress unusedFunction
-void MonitorAudioLevel::setAudioValues(const QVector<int> &values)
+void MonitorAudioLevel::setAudioValues()
 {
-    m_values = values;
+    m_levelsMutex.lock();
+    // Copy the values, sharing the data would make the refresh thread detach it
+    m_values.resize(m_levels.size());
+    std::copy(m_levels.constBegin(), m_levels.constEnd(), m_values.begin());
+    m_levelsMutex.unlock();
     if (m_peaks.size() != m_values.size()) {
-        m_peaks = values;
-        drawBackground(values.size());
+        m_peaks.resize(m_values.size());
+        std::copy(m_values.constBegin(), m_values.constEnd(), m_peaks.begin());
+        drawBackground(m_values.size());
     } else {
         for (int i = 0; i < m_values.size(); i++) {
             m_peaks[i] --;
@@ -23,31 +23,41 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MONITORAUDIOLEVEL_H
 
 #include "scopewidget.h"
+#include "lib/audio/loudnessMeter.h"
 #include <QWidget>
+#include <QAtomicInt>
+#include <QMutex>
 
-namespace Mlt
-{
-class Profile;
-class Filter;
-}
+class AudioSampleRing;
 
 class MonitorAudioLevel : public ScopeWidget
 {
     Q_OBJECT
 public:
-    explicit MonitorAudioLevel(Mlt::Profile *profile, int height, QWidget *parent = nullptr);
+    explicit MonitorAudioLevel(int height, QWidget *parent = nullptr);
     virtual ~MonitorAudioLevel();
     void refreshPixmap();
     int audioChannels;
     bool isValid;
     void setVisibility(bool enable);
+    /** @brief Set the ring buffer filled by the monitor consumer, it is drained on each refresh */
+    void setAudioRing(AudioSampleRing *ring);
+    /** @brief Restart the integrated loudness, loudness range and true peak measurements */
+    void resetLoudness();
 
 protected:
     void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE;
     void resizeEvent(QResizeEvent *event) Q_DECL_OVERRIDE;
 
 private:
-    Mlt::Filter *m_filter;
+    AudioSampleRing *m_ring;
+    /** @brief Only used from the refresh thread */
+    LoudnessMeter m_meter;
+    QVector<qint16> m_samples;
+    /** @brief Levels computed by the refresh thread, reused for every refresh */
+    QVector<int> m_levels;
+    QMutex m_levelsMutex;
+    QAtomicInt m_resetRequested;
     int m_height;
     QPixmap m_pixmap;
     QVector <int> m_peaks;
@@ -59,7 +69,12 @@ private:
     void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
 
 private slots:
-    void setAudioValues(const QVector <int> &values);
+    /** @brief Copy the last levels computed by the refresh thread and repaint */
+    void setAudioValues();
+
+signals:
+    /** @brief New loudness measurements are available, emitted from the refresh thread */
+    void loudnessUpdated(const LoudnessInfo &info);
 };
 
 #endif
@@ -0,0 +1,225 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef RINGQUEUE_H
+#define RINGQUEUE_H
+
+#include <QAtomicInteger>
+#include <QThread>
+
+/*!
+  \class RingQueue
+  \brief The RingQueue is a lock free version of DataQueue for one producer
+  and one consumer thread.
+
+  \threadsafe
+
+  RingQueue stores up to maxSize items in a fixed ring of slots, so pushing
+  and popping never lock a mutex, wake a thread or allocate memory. It has the
+  same overflow modes as DataQueue. To discard the oldest item, the producer
+  takes it out of the queue like a consumer would, so every slot carries a
+  sequence number telling whether it holds an item that can be read or room
+  for a new one.
+
+  Only one thread may push and only one other thread may pop. The blocking
+  calls (pop() on an empty queue, push() on a full queue in OverflowModeWait)
+  poll the queue, then sleep, they are meant for rare cases: prefer tryPop().
+*/
+
+template <class T>
+class RingQueue
+{
+public:
+    //! Overflow behavior modes, as in DataQueue.
+    typedef enum {
+        OverflowModeDiscardOldest = 0, //!< Discard oldest items
+        OverflowModeDiscardNewest,     //!< Discard newest items
+        OverflowModeWait               //!< Wait for space to be free
+    } OverflowMode;
+
+    /*!
+      Constructs a RingQueue.
+
+      The \a maxSize will be the maximum queue size and the \a mode will dictate
+      overflow behavior.
+    */
+    explicit RingQueue(int maxSize, OverflowMode mode);
+
+    //! Destructs a RingQueue.
+    ~RingQueue();
+
+    /*!
+      Pushes an item into the queue.
+
+      If the queue is full and overflow mode is OverflowModeWait then this
+      function will block until an item is popped.
+    */
+    void push(const T &item);
+
+    /*!
+      Pops an item from the queue.
+
+      If the queue is empty then this function will block until an item is pushed.
+    */
+    T pop();
+
+    //! Pops an item if there is one, returns false if the queue is empty.
+    bool tryPop(T &item);
+
+    //! Returns the number of items in the queue.
+    int count() const;
+
+private:
+    Q_DISABLE_COPY(RingQueue)
+    struct Slot {
+        //! Position of the item the slot holds, plus one if it can be read
+        QAtomicInteger<quint32> sequence;
+        T item;
+    };
+    Slot *m_slots;
+    quint32 m_mask;
+    int m_maxSize;
+    OverflowMode m_mode;
+    //! Next position to write, only changed by the producer
+    QAtomicInteger<quint32> m_tail;
+    //! Next position to read, changed by the consumer and by the producer discarding the oldest item
+    QAtomicInteger<quint32> m_head;
+
+    bool tryPush(const T &item);
+    //! Lets the other thread run while blocking, sleeping if it takes long.
+    static void backoff(int &tries);
+};
+
+template <class T>
+RingQueue<T>::RingQueue(int maxSize, OverflowMode mode)
+    : m_maxSize(qMax(1, maxSize))
+    , m_mode(mode)
+    , m_tail(0)
+    , m_head(0)
+{
+    // Power of two number of slots, for the position to slot mask
+    quint32 size = 2;
+    while (size < (quint32) m_maxSize) {
+        size <<= 1;
+    }
+    m_mask = size - 1;
+    m_slots = new Slot[size];
+    for (quint32 i = 0; i < size; ++i) {
+        m_slots[i].sequence.store(i);
+    }
+}
+
+template <class T>
+RingQueue<T>::~RingQueue()
+{
+    delete[] m_slots;
+}
+
+template <class T>
+bool RingQueue<T>::tryPush(const T &item)
+{
+    const quint32 pos = m_tail.load();
+    if ((int)(pos - m_head.loadAcquire()) >= m_maxSize) {
+        return false;
+    }
+    Slot &slot = m_slots[pos & m_mask];
+    if (slot.sequence.loadAcquire() != pos) {
+        // The consumer has not finished reading the previous item of this slot
+        return false;
+    }
+    slot.item = item;
+    m_tail.store(pos + 1);
+    slot.sequence.storeRelease(pos + 1);
+    return true;
+}
+
+template <class T>
+bool RingQueue<T>::tryPop(T &item)
+{
+    quint32 pos = m_head.load();
+    while (true) {
+        Slot &slot = m_slots[pos & m_mask];
+        const qint32 diff = (qint32)(slot.sequence.loadAcquire() - (pos + 1));
+        if (diff < 0) {
+            // Empty
+            return false;
+        }
+        if (diff == 0) {
+            // Claim the item, the producer may be discarding it at the same time
+            if (m_head.testAndSetOrdered(pos, pos + 1, pos)) {
+                item = slot.item;
+                slot.item = T();
+                slot.sequence.storeRelease(pos + m_mask + 1);
+                return true;
+            }
+        } else {
+            pos = m_head.load();
+        }
+    }
+}
+
+template <class T>
+void RingQueue<T>::push(const T &item)
+{
+    int tries = 0;
+    while (!tryPush(item)) {
+        switch (m_mode) {
+        case OverflowModeDiscardOldest: {
+            T discarded;
+            tryPop(discarded);
+            break;
+        }
+        case OverflowModeDiscardNewest:
+            // This item is the newest so discard it and exit
+            return;
+        case OverflowModeWait:
+            backoff(tries);
+            break;
+        }
+    }
+}
+
+template <class T>
+T RingQueue<T>::pop()
+{
+    T item;
+    int tries = 0;
+    while (!tryPop(item)) {
+        backoff(tries);
+    }
+    return item;
+}
+
+template <class T>
+void RingQueue<T>::backoff(int &tries)
+{
+    if (++tries < 16) {
+        QThread::yieldCurrentThread();
+    } else {
+        QThread::usleep(100);
+    }
+}
+
+template <class T>
+int RingQueue<T>::count() const
+{
+    return qMax(0, (int)(m_tail.loadAcquire() - m_head.loadAcquire()));
+}
+
+#endif // RINGQUEUE_H
@@ -25,7 +25,7 @@
 #include <QFuture>
 #include <QMutex>
 #include "sharedframe.h"
-#include "dataqueue.h"
+#include "ringqueue.h"
 
 /*!
   \class ScopeWidget
@@ -37,8 +37,12 @@
   is the ability to trigger the "heavy lifting" to be done in a worker thread.
 
   Frames are received by the onNewFrame() slot. The ScopeWidget automatically
-  places new frames in the DataQueue (m_queue). Subclasses shall implement the
-  refreshScope() function and can check for new frames in m_queue.
+  places new frames in the RingQueue (m_queue). Subclasses shall implement the
+  refreshScope() function and can check for new frames in m_queue. onNewFrame()
+  is connected to MonitorManager::frameDisplayed, so the GUI thread is the only
+  one pushing frames and the refresh run by QtConcurrent the only one popping
+  them. The queue is lock free so that a long refresh never blocks the GUI
+  thread when it pushes a frame.
 
   refreshScope() is run from a separate thread. Therefore, any members that are
   accessed by both the worker thread (refreshScope) and the GUI thread
@@ -108,7 +112,7 @@ protected:
       Subclasses should check this queue for new frames in the refreshScope()
       implementation.
     */
-    DataQueue<SharedFrame> m_queue;
+    RingQueue<SharedFrame> m_queue;
 
     void resizeEvent(QResizeEvent *) Q_DECL_OVERRIDE;
     void changeEvent(QEvent *) Q_DECL_OVERRIDE;
@@ -92,6 +92,7 @@ ProjectSettings::ProjectSettings(KdenliveDoc *doc, QMap<QString, QString> metada
         m_proxyparameters = doc->getDocumentProperty(QStringLiteral("proxyparams"));
         generate_imageproxy->setChecked(doc->getDocumentProperty(QStringLiteral("generateimageproxy")).toInt());
         proxy_imageminsize->setValue(doc->getDocumentProperty(QStringLiteral("proxyimageminsize")).toInt());
+        generate_slowproxy->setChecked(doc->getDocumentProperty(QStringLiteral("generateslowproxy")).toInt());
         m_proxyextension = doc->getDocumentProperty(QStringLiteral("proxyextension"));
         m_previewparams = doc->getDocumentProperty(QStringLiteral("previewparameters"));
         m_previewextension = doc->getDocumentProperty(QStringLiteral("previewextension"));
@@ -112,6 +113,7 @@ ProjectSettings::ProjectSettings(KdenliveDoc *doc, QMap<QString, QString> metada
         m_proxyparameters = KdenliveSettings::proxyparams();
         generate_imageproxy->setChecked(KdenliveSettings::generateimageproxy());
         proxy_imageminsize->setValue(KdenliveSettings::proxyimageminsize());
+        generate_slowproxy->setChecked(KdenliveSettings::proxyslowclips());
         m_proxyextension = KdenliveSettings::proxyextension();
         m_previewparams = KdenliveSettings::previewparams();
         m_previewextension = KdenliveSettings::previewextension();
@@ -477,6 +479,11 @@ bool ProjectSettings::generateImageProxy() const
     return generate_imageproxy->isChecked();
 }
 
+bool ProjectSettings::generateSlowProxy() const
+{
+    return generate_slowproxy->isChecked();
+}
+
 int ProjectSettings::proxyMinSize() const
 {
     return proxy_minsize->value();
@@ -44,6 +44,7 @@ public:
     int proxyMinSize() const;
     bool generateImageProxy() const;
     int proxyImageMinSize() const;
+    bool generateSlowProxy() const;
     QString proxyParams() const;
     QString proxyExtension() const;
     const QMap<QString, QString> metadata() const;
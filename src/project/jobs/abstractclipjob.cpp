@@ -27,6 +27,8 @@ AbstractClipJob::AbstractClipJob(JOBTYPE type, ClipType cType, const QString &id
     clipType(cType),
     jobType(type),
     replaceClip(false),
+    priority(NORMALPRIORITY),
+    boosted(false),
     m_jobStatus(NoJob),
     m_clipId(id),
     m_addClipToProject(-100),
@@ -101,3 +103,13 @@ bool AbstractClipJob::isExclusive()
     return true;
 }
 
+JobScheduler::ResourceClass AbstractClipJob::resourceClass() const
+{
+    return JobScheduler::CpuResource;
+}
+
+
+QList<AbstractClipJob::JOBTYPE> AbstractClipJob::dependencies() const
+{
+    return QList<JOBTYPE>();
+}
@@ -25,6 +25,7 @@
 #include <QProcess>
 
 #include "definitions.h"
+#include "jobscheduler.h"
 
 /**
  * @class AbstractClipJob
@@ -45,7 +46,15 @@ public:
         TRANSCODEJOB = 4,
         FILTERCLIPJOB = 5,
         THUMBJOB = 5,
-        ANALYSECLIPJOB = 6
+        ANALYSECLIPJOB = 6,
+        LOUDNESSJOB = 7
+    };
+    enum JOBPRIORITY {
+        LOWPRIORITY = -10,
+        NORMALPRIORITY = 0,
+        HIGHPRIORITY = 10,
+        /** @brief Added to the priority of jobs on clips used in timeline or clip monitor */
+        BOOSTPRIORITY = 20
     };
     AbstractClipJob(JOBTYPE type, ClipType cType, const QString &id, QObject *parent = nullptr);
     virtual ~ AbstractClipJob();
@@ -53,6 +62,10 @@ public:
     JOBTYPE jobType;
     QString description;
     bool replaceClip;
+    /** @brief Jobs with a higher priority start first. */
+    int priority;
+    /** @brief True if the priority was raised because the user is working on the clip. */
+    bool boosted;
     const QString clipId() const;
     const QString errorMessage() const;
     const QString logDetails() const;
@@ -65,6 +78,10 @@ public:
     virtual const QString statusMessage();
     /** @brief Returns true if only one instance of this job can be run on a clip. */
     virtual bool isExclusive();
+    /** @brief The kind of resource this job mostly uses, to decide how many can run together. */
+    virtual JobScheduler::ResourceClass resourceClass() const;
+    /** @brief Job types that must be finished on the same clip before this job can start. */
+    virtual QList<JOBTYPE> dependencies() const;
     int addClipToProject() const;
     void setAddClipToProject(int add);
 
@@ -53,6 +53,7 @@ CutClipJob::CutClipJob(ClipType cType, const QString &id, const QStringList &par
     case AbstractClipJob::ANALYSECLIPJOB:
     default:
         description = i18n("Analyse clip");
+        priority = LOWPRIORITY;
         break;
     }
     replaceClip = false;
@@ -110,6 +111,7 @@ void CutClipJob::startJob()
         if (jobType != AbstractClipJob::ANALYSECLIPJOB) {
             m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
         }
+        JobScheduler::lowerPriority(exec, parameters);
         m_jobProcess->start(exec, parameters);
         m_jobProcess->waitForStarted();
         while (m_jobProcess->state() != QProcess::NotRunning) {
@@ -254,6 +256,15 @@ bool CutClipJob::isExclusive()
     return false;
 }
 
+JobScheduler::ResourceClass CutClipJob::resourceClass() const
+{
+    // Analysis and cuts without re-encoding are limited by the disk, not the CPU
+    if (jobType == AbstractClipJob::ANALYSECLIPJOB || (jobType == AbstractClipJob::CUTJOB && m_cutExtraParams.contains(QLatin1String("copy")))) {
+        return JobScheduler::IoResource;
+    }
+    return JobScheduler::CpuResource;
+}
+
 // static
 QList<ProjectClip *> CutClipJob::filterClips(const QList<ProjectClip *> &clips, const QStringList &params)
 {
@@ -48,6 +48,7 @@ public:
     stringMap cancelProperties() Q_DECL_OVERRIDE;
     const QString statusMessage() Q_DECL_OVERRIDE;
     bool isExclusive() Q_DECL_OVERRIDE;
+    JobScheduler::ResourceClass resourceClass() const Q_DECL_OVERRIDE;
     static QHash<ProjectClip *, AbstractClipJob *> prepareTranscodeJob(double fps, const QList<ProjectClip *> &ids,  const QStringList &parameters);
     static QHash<ProjectClip *, AbstractClipJob *> prepareCutClipJob(double fps, double originalFps, ProjectClip *clip);
     static QHash<ProjectClip *, AbstractClipJob *> prepareAnalyseJob(double fps, const QList<ProjectClip *> &clips, const QStringList &parameters);
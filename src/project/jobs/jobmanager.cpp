@@ -29,7 +29,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "project/clipstabilize.h"
 #include "meltjob.h"
 #include "filterjob.h"
+#include "loudnessjob.h"
+#include "jobscheduler.h"
 #include "bin/bin.h"
+#include "core.h"
 #include "mlt++/Mlt.h"
 
 #include "kdenlive_debug.h"
@@ -46,6 +49,8 @@ JobManager::JobManager(Bin *bin): QObject()
 {
     connect(this, &JobManager::processLog, this, &JobManager::slotProcessLog);
     connect(this, &JobManager::checkJobProcess, this, &JobManager::slotCheckJobProcess);
+    // Slots are also released by render jobs, or when the queue is resumed
+    connect(pCore->jobScheduler(), &JobScheduler::slotsAvailable, this, &JobManager::checkJobProcess, Qt::QueuedConnection);
 }
 
 JobManager::~JobManager()
@@ -56,6 +61,10 @@ JobManager::~JobManager()
     }
     m_jobThreads.waitForFinished();
     m_jobThreads.clearFutures();
+    for (int ticket : m_tickets) {
+        pCore->jobScheduler()->finish(ticket);
+    }
+    m_tickets.clear();
     if (!m_jobList.isEmpty()) {
         qDeleteAll(m_jobList);
     }
@@ -87,7 +96,15 @@ void JobManager::discardJobs(const QString &id, AbstractClipJob::JOBTYPE type)
     for (int i = 0; i < m_jobList.count(); ++i) {
         if (m_jobList.at(i)->clipId() == id && (type == AbstractClipJob::NOJOBTYPE || m_jobList.at(i)->jobType == type)) {
             // discard this job
-            m_jobList.at(i)->setStatus(JobAborted);
+            AbstractClipJob *job = m_jobList.at(i);
+            if (job->status() == JobWorking && m_tickets.contains(job)) {
+                // Don't wait for the job to notice it was aborted to start the next one
+                m_cancelledJobs.insert(job);
+            }
+            if (job->status() == JobWaiting || job->status() == JobWorking) {
+                releaseTicket(job);
+            }
+            job->setStatus(JobAborted);
         }
     }
     emit updateJobStatus(id, type, JobAborted);
@@ -129,20 +146,107 @@ void JobManager::slotCheckJobProcess()
     for (int i = 0; i < m_jobList.count(); ++i) {
         if (m_jobList.at(i)->status() == JobWorking || m_jobList.at(i)->status() == JobWaiting) {
             count ++;
-        } else {
+        } else if (!m_cancelledJobs.contains(m_jobList.at(i))) {
             // remove finished jobs
             AbstractClipJob *job = m_jobList.takeAt(i);
+            releaseTicket(job);
             job->deleteLater();
             --i;
         }
     }
+    // Threads of cancelled jobs don't hold a slot anymore
+    const int maxThreads = pCore->jobScheduler()->totalLimit() + m_cancelledJobs.count();
     m_jobMutex.unlock();
     emit jobCount(count);
-    if (m_jobThreads.futures().isEmpty() || m_jobThreads.futures().count() < KdenliveSettings::proxythreads()) {
+    // The scheduler decides which jobs may run, allow one thread per slot
+    if (count > 0 && m_jobThreads.futures().count() < maxThreads) {
         m_jobThreads.addFuture(QtConcurrent::run(this, &JobManager::slotProcessJobs));
     }
 }
 
+void JobManager::releaseTicket(AbstractClipJob *job)
+{
+    QHash<AbstractClipJob *, int>::iterator it = m_tickets.find(job);
+    if (it != m_tickets.end()) {
+        pCore->jobScheduler()->finish(it.value());
+        m_tickets.erase(it);
+    }
+}
+
+void JobManager::jobThreadDone(AbstractClipJob *job)
+{
+    QMutexLocker lock(&m_jobMutex);
+    // A discarded job already gave its slot back
+    if (!m_cancelledJobs.remove(job)) {
+        releaseTicket(job);
+    }
+}
+
+void JobManager::insertJob(AbstractClipJob *job)
+{
+    int i = m_jobList.count();
+    while (i > 0 && m_jobList.at(i - 1)->priority < job->priority) {
+        --i;
+    }
+    m_jobList.insert(i, job);
+}
+
+void JobManager::setJobPriority(AbstractClipJob *job, int priority)
+{
+    m_jobList.removeOne(job);
+    job->priority = priority;
+    insertJob(job);
+    if (m_tickets.contains(job)) {
+        pCore->jobScheduler()->setPriority(m_tickets.value(job), priority);
+    }
+}
+
+bool JobManager::isBlocked(AbstractClipJob *job) const
+{
+    const QList<AbstractClipJob::JOBTYPE> dependencies = job->dependencies();
+    if (dependencies.isEmpty()) {
+        return false;
+    }
+    for (AbstractClipJob *other : m_jobList) {
+        if (other != job && other->clipId() == job->clipId() && dependencies.contains(other->jobType) && (other->status() == JobWaiting || other->status() == JobWorking)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+AbstractClipJob *JobManager::findDuplicate(AbstractClipJob *job) const
+{
+    for (AbstractClipJob *other : m_jobList) {
+        if (other->clipId() != job->clipId() || other->jobType != job->jobType) {
+            continue;
+        }
+        if (job->isExclusive()) {
+            if (other->status() == JobWaiting || other->status() == JobWorking) {
+                return other;
+            }
+        } else if (other->status() == JobWaiting && other->destination() == job->destination() && other->description == job->description) {
+            return other;
+        }
+    }
+    return nullptr;
+}
+
+void JobManager::boostClip(const QString &id)
+{
+    QMutexLocker lock(&m_jobMutex);
+    QList<AbstractClipJob *> jobs;
+    for (AbstractClipJob *job : m_jobList) {
+        if (job->clipId() == id && job->status() == JobWaiting && !job->boosted) {
+            jobs << job;
+        }
+    }
+    for (AbstractClipJob *job : jobs) {
+        job->boosted = true;
+        setJobPriority(job, job->priority + AbstractClipJob::BOOSTPRIORITY);
+    }
+}
+
 void JobManager::updateJobCount()
 {
     int count = 0;
@@ -161,9 +265,21 @@ void JobManager::slotProcessJobs()
     while (!m_jobList.isEmpty() && !m_abortAllJobs) {
         AbstractClipJob *job = nullptr;
         m_jobMutex.lock();
-        for (int i = 0; i < m_jobList.count(); ++i) {
-            if (m_jobList.at(i)->status() == JobWaiting) {
-                job = m_jobList.at(i);
+        // Jobs waiting for another one on the same clip must not keep the others from starting
+        QList<AbstractClipJob *> candidates;
+        for (AbstractClipJob *waiting : m_jobList) {
+            if (waiting->status() == JobWaiting) {
+                const bool blocked = isBlocked(waiting);
+                pCore->jobScheduler()->setHeld(m_tickets.value(waiting), blocked);
+                if (!blocked) {
+                    candidates << waiting;
+                }
+            }
+        }
+        for (AbstractClipJob *candidate : candidates) {
+            // Skip jobs whose resource class has no free slot, the next ones may use another class
+            if (pCore->jobScheduler()->tryStart(m_tickets.value(candidate))) {
+                job = candidate;
                 job->setStatus(JobWorking);
                 break;
             }
@@ -182,6 +298,7 @@ void JobManager::slotProcessJobs()
         ProjectClip *currentClip = m_bin->getBinClip(job->clipId());
         if (currentClip == nullptr) {
             job->setStatus(JobDone);
+            jobThreadDone(job);
             continue;
         }
         // Set clip status to started
@@ -207,6 +324,7 @@ void JobManager::slotProcessJobs()
             if (!writable) {
                 emit updateJobStatus(job->clipId(), job->jobType, JobCrashed, i18n("Cannot write to path: %1", destination));
                 job->setStatus(JobCrashed);
+                jobThreadDone(job);
                 continue;
             }
         }
@@ -216,7 +334,11 @@ void JobManager::slotProcessJobs()
         if (job->jobType == AbstractClipJob::MLTJOB || job->jobType == AbstractClipJob::ANALYSECLIPJOB) {
             connect(job, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)), this, SIGNAL(gotFilterJobResults(QString, int, int, stringMap, stringMap)));
         }
+        if (job->jobType == AbstractClipJob::LOUDNESSJOB) {
+            connect(job, SIGNAL(gotLoudnessResults(QString, stringMap, stringMap)), m_bin, SLOT(slotGotLoudnessResults(QString, stringMap, stringMap)));
+        }
         job->startJob();
+        jobThreadDone(job);
         if (job->status() == JobDone) {
             emit updateJobStatus(job->clipId(), job->jobType, JobDone);
             //TODO: replace with more generic clip replacement framework
@@ -229,8 +351,11 @@ void JobManager::slotProcessJobs()
             emit updateJobStatus(job->clipId(), job->jobType, job->status(), job->errorMessage(), QString(), job->logDetails());
         }
     }
-    // Thread finished, cleanup & update count
-    QTimer::singleShot(200, this, &JobManager::checkJobProcess);
+    // Thread finished, cleanup & update count. If no job could start, the scheduler
+    // will tell us when a slot is available
+    if (!firstPass) {
+        QTimer::singleShot(200, this, &JobManager::checkJobProcess);
+    }
 }
 
 QList<ProjectClip *> JobManager::filterClips(const QList<ProjectClip *> &clips, AbstractClipJob::JOBTYPE jobType, const QStringList &params)
@@ -242,6 +367,8 @@ QList<ProjectClip *> JobManager::filterClips(const QList<ProjectClip *> &clips,
         return FilterJob::filterClips(clips, params);
     } else if (jobType == AbstractClipJob::PROXYJOB) {
         return ProxyJob::filterClips(clips);
+    } else if (jobType == AbstractClipJob::LOUDNESSJOB) {
+        return LoudnessJob::filterClips(clips);
     }
     return QList<ProjectClip *> ();
 }
@@ -274,6 +401,8 @@ void JobManager::prepareJobs(const QList<ProjectClip *> &clips, double fps, Abst
         jobs = FilterJob::prepareJob(matching, params);
     } else if (jobType == AbstractClipJob::PROXYJOB) {
         jobs = ProxyJob::prepareJob(m_bin, matching);
+    } else if (jobType == AbstractClipJob::LOUDNESSJOB) {
+        jobs = LoudnessJob::prepareJob(matching, params);
     }
     if (!jobs.isEmpty()) {
         QHashIterator<ProjectClip *, AbstractClipJob *> i(jobs);
@@ -287,12 +416,27 @@ void JobManager::prepareJobs(const QList<ProjectClip *> &clips, double fps, Abst
 
 void JobManager::launchJob(ProjectClip *clip, AbstractClipJob *job, bool runQueue)
 {
-    if (job->isExclusive() && hasPendingJob(clip->clipId(), job->jobType)) {
+    if (m_bin->isClipActive(clip)) {
+        job->boosted = true;
+        job->priority += AbstractClipJob::BOOSTPRIORITY;
+    }
+    m_jobMutex.lock();
+    AbstractClipJob *duplicate = findDuplicate(job);
+    if (duplicate) {
+        // Same request already queued, only keep the highest priority
+        if (duplicate->status() == JobWaiting && job->priority > duplicate->priority) {
+            duplicate->boosted = duplicate->boosted || job->boosted;
+            setJobPriority(duplicate, job->priority);
+        }
+        m_jobMutex.unlock();
         delete job;
         return;
     }
-
-    m_jobList.append(job);
+    insertJob(job);
+    const int ticket = pCore->jobScheduler()->enqueue(job->resourceClass(), job->description.isEmpty() ? clip->name() : job->description, job->priority);
+    pCore->jobScheduler()->setHeld(ticket, isBlocked(job));
+    m_tickets.insert(job, ticket);
+    m_jobMutex.unlock();
     clip->setJobStatus(job->jobType, JobWaiting, 0, job->statusMessage());
     if (runQueue) {
         slotCheckJobProcess();
@@ -320,6 +464,7 @@ void JobManager::slotCancelPendingJobs()
     for (int i = 0; i < m_jobList.count(); ++i) {
         if (m_jobList.at(i)->status() == JobWaiting) {
             // discard this job
+            releaseTicket(m_jobList.at(i));
             m_jobList.at(i)->setStatus(JobAborted);
             emit updateJobStatus(m_jobList.at(i)->clipId(), m_jobList.at(i)->jobType, JobAborted);
         }
@@ -335,6 +480,7 @@ void JobManager::slotCancelJobs()
     }
     m_jobThreads.waitForFinished();
     m_jobThreads.clearFutures();
+    m_cancelledJobs.clear();
 
     //TODO: undo job cancelation ? not sure it's necessary
     /*QUndoCommand *command = new QUndoCommand();
@@ -355,6 +501,10 @@ void JobManager::slotCancelJobs()
     }
     else delete command;
     */
+    for (int ticket : m_tickets) {
+        pCore->jobScheduler()->finish(ticket);
+    }
+    m_tickets.clear();
     if (!m_jobList.isEmpty()) {
         qDeleteAll(m_jobList);
     }
@@ -27,6 +27,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QObject>
 #include <QMutex>
+#include <QHash>
+#include <QSet>
 #include <QFutureSynchronizer>
 
 class AbstractClipJob;
@@ -93,6 +95,9 @@ public:
     /** @brief Get the list of job names for current clip. */
     QStringList getPendingJobs(const QString &id);
 
+    /** @brief Move the waiting jobs of a clip ahead of the others, used when the clip is opened in monitor or timeline. */
+    void boostClip(const QString &id);
+
 private slots:
     void slotCheckJobProcess();
     void slotProcessJobs();
@@ -111,8 +116,12 @@ private:
     Bin *m_bin;
     /** @brief Mutex preventing thread issues. */
     QMutex m_jobMutex;
-    /** @brief Holds a list of active jobs. */
+    /** @brief Holds a list of active jobs, sorted by priority then queue order. */
     QList<AbstractClipJob *> m_jobList;
+    /** @brief The scheduler ticket of each job in m_jobList. */
+    QHash<AbstractClipJob *, int> m_tickets;
+    /** @brief Discarded jobs whose thread did not return yet. Their slot is already released. */
+    QSet<AbstractClipJob *> m_cancelledJobs;
     /** @brief Holds the threads running a job. */
     QFutureSynchronizer<void> m_jobThreads;
     /** @brief Set to true to trigger abortion of all jobs. */
@@ -121,6 +130,18 @@ private:
     void createProxy(const QString &id);
     /** @brief Update job count in info widget. */
     void updateJobCount();
+    /** @brief Give the scheduler slot of a job back. */
+    void releaseTicket(AbstractClipJob *job);
+    /** @brief Called when the thread processing a job is done with it. */
+    void jobThreadDone(AbstractClipJob *job);
+    /** @brief Insert a job in the list according to its priority. */
+    void insertJob(AbstractClipJob *job);
+    /** @brief Change the priority of a waiting job and move it in the list. */
+    void setJobPriority(AbstractClipJob *job, int priority);
+    /** @brief Returns true if a job this one depends on is still pending on the same clip. */
+    bool isBlocked(AbstractClipJob *job) const;
+    /** @brief Returns a pending job doing the same work, or nullptr. */
+    AbstractClipJob *findDuplicate(AbstractClipJob *job) const;
 
 signals:
     void addClip(const QString &, int folderId);
@@ -0,0 +1,225 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "jobscheduler.h"
+#include "kdenlivesettings.h"
+#include "kdenlive_debug.h"
+
+#include <QStandardPaths>
+#include <klocalizedstring.h>
+
+JobScheduler::JobScheduler(QObject *parent) : QObject(parent)
+    , m_lastTicket(0)
+    , m_paused(false)
+{
+    for (int i = 0; i < ResourceCount; ++i) {
+        m_running[i] = 0;
+        m_metrics[i].jobs = 0;
+        m_metrics[i].totalWait = 0;
+        m_metrics[i].maxWait = 0;
+        m_metrics[i].totalRun = 0;
+    }
+}
+
+int JobScheduler::enqueue(ResourceClass resource, const QString &description, int priority)
+{
+    QMutexLocker lock(&m_mutex);
+    Ticket ticket;
+    ticket.resource = resource;
+    ticket.description = description;
+    ticket.priority = priority;
+    ticket.running = false;
+    ticket.held = false;
+    ticket.timer.start();
+    m_tickets.insert(++m_lastTicket, ticket);
+    return m_lastTicket;
+}
+
+bool JobScheduler::tryStart(int ticket)
+{
+    QMutexLocker lock(&m_mutex);
+    QMap<int, Ticket>::iterator it = m_tickets.find(ticket);
+    if (it == m_tickets.end()) {
+        return false;
+    }
+    if (it->running) {
+        return true;
+    }
+    if (m_paused || m_running[it->resource] >= limit(it->resource)) {
+        return false;
+    }
+    // Keep the priority, then queue order within a class
+    for (QMap<int, Ticket>::const_iterator other = m_tickets.constBegin(); other != m_tickets.constEnd(); ++other) {
+        if (other == it || other->running || other->held || other->resource != it->resource) {
+            continue;
+        }
+        if (other->priority > it->priority || (other->priority == it->priority && other.key() < ticket)) {
+            return false;
+        }
+    }
+    Metrics &metrics = m_metrics[it->resource];
+    const qint64 wait = it->timer.restart();
+    metrics.totalWait += wait;
+    metrics.maxWait = qMax(metrics.maxWait, wait);
+    it->running = true;
+    m_running[it->resource]++;
+    return true;
+}
+
+void JobScheduler::setPriority(int ticket, int priority)
+{
+    QMutexLocker lock(&m_mutex);
+    QMap<int, Ticket>::iterator it = m_tickets.find(ticket);
+    if (it != m_tickets.end()) {
+        it->priority = priority;
+    }
+}
+
+void JobScheduler::setHeld(int ticket, bool held)
+{
+    QMutexLocker lock(&m_mutex);
+    QMap<int, Ticket>::iterator it = m_tickets.find(ticket);
+    if (it != m_tickets.end()) {
+        it->held = held;
+    }
+}
+
+void JobScheduler::finish(int ticket)
+{
+    QMutexLocker lock(&m_mutex);
+    QMap<int, Ticket>::iterator it = m_tickets.find(ticket);
+    if (it == m_tickets.end()) {
+        return;
+    }
+    const bool wasRunning = it->running;
+    if (wasRunning) {
+        Metrics &metrics = m_metrics[it->resource];
+        metrics.jobs++;
+        metrics.totalRun += it->timer.elapsed();
+        m_running[it->resource]--;
+        qCDebug(KDENLIVE_LOG) << "Job" << it->description << "ran for" << it->timer.elapsed() << "ms";
+    }
+    m_tickets.erase(it);
+    lock.unlock();
+    // Removing a waiting job may also unblock the ones queued after it
+    emit slotsAvailable();
+}
+
+bool JobScheduler::isPaused() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_paused;
+}
+
+void JobScheduler::setPaused(bool paused)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_paused == paused) {
+        return;
+    }
+    m_paused = paused;
+    lock.unlock();
+    emit pausedChanged(paused);
+    if (!paused) {
+        emit slotsAvailable();
+    }
+}
+
+int JobScheduler::limit(ResourceClass resource) const
+{
+    switch (resource) {
+    case IoResource:
+        return qMax(1, KdenliveSettings::iojobs());
+    case RenderResource:
+        return qMax(1, KdenliveSettings::renderjobs());
+    default:
+        return qMax(1, KdenliveSettings::cpujobs());
+    }
+}
+
+int JobScheduler::totalLimit() const
+{
+    return limit(CpuResource) + limit(IoResource);
+}
+
+QString JobScheduler::metrics() const
+{
+    QMutexLocker lock(&m_mutex);
+    QStringList result;
+    for (int i = 0; i < ResourceCount; ++i) {
+        int waiting = 0;
+        for (const Ticket &ticket : m_tickets) {
+            if (!ticket.running && ticket.resource == i) {
+                waiting++;
+            }
+        }
+        const Metrics &metrics = m_metrics[i];
+        const int started = metrics.jobs + m_running[i];
+        QString name;
+        switch (i) {
+        case IoResource:
+            name = i18n("Disk jobs");
+            break;
+        case RenderResource:
+            name = i18n("Renders");
+            break;
+        default:
+            name = i18n("Processing jobs");
+            break;
+        }
+        result << i18n("%1: %2 running, %3 waiting, %4 done. Average wait %5s (max %6s), average run time %7s",
+                       name, m_running[i], waiting, metrics.jobs,
+                       QString::number(started > 0 ? metrics.totalWait / 1000.0 / started : 0., 'f', 1),
+                       QString::number(metrics.maxWait / 1000.0, 'f', 1),
+                       QString::number(metrics.jobs > 0 ? metrics.totalRun / 1000.0 / metrics.jobs : 0., 'f', 1));
+    }
+    return result.join(QLatin1Char('\n'));
+}
+
+void JobScheduler::lowerPriority(QString &program, QStringList &args)
+{
+#ifdef Q_OS_UNIX
+    if (!KdenliveSettings::backgroundjobpriority()) {
+        return;
+    }
+    const QString nice = QStandardPaths::findExecutable(QStringLiteral("nice"));
+    if (!nice.isEmpty()) {
+        args.prepend(program);
+        args.prepend(QStringLiteral("10"));
+        args.prepend(QStringLiteral("-n"));
+        program = nice;
+    }
+    // Lowest best effort IO priority, only available on Linux. The idle class
+    // could starve the job as long as anything else uses the disk.
+    const QString ionice = QStandardPaths::findExecutable(QStringLiteral("ionice"));
+    if (!ionice.isEmpty()) {
+        args.prepend(program);
+        args.prepend(QStringLiteral("7"));
+        args.prepend(QStringLiteral("-n"));
+        args.prepend(QStringLiteral("2"));
+        args.prepend(QStringLiteral("-c"));
+        program = ionice;
+    }
+#else
+    Q_UNUSED(program)
+    Q_UNUSED(args)
+#endif
+}
@@ -0,0 +1,117 @@
+/*
+Copyright (C) 2018  Kdenlive team <kdenlive@kde.org>
+This file is part of Kdenlive. See www.kdenlive.org.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QMap>
+#include <QElapsedTimer>
+#include <QStringList>
+
+/**
+ * @class JobScheduler
+ * @brief Shares the machine between render jobs and clip jobs.
+ *
+ * Every job takes a ticket when it is queued and asks for a slot before starting.
+ * Jobs are sorted in resource classes, each with its own number of slots, so that a
+ * disk bound job can run next to encodes. Renders have their own class, serial by default,
+ * since each one already uses several threads. Within a class, slots are given by priority, then
+ * in queue order. A held job keeps its place but does not block the ones queued after it.
+ * The scheduler can be paused: running jobs continue but no new job starts.
+ * Methods are thread safe, clip jobs ask for slots from their worker threads.
+ */
+
+class JobScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ResourceClass {
+        /** @brief Encoding and effect processing */
+        CpuResource = 0,
+        /** @brief Stream copies and analysis, mostly waiting for the disk */
+        IoResource = 1,
+        /** @brief Project renders */
+        RenderResource = 2
+    };
+    static const int ResourceCount = 3;
+
+    explicit JobScheduler(QObject *parent = nullptr);
+
+    /** @brief Queue a job, returns the ticket used for the other calls. */
+    int enqueue(ResourceClass resource, const QString &description, int priority = 0);
+    /** @brief Take a slot for a queued job. Returns false if the queue is paused, the class is full
+     *  or a job of the same class with a higher priority, or older, is still waiting. */
+    bool tryStart(int ticket);
+    /** @brief Change the priority of a waiting job. */
+    void setPriority(int ticket, int priority);
+    /** @brief A held job cannot start yet (waiting for another job), let the next ones go first. */
+    void setHeld(int ticket, bool held);
+    /** @brief Release the slot of a running job, or remove a waiting job from the queue. */
+    void finish(int ticket);
+
+    bool isPaused() const;
+    /** @brief Maximum number of concurrent jobs for the class. */
+    int limit(ResourceClass resource) const;
+    /** @brief Total number of slots for clip jobs, renders excluded. */
+    int totalLimit() const;
+
+    /** @brief Wait and run time statistics, as displayable text. */
+    QString metrics() const;
+
+    /** @brief Run an external clip job command with a low CPU and IO priority if enabled in the settings, not used for renders. */
+    static void lowerPriority(QString &program, QStringList &args);
+
+public slots:
+    void setPaused(bool paused);
+
+private:
+    struct Ticket {
+        ResourceClass resource;
+        QString description;
+        int priority;
+        bool running;
+        bool held;
+        QElapsedTimer timer;
+    };
+    struct Metrics {
+        int jobs;
+        qint64 totalWait;
+        qint64 maxWait;
+        qint64 totalRun;
+    };
+    mutable QMutex m_mutex;
+    /** @brief Sorted by ticket, so by queue order */
+    QMap<int, Ticket> m_tickets;
+    int m_lastTicket;
+    int m_running[ResourceCount];
+    Metrics m_metrics[ResourceCount];
+    bool m_paused;
+
+signals:
+    /** @brief A slot was released or the queue resumed, waiting jobs may start. */
+    void slotsAvailable();
+    void pausedChanged(bool paused);
+};
+
+#endif
@@ -0,0 +1,236 @@
+/***************************************************************************
+ *                                                                         *
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "loudnessjob.h"
+#include "kdenlivesettings.h"
+#include "bin/projectclip.h"
+#include "lib/audio/loudnessMeter.h"
+
+#include "kdenlive_debug.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
+#include <klocalizedstring.h>
+#include <mlt++/Mlt.h>
+
+#include <math.h>
+#include <memory>
+
+// Audio is resampled to this frequency for the analysis
+static const int LOUDNESS_FREQUENCY = 48000;
+// Clips shorter than this (in seconds) are not split
+static const int LOUDNESS_SEGMENT = 30;
+// Audio decoded before each segment (in 100ms blocks) to fill the 3s short-term
+// window, plus one second for the K-weighting filters to settle
+static const int LOUDNESS_PREROLL = 40;
+
+LoudnessJob::LoudnessJob(ClipType cType, const QString &id, const QString &url, int channels, const QString &target)
+    : AbstractClipJob(LOUDNESSJOB, cType, id),
+      m_url(url),
+      m_channels(channels > 0 ? channels : 2),
+      m_target(target),
+      m_length(0),
+      m_processedFrames(0)
+{
+    m_jobStatus = JobWaiting;
+    description = m_target.isEmpty() ? i18n("Analyse loudness") : i18n("Normalize loudness");
+}
+
+LoudnessJob::~LoudnessJob()
+{
+}
+
+void LoudnessJob::startJob()
+{
+    if (m_url.isEmpty()) {
+        m_errorMessage.append(i18n("No producer for this clip."));
+        setStatus(JobCrashed);
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    Mlt::Profile profile(KdenliveSettings::current_profile().toUtf8().constData());
+    Mlt::Producer producer(profile, m_url.toUtf8().constData());
+    if (!producer.is_valid()) {
+        m_errorMessage.append(i18n("Invalid clip"));
+        setStatus(JobCrashed);
+        return;
+    }
+    m_length = producer.get_playtime();
+    if (m_length <= 0) {
+        m_length = producer.get_length();
+    }
+    // Split long clips so that each thread decodes its own part with a separate producer
+    int segments = qBound(1, m_length / qMax(1, (int)(profile.fps() * LOUDNESS_SEGMENT)), QThread::idealThreadCount());
+    QVector<LoudnessMeter> meters(segments);
+    QList<QFuture<void> > futures;
+    for (int i = 0; i < segments; ++i) {
+        int in = m_length * i / segments;
+        int out = m_length * (i + 1) / segments - 1;
+        meters[i].configure(m_channels, LOUDNESS_FREQUENCY);
+        futures << QtConcurrent::run(this, &LoudnessJob::analyseSegment, in, out, &meters[i]);
+    }
+    for (int i = 0; i < futures.count(); ++i) {
+        futures[i].waitForFinished();
+    }
+    if (m_jobStatus == JobAborted) {
+        return;
+    }
+    LoudnessMeter &meter = meters[0];
+    for (int i = 1; i < segments; ++i) {
+        meter.merge(meters.at(i));
+    }
+    double integrated = meter.integrated();
+    if (integrated < LoudnessMeter::AbsoluteGate) {
+        m_errorMessage.append(i18n("No audio found in clip"));
+        setStatus(JobCrashed);
+        return;
+    }
+    qCDebug(KDENLIVE_LOG) << "// Loudness of" << m_url << "analysed in" << timer.elapsed() << "ms, using" << segments << "threads";
+    QMap<QString, QString> results;
+    results.insert(QStringLiteral("kdenlive:loudness.integrated"), QString::number(integrated, 'f', 1));
+    results.insert(QStringLiteral("kdenlive:loudness.range"), QString::number(meter.loudnessRange(), 'f', 1));
+    double truePeak = meter.truePeak();
+    results.insert(QStringLiteral("kdenlive:loudness.truepeak"), truePeak < LoudnessMeter::TruePeakFloor ? QStringLiteral("-inf") : QString::number(truePeak, 'f', 1));
+    QMap<QString, QString> extra;
+    if (!m_target.isEmpty()) {
+        extra.insert(QStringLiteral("target"), m_target);
+    }
+    emit gotLoudnessResults(m_clipId, results, extra);
+    if (m_jobStatus == JobWorking) {
+        m_jobStatus = JobDone;
+    }
+}
+
+void LoudnessJob::analyseSegment(int in, int out, LoudnessMeter *meter)
+{
+    Mlt::Profile profile(KdenliveSettings::current_profile().toUtf8().constData());
+    Mlt::Producer producer(profile, m_url.toUtf8().constData());
+    if (!producer.is_valid()) {
+        return;
+    }
+    double fps = profile.fps();
+    // Gating blocks are aligned on the start of the clip. Each segment starts decoding
+    // a few seconds early on a block boundary, and only keeps the blocks ending after
+    // its first sample, so that the merged histograms match a single pass.
+    const qint64 blockLength = LOUDNESS_FREQUENCY / 10;
+    const qint64 startSample = mlt_sample_calculator_to_now(fps, LOUDNESS_FREQUENCY, in);
+    const qint64 prerollSample = qMax((qint64) 0, (startSample / blockLength - LOUDNESS_PREROLL) * blockLength);
+    int first = in;
+    while (first > 0 && mlt_sample_calculator_to_now(fps, LOUDNESS_FREQUENCY, first) > prerollSample) {
+        --first;
+    }
+    qint64 samplePos = mlt_sample_calculator_to_now(fps, LOUDNESS_FREQUENCY, first);
+    bool measuring = false;
+    producer.seek(first);
+    int progress = 0;
+    for (int pos = first; pos <= out && m_jobStatus != JobAborted; ++pos) {
+        // Only audio is fetched, so no video frame gets decoded
+        std::unique_ptr<Mlt::Frame> frame(producer.get_frame());
+        if (!frame || !frame->is_valid()) {
+            break;
+        }
+        mlt_audio_format format = mlt_audio_s16;
+        int frequency = LOUDNESS_FREQUENCY;
+        int channels = m_channels;
+        int samples = mlt_sample_calculator(fps, frequency, pos);
+        const qint16 *data = (const qint16 *) frame->get_audio(format, frequency, channels, samples);
+        qint64 frameStart = samplePos;
+        samplePos += samples;
+        if (data && samples > 0 && channels == m_channels && frequency == LOUDNESS_FREQUENCY) {
+            if (frameStart < prerollSample) {
+                // Keep the block alignment of a single pass
+                int skip = (int) qMin((qint64) samples, prerollSample - frameStart);
+                data += skip * channels;
+                samples -= skip;
+                frameStart += skip;
+            }
+            if (!measuring && frameStart + samples >= startSample) {
+                // Blocks ending up to the segment start belong to the previous segment
+                int before = (int) qMax((qint64) 0, startSample - frameStart);
+                meter->process(data, before);
+                meter->clearMeasurements();
+                data += before * channels;
+                samples -= before;
+                measuring = true;
+            }
+            meter->process(data, samples);
+        }
+        if (pos < in) {
+            continue;
+        }
+        int done = m_processedFrames.fetchAndAddRelaxed(1) + 1;
+        int percent = (int)(100 * (qint64) done / qMax(1, m_length));
+        if (percent > progress) {
+            progress = percent;
+            emit jobProgress(m_clipId, percent, jobType);
+        }
+    }
+}
+
+QList<AbstractClipJob::JOBTYPE> LoudnessJob::dependencies() const
+{
+    // Measure the transcoded clip, not the one being replaced
+    return QList<JOBTYPE>() << TRANSCODEJOB;
+}
+
+const QString LoudnessJob::statusMessage()
+{
+    QString statusInfo;
+    switch (m_jobStatus) {
+    case JobWorking:
+        statusInfo = description;
+        break;
+    case JobWaiting:
+        statusInfo = i18n("Waiting - loudness");
+        break;
+    default:
+        break;
+    }
+    return statusInfo;
+}
+
+// static
+QList<ProjectClip *> LoudnessJob::filterClips(const QList<ProjectClip *> &clips)
+{
+    QList<ProjectClip *> result;
+    for (int i = 0; i < clips.count(); i++) {
+        ProjectClip *clip = clips.at(i);
+        ClipType type = clip->clipType();
+        if (type != AV && type != Audio && type != Playlist) {
+            // Clip will not be processed by this job
+            continue;
+        }
+        result << clip;
+    }
+    return result;
+}
+
+// static
+QHash<ProjectClip *, AbstractClipJob *> LoudnessJob::prepareJob(const QList<ProjectClip *> &clips, const QStringList &parameters)
+{
+    QHash<ProjectClip *, AbstractClipJob *> jobs;
+    QString target = parameters.isEmpty() ? QString() : parameters.constFirst();
+    for (int i = 0; i < clips.count(); i++) {
+        ProjectClip *item = clips.at(i);
+        jobs.insert(item, new LoudnessJob(item->clipType(), item->clipId(), item->url(), item->audioChannels(), target));
+    }
+    return jobs;
+}
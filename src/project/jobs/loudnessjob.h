@@ -0,0 +1,67 @@
+/***************************************************************************
+ *                                                                         *
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef LOUDNESSJOB
+#define LOUDNESSJOB
+
+#include "abstractclipjob.h"
+
+#include <QAtomicInt>
+
+class LoudnessMeter;
+class ProjectClip;
+
+/**
+ * @class LoudnessJob
+ * @brief Measures the EBU R128 loudness of a clip by decoding its audio without playback.
+ *
+ * Long clips are split in segments that are decoded in parallel, each by its own producer.
+ * The results are stored as clip properties, and a volume effect can be added to the clip
+ * to reach a target integrated loudness.
+ */
+
+class LoudnessJob : public AbstractClipJob
+{
+    Q_OBJECT
+
+public:
+    /** @param target the integrated loudness to normalize to in LUFS, empty to only measure */
+    LoudnessJob(ClipType cType, const QString &id, const QString &url, int channels, const QString &target);
+    virtual ~ LoudnessJob();
+    void startJob() Q_DECL_OVERRIDE;
+    const QString statusMessage() Q_DECL_OVERRIDE;
+    QList<JOBTYPE> dependencies() const Q_DECL_OVERRIDE;
+    static QList<ProjectClip *> filterClips(const QList<ProjectClip *> &clips);
+    static QHash<ProjectClip *, AbstractClipJob *> prepareJob(const QList<ProjectClip *> &clips, const QStringList &parameters);
+
+private:
+    QString m_url;
+    int m_channels;
+    QString m_target;
+    int m_length;
+    QAtomicInt m_processedFrames;
+    void analyseSegment(int in, int out, LoudnessMeter *meter);
+
+signals:
+    /** @brief Measured values as clip properties, @param extra contains the normalization target if requested */
+    void gotLoudnessResults(const QString &id, const stringMap &results, const stringMap &extra);
+};
+
+#endif
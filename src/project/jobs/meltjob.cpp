@@ -256,6 +256,12 @@ stringMap MeltJob::cancelProperties()
     return props;
 }
 
+QList<AbstractClipJob::JOBTYPE> MeltJob::dependencies() const
+{
+    // Process the transcoded clip, not the one being replaced
+    return QList<JOBTYPE>() << TRANSCODEJOB;
+}
+
 const QString MeltJob::statusMessage()
 {
     QString statusInfo;
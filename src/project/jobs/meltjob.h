@@ -65,6 +65,7 @@ public:
     bool addClipToProject;
     /** @brief Returns a text string describing the job's current activity. */
     const QString statusMessage() Q_DECL_OVERRIDE;
+    QList<JOBTYPE> dependencies() const Q_DECL_OVERRIDE;
     /** @brief Sets the status for this job (can be used by the JobManager to abort the job). */
     void setStatus(ClipJobStatus status) Q_DECL_OVERRIDE;
     /** @brief Here we will send the current progress info to anyone interested. */
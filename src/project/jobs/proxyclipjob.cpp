@@ -36,6 +36,8 @@ ProxyJob::ProxyJob(ClipType cType, const QString &id, const QStringList &paramet
 {
     m_jobStatus = JobWaiting;
     description = i18n("proxy");
+    // Editing is slow until the proxy is ready
+    priority = HIGHPRIORITY;
     m_dest = parameters.at(0);
     m_src = parameters.at(1);
     m_exif = parameters.at(2).toInt();
@@ -105,9 +107,11 @@ void ProxyJob::startJob()
         // Ask for progress reporting
         mltParameters << QStringLiteral("progress=1");
 
+        QString exec = KdenliveSettings::rendererpath();
+        JobScheduler::lowerPriority(exec, mltParameters);
         m_jobProcess = new QProcess;
         m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
-        m_jobProcess->start(KdenliveSettings::rendererpath(), mltParameters);
+        m_jobProcess->start(exec, mltParameters);
         m_jobProcess->waitForStarted();
     } else if (clipType == Image) {
         m_isFfmpegJob = false;
@@ -196,9 +200,11 @@ void ProxyJob::startJob()
         // Make sure we don't block when proxy file already exists
         parameters << QStringLiteral("-y");
         parameters << m_dest;
+        QString exec = KdenliveSettings::ffmpegpath();
+        JobScheduler::lowerPriority(exec, parameters);
         m_jobProcess = new QProcess;
         m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
-        m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
+        m_jobProcess->start(exec, parameters, QIODevice::ReadOnly);
         m_jobProcess->waitForStarted();
     }
     while (m_jobProcess->state() != QProcess::NotRunning) {
@@ -174,6 +174,7 @@ void ProjectManager::newFile(bool showProjectSettings, bool force)
         documentProperties.insert(QStringLiteral("proxyparams"), w->proxyParams());
         documentProperties.insert(QStringLiteral("proxyextension"), w->proxyExtension());
         documentProperties.insert(QStringLiteral("generateimageproxy"), QString::number((int) w->generateImageProxy()));
+        documentProperties.insert(QStringLiteral("generateslowproxy"), QString::number((int) w->generateSlowProxy()));
         QString preview = w->selectedPreview();
         if (!preview.isEmpty()) {
             documentProperties.insert(QStringLiteral("previewparameters"), preview.section(QLatin1Char(';'), 0, 0));
@@ -732,6 +733,11 @@ void ProjectManager::slotExpandClip()
     m_trackView->projectView()->expandActiveClip();
 }
 
+void ProjectManager::slotFreezeClip()
+{
+    m_trackView->projectView()->freezeActiveClip();
+}
+
 void ProjectManager::disableBinEffects(bool disable)
 {
     if (m_project) {
@@ -108,6 +108,9 @@ public slots:
     /** @brief Expand current timeline clip (recover clips and tracks from an MLT playlist) */
     void slotExpandClip();
 
+    /** @brief Pre-render the active timeline clip with its effects, or unfreeze it. */
+    void slotFreezeClip();
+
     /** @brief Dis/enable all timeline effects */
     void slotDisableTimelineEffects(bool disable);
 
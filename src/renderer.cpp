@@ -69,7 +69,11 @@ Render::Render(Kdenlive::MonitorId rendererName, BinController *binController, G
     m_isLoopMode(false),
     m_blackClip(nullptr),
     m_isActive(false),
-    m_isRefreshing(false)
+    m_isRefreshing(false),
+    m_editDepth(0),
+    m_editRefreshPending(false),
+    m_editPurgePending(false),
+    m_editLengthPending(false)
 {
     qRegisterMetaType<stringMap> ("stringMap");
     analyseAudio = KdenliveSettings::monitor_audio();
@@ -892,6 +896,11 @@ void Render::seekToFrameDiff(int diff)
 
 void Render::doRefresh()
 {
+    if (m_editDepth > 0) {
+        // Refresh once when the edit transaction is committed
+        m_editRefreshPending = true;
+        return;
+    }
     if (m_mltProducer && (playSpeed() == 0) && m_isActive) {
         if (m_isRefreshing) {
             m_refreshTimer.start();
@@ -1091,6 +1100,11 @@ void Render::showAudio(Mlt::Frame &frame)
 
 void Render::mltCheckLength(Mlt::Tractor *tractor)
 {
+    if (m_editDepth > 0) {
+        // Track durations are checked once when the edit transaction is committed
+        m_editLengthPending = true;
+        return;
+    }
     int trackNb = tractor->count();
     int duration = 0;
     if (m_isZoneMode) {
@@ -1186,7 +1200,10 @@ Mlt::Tractor *Render::lockService()
         return nullptr;
     }
     QMutexLocker locker(&m_mutex);
-    if (m_mltConsumer) {
+    if (m_editDepth > 0) {
+        // Purge once when the edit transaction is committed
+        m_editPurgePending = true;
+    } else if (m_mltConsumer) {
         m_mltConsumer->purge();
     }
     Mlt::Service service(m_mltProducer->parent().get_service());
@@ -1214,6 +1231,60 @@ void Render::unlockService(Mlt::Tractor *tractor)
     service.unlock();
 }
 
+void Render::beginEdit()
+{
+    if (m_editDepth++ > 0) {
+        return;
+    }
+    m_editRefreshPending = false;
+    m_editPurgePending = false;
+    m_editLengthPending = false;
+    m_editTimer.start();
+}
+
+void Render::commitEdit()
+{
+    if (m_editDepth == 0) {
+        qCWarning(KDENLIVE_LOG) << "// Unbalanced edit transaction";
+        return;
+    }
+    if (--m_editDepth > 0) {
+        return;
+    }
+    qCDebug(KDENLIVE_LOG) << "// Edit transaction applied in" << m_editTimer.elapsed() << "ms";
+    if (!m_mltProducer) {
+        return;
+    }
+    if (m_editLengthPending) {
+        m_editLengthPending = false;
+        Mlt::Service service(m_mltProducer->parent().get_service());
+        if (service.type() == tractor_type) {
+            Mlt::Tractor tractor(service);
+            mltCheckLength(&tractor);
+        }
+    }
+    if (m_editPurgePending) {
+        m_editPurgePending = false;
+        QMutexLocker locker(&m_mutex);
+        if (m_mltConsumer) {
+            m_mltConsumer->purge();
+        }
+    }
+    if (m_editRefreshPending) {
+        m_editRefreshPending = false;
+        // Like the edits it replaces, also refresh during playback so no stale frame is shown
+        if (m_mltConsumer) {
+            m_isRefreshing = true;
+            m_mltConsumer->set("refresh", 1);
+        }
+    }
+}
+
+bool Render::isEditing() const
+{
+    return m_editDepth > 0;
+}
+
 void Render::mltInsertSpace(const QMap<int, int> &trackClipStartList, const QMap<int, int> &trackTransitionStartList, int track, const GenTime &duration, const GenTime &timeOffset)
 {
     if (!m_mltProducer) {
@@ -1360,6 +1431,10 @@ void Render::mltInsertSpace(const QMap<int, int> &trackClipStartList, const QMap
     }
     service.unlock();
     mltCheckLength(&tractor);
+    if (m_editDepth > 0) {
+        m_editRefreshPending = true;
+        return;
+    }
     m_isRefreshing = true;
     m_mltConsumer->set("refresh", 1);
 }
@@ -1393,6 +1468,10 @@ bool Render::mltResizeClipCrop(const ItemInfo &info, GenTime newCropStart)
     int frameOffset = newCropFrame - previousStart;
     trackPlaylist.resize_clip(clipIndex, newCropFrame, previousOut + frameOffset);
     service.unlock();
+    if (m_editDepth > 0) {
+        m_editRefreshPending = true;
+        return true;
+    }
     m_isRefreshing = true;
     m_mltConsumer->set("refresh", 1);
     return true;
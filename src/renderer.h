@@ -50,6 +50,7 @@
 #include <QMutex>
 #include <QSemaphore>
 #include <QTimer>
+#include <QElapsedTimer>
 
 class KComboBox;
 class BinController;
@@ -211,6 +212,15 @@ Q_OBJECT public:
     Mlt::Tractor *lockService();
     /** @brief Unlock the MLT service */
     void unlockService(Mlt::Tractor *tractor);
+    /** @brief Start a timeline edit transaction
+     *  The service is still locked only around each MLT change, but consumer purge,
+     *  timeline length check and refresh requests are deferred until commitEdit().
+     *  Transactions can be nested. */
+    void beginEdit();
+    /** @brief Close an edit transaction, check the length, purge and refresh once if requested meanwhile */
+    void commitEdit();
+    /** @brief Returns true if an edit transaction is in progress */
+    bool isEditing() const;
     const QString activeClipId();
     /** @brief Fill a combobox with the found blackmagic devices */
     static bool getBlackMagicDeviceList(KComboBox *devicelist, bool force = false);
@@ -286,6 +296,16 @@ private:
     bool m_isActive;
     /** @brief True if the consumer is currently refreshing itself. */
     bool m_isRefreshing;
+    /** @brief Nesting level of the current edit transaction. */
+    int m_editDepth;
+    /** @brief True if a refresh was requested during the current edit transaction. */
+    bool m_editRefreshPending;
+    /** @brief True if the service was locked for a change during the current edit transaction. */
+    bool m_editPurgePending;
+    /** @brief True if the timeline length must be checked when the current edit transaction ends. */
+    bool m_editLengthPending;
+    /** @brief Measures how long an edit transaction takes. */
+    QElapsedTimer m_editTimer;
     void closeMlt();
     QMap<QString, Mlt::Producer *> m_slowmotionProducers;
 
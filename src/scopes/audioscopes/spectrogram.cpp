@@ -38,6 +38,9 @@ Spectrogram::Spectrogram(QWidget *parent) :
     AbstractAudioScopeWidget(true, parent)
     , m_fftTools()
     , m_fftHistory()
+    , m_historyStride(0)
+    , m_historyStart(0)
+    , m_historyCount(0)
     , m_fftHistoryImg()
     , m_dBmin(-70)
     , m_dBmax(0)
@@ -337,19 +340,10 @@ QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, c
         ui->labelFFTSizeNumber->setText(QVariant(fftWindow).toString());
 
         if (newDataAvailable) {
-
-            float freqSpectrum[fftWindow / 2];
-
             // Get the spectral power distribution of the input samples,
-            // using the given window size and function
+            // using the given window size and function, directly into the history
             FFTTools::WindowType windowType = (FFTTools::WindowType) ui->windowFunction->itemData(ui->windowFunction->currentIndex()).toInt();
-            m_fftTools.fftNormalized(audioFrame, 0, num_channels, freqSpectrum, windowType, fftWindow, 0);
-
-            // This methid might be called also when a simple refresh is required.
-            // In this case there is no data to append to the history. Only append new data.
-            QVector<float> spectrumVector(fftWindow / 2);
-            memcpy(spectrumVector.data(), &freqSpectrum[0], fftWindow / 2 * sizeof(float));
-            m_fftHistory.prepend(spectrumVector);
+            m_fftTools.fftNormalized(audioFrame, 0, num_channels, appendHistoryRow(fftWindow / 2), windowType, fftWindow, 0);
         }
 #ifdef DEBUG_SPECTROGRAM
         else {
@@ -357,92 +351,49 @@ QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, c
         }
 #endif
 
-        // Limit the maximum history size to avoid wasting space
-        while (m_fftHistory.size() > SPECTROGRAM_HISTORY_SIZE) {
-            m_fftHistory.removeLast();
-        }
-
-        // Draw the spectrum
-        QImage spectrum(m_scopeRect.size(), QImage::Format_ARGB32);
-        spectrum.fill(qRgba(0, 0, 0, 0));
-        QPainter davinci(&spectrum);
-        const uint h = m_innerScopeRect.height();
-        const uint leftDist = m_innerScopeRect.left() - m_scopeRect.left();
-        const uint topDist = m_innerScopeRect.top() - m_scopeRect.top();
-        uint windowSize;
-        uint y;
+        const int h = m_innerScopeRect.height();
+        const int topDist = m_innerScopeRect.top() - m_scopeRect.top();
+        int lines = 0;
         bool completeRedraw = true;
 
         if (m_fftHistoryImg.size() == m_scopeRect.size() && !m_parameterChanged) {
             // The size of the widget and the parameters (like min/max dB) have not changed since last time,
-            // so we can re-use it, shift it by one pixel, and render the single remaining line. Usually about
-            // 10 times faster for a widget height of around 400 px.
-            if (newDataAvailable) {
-                davinci.drawImage(0, -1, m_fftHistoryImg);
-            } else {
-                // spectrum = m_fftHistoryImg does NOT work, leads to segfaults (anyone knows why, please tell me)
-                davinci.drawImage(0, 0, m_fftHistoryImg);
-            }
+            // so we can re-use it, shift it by one pixel, and render the single remaining line.
             completeRedraw = false;
-        }
-
-        y = 0;
-        if (newData || m_parameterChanged) {
-            m_parameterChanged = false;
-            bool peak = false;
-
-            QVector<float> dbMap;
-            uint right;
-            ////////////////FIXME
-            for (QList<QVector<float> >::iterator it = m_fftHistory.begin(); it != m_fftHistory.end(); ++it) {
-
-                windowSize = (*it).size();
-
-                // Interpolate the frequency data to match the pixel coordinates
-                right = ((float) m_freqMax) / (m_freq / 2) * (windowSize - 1);
-                dbMap = FFTTools::interpolatePeakPreserving((*it), m_innerScopeRect.width(), 0, right, -180);
-
-                for (int i = 0; i < dbMap.size(); ++i) {
-                    float val;
-                    val = dbMap[i];
-                    peak = val > m_dBmax;
-
-                    // Normalize dB value to [0 1], 1 corresponding to dbMax dB and 0 to dbMin dB
-                    val = (val - m_dBmax) / (m_dBmax - m_dBmin) + 1;
-                    if (val < 0) {
-                        val = 0;
-                    } else if (val > 1) {
-                        val = 1;
-                    }
-                    if (!peak || !m_aHighlightPeaks->isChecked()) {
-                        spectrum.setPixel(leftDist + i, topDist + h - 1 - y, m_colorMap[(int)(val * 255)]);
-                    } else {
-                        spectrum.setPixel(leftDist + i, topDist + h - 1 - y, AbstractScopeWidget::colHighlightDark.rgba());
-                    }
-                }
-
-                y++;
-                if (y >= topDist + m_innerScopeRect.height()) {
-                    break;
+            if (newDataAvailable) {
+                if (m_spareImg.size() != m_fftHistoryImg.size()) {
+                    m_spareImg = QImage(m_scopeRect.size(), QImage::Format_ARGB32);
                 }
-                if (!completeRedraw) {
-                    break;
+                // Scroll the lines of the scope, the borders are transparent in both images
+                const int bytes = m_fftHistoryImg.bytesPerLine();
+                for (int y = 0; y < m_spareImg.height(); ++y) {
+                    const int source = (y >= topDist && y < topDist + h - 1) ? y + 1 : y;
+                    memcpy(m_spareImg.scanLine(y), m_fftHistoryImg.constScanLine(source), bytes);
                 }
+                drawHistoryRow(m_spareImg, 0, 0);
+                lines = 1;
+                qSwap(m_spareImg, m_fftHistoryImg);
+            }
+        } else {
+            m_parameterChanged = false;
+            m_fftHistoryImg = QImage(m_scopeRect.size(), QImage::Format_ARGB32);
+            m_fftHistoryImg.fill(qRgba(0, 0, 0, 0));
+            m_spareImg = QImage();
+            for (; lines < m_historyCount && lines < h; ++lines) {
+                drawHistoryRow(m_fftHistoryImg, lines, lines);
             }
         }
+        QImage spectrum = m_fftHistoryImg;
 
 #ifdef DEBUG_SPECTROGRAM
-        qCDebug(KDENLIVE_LOG) << "Rendered " << y - topDist << "lines from " << m_fftHistory.size() << " available samples in " << start.elapsed() << " ms"
+        qCDebug(KDENLIVE_LOG) << "Rendered " << lines << "lines from " << m_historyCount << " available samples in " << start.elapsed() << " ms"
                               << (completeRedraw ? "" : " (re-used old image)");
-        uint storedBytes = 0;
-        for (QList< QVector<float> >::iterator it = m_fftHistory.begin(); it != m_fftHistory.end(); ++it) {
-            storedBytes += (*it).size() * sizeof((*it)[0]);
-        }
-        qCDebug(KDENLIVE_LOG) << QString("Total storage used: %1 kB").arg((double)storedBytes / 1000, 0, 'f', 2);
+        qCDebug(KDENLIVE_LOG) << QString("Total storage used: %1 kB").arg((double)m_fftHistory.size() * sizeof(float) / 1000, 0, 'f', 2);
+#else
+        Q_UNUSED(lines)
+        Q_UNUSED(completeRedraw)
 #endif
 
-        m_fftHistoryImg = spectrum;
-
         emit signalScopeRenderingFinished(start.elapsed(), 1);
         return spectrum;
     } else {
@@ -450,6 +401,56 @@ QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, c
         return QImage();
     }
 }
+float *Spectrogram::appendHistoryRow(int size)
+{
+    if (size > m_historyStride) {
+        // Larger FFT window, copy the history to longer rows
+        QVector<float> history(SPECTROGRAM_HISTORY_SIZE * size);
+        m_historySizes.resize(SPECTROGRAM_HISTORY_SIZE);
+        for (int row = 0; row < SPECTROGRAM_HISTORY_SIZE && m_historyStride > 0; ++row) {
+            memcpy(history.data() + row * size, m_fftHistory.constData() + row * m_historyStride, m_historySizes.at(row) * sizeof(float));
+        }
+        m_fftHistory = history;
+        m_historyStride = size;
+    }
+    m_historyStart = (m_historyStart + SPECTROGRAM_HISTORY_SIZE - 1) % SPECTROGRAM_HISTORY_SIZE;
+    m_historyCount = qMin(m_historyCount + 1, SPECTROGRAM_HISTORY_SIZE);
+    m_historySizes[m_historyStart] = size;
+    return m_fftHistory.data() + m_historyStart * m_historyStride;
+}
+
+void Spectrogram::drawHistoryRow(QImage &image, int index, int y)
+{
+    const int row = (m_historyStart + index) % SPECTROGRAM_HISTORY_SIZE;
+    const int windowSize = m_historySizes.at(row);
+    const int width = m_innerScopeRect.width();
+    const int leftDist = m_innerScopeRect.left() - m_scopeRect.left();
+    const int line = m_innerScopeRect.top() - m_scopeRect.top() + m_innerScopeRect.height() - 1 - y;
+    const bool highlightPeaks = m_aHighlightPeaks->isChecked();
+
+    // Interpolate the frequency data to match the pixel coordinates
+    const uint right = ((float) m_freqMax) / (m_freq / 2) * (windowSize - 1);
+    m_dbMap.resize(width);
+    FFTTools::interpolatePeakPreserving(m_fftHistory.constData() + row * m_historyStride, windowSize, m_dbMap.data(), width, 0, right, -180);
+
+    QRgb *pixels = reinterpret_cast<QRgb *>(image.scanLine(line)) + leftDist;
+    for (int i = 0; i < width; ++i) {
+        float val = m_dbMap.at(i);
+        if (highlightPeaks && val > m_dBmax) {
+            pixels[i] = AbstractScopeWidget::colHighlightDark.rgba();
+            continue;
+        }
+        // Normalize dB value to [0 1], 1 corresponding to dbMax dB and 0 to dbMin dB
+        val = (val - m_dBmax) / (m_dBmax - m_dBmin) + 1;
+        if (val < 0) {
+            val = 0;
+        } else if (val > 1) {
+            val = 1;
+        }
+        pixels[i] = m_colorMap[(int)(val * 255)];
+    }
+}
+
 QImage Spectrogram::renderBackground(uint)
 {
     return QImage();
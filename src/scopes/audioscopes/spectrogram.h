@@ -14,7 +14,8 @@
     The Spectrogram makes use of two caches:
     * A cached image where only the most recent line needs to be appended instead of
       having to recalculate the whole image. A typical speedup factor is 10x.
-    * A FFT cache storing a history of previous spectral power distributions (i.e.
+      The image of the previous frame is kept to scroll into, so that no image is allocated per frame.
+    * A FFT ring buffer storing a history of previous spectral power distributions (i.e.
       the Fourier-transformed audio signals). This is used if the user adjusts parameters
       like the maximum frequency to display or minimum/maximum signal strength in dB.
       All required information is preserved in the FFT history, which would not be the
@@ -62,8 +63,19 @@ private:
     QAction *m_aTrackMouse;
     QAction *m_aHighlightPeaks;
 
-    QList<QVector<float> > m_fftHistory;
+    /** Ring buffer of the FFT history, SPECTROGRAM_HISTORY_SIZE rows of m_historyStride values */
+    QVector<float> m_fftHistory;
+    /** Number of used values in each row of the history */
+    QVector<int> m_historySizes;
+    int m_historyStride;
+    /** Row of the most recent spectrum */
+    int m_historyStart;
+    int m_historyCount;
     QImage m_fftHistoryImg;
+    /** Image returned for the previous frame, drawn into for the next one */
+    QImage m_spareImg;
+    /** Interpolated dB values of the row being drawn */
+    QVector<float> m_dbMap;
 
     int m_dBmin;
     int m_dBmax;
@@ -76,6 +88,11 @@ private:
     QRect m_innerScopeRect;
     QRgb m_colorMap[256];
 
+    /** Returns the history row for a new spectrum of size values, growing the rows if needed. */
+    float *appendHistoryRow(int size);
+    /** Draws the history row at index (0 is the most recent) on line y of the scope. */
+    void drawHistoryRow(QImage &image, int index, int y);
+
 private slots:
     void slotResetMaxFreq();
 
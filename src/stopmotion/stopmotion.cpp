@@ -22,6 +22,7 @@
 #include "project/dialogs/slideshowclip.h"
 #include "dialogs/profilesdialog.h"
 #include "capture/mltdevicecapture.h"
+#include "capture/framewriter.h"
 #include "monitor/recmonitor.h"
 #include "monitor/monitormanager.h"
 #include "ui_smconfig_ui.h"
@@ -42,6 +43,7 @@
 #include <QMenu>
 #include <QtConcurrent>
 #include <QStandardPaths>
+#include <QImageWriter>
 
 MyLabel::MyLabel(QWidget *parent) :
     QLabel(parent)
@@ -317,7 +319,7 @@ StopmotionWidget::StopmotionWidget(MonitorManager *manager, const QUrl &projectF
     //m_captureDevice = new MltDeviceCapture(profilePath, m_monitor->videoSurface, this);
     m_captureDevice->sendFrameForAnalysis = KdenliveSettings::analyse_stopmotion();
     m_monitor->setRender(m_captureDevice);
-    connect(m_captureDevice, SIGNAL(frameSaved(QString)), this, SLOT(slotNewThumb(QString)));
+    connect(m_captureDevice, &MltDeviceCapture::frameSaved, this, &StopmotionWidget::slotNewThumb);
     */
 
     live_button->setChecked(false);
@@ -380,6 +382,15 @@ void StopmotionWidget::slotConfigure()
     ui.sm_prenotify->setChecked(KdenliveSettings::sm_prenotify());
     ui.sm_loop->setChecked(KdenliveSettings::sm_loop());
     ui.sm_framesplayback->setValue(KdenliveSettings::sm_framesplayback());
+    const QList<QByteArray> writableFormats = QImageWriter::supportedImageFormats();
+    const QStringList formats = QStringList() << QStringLiteral("png") << QStringLiteral("jpg") << QStringLiteral("tiff") << QStringLiteral("webp");
+    for (const QString &format : formats) {
+        if (writableFormats.contains(format.toLatin1())) {
+            ui.sm_imageformat->addItem(format.toUpper(), format);
+        }
+    }
+    ui.sm_imageformat->setCurrentIndex(qMax(0, ui.sm_imageformat->findData(KdenliveSettings::sm_imageformat())));
+    ui.sm_imagequality->setValue(KdenliveSettings::sm_imagequality());
 
     if (d.exec() == QDialog::Accepted) {
         KdenliveSettings::setSm_loop(ui.sm_loop->isChecked());
@@ -387,7 +398,12 @@ void StopmotionWidget::slotConfigure()
         KdenliveSettings::setSm_framesplayback(ui.sm_framesplayback->value());
         KdenliveSettings::setSm_notifytime(ui.sm_notifytime->value());
         KdenliveSettings::setSm_prenotify(ui.sm_prenotify->isChecked());
+        KdenliveSettings::setSm_imageformat(ui.sm_imageformat->currentData().toString());
+        KdenliveSettings::setSm_imagequality(ui.sm_imagequality->value());
         m_intervalTimer.setInterval(KdenliveSettings::captureinterval() * 1000);
+        if (m_captureDevice) {
+            m_captureDevice->frameWriter()->setQuality(KdenliveSettings::sm_imagequality());
+        }
     }
 }
 
@@ -438,13 +454,16 @@ void StopmotionWidget::parseExistingSequences()
     sequence_name->addItem(QString());
     QDir dir(m_projectFolder.toLocalFile());
     QStringList filters;
-    filters << QStringLiteral("*_0000.png");
+    filters << QStringLiteral("*_0000.*");
     //dir.setNameFilters(filters);
     const QStringList sequences = dir.entryList(filters, QDir::Files, QDir::Name);
     ////qCDebug(KDENLIVE_LOG)<<"PF: "<<<<", sm: "<<sequences;
+    QStringList names;
     for (const QString &sequencename : sequences) {
-        sequence_name->addItem(sequencename.section(QLatin1Char('_'), 0, -2));
+        names << sequencename.section(QLatin1Char('_'), 0, -2);
     }
+    names.removeDuplicates();
+    sequence_name->addItems(names);
 }
 
 void StopmotionWidget::slotSwitchLive()
@@ -491,7 +510,7 @@ void StopmotionWidget::slotLive(bool isOn)
             //m_captureDevice = new MltDeviceCapture(profilePath, m_monitor->videoSurface, this);
             m_captureDevice->sendFrameForAnalysis = KdenliveSettings::analyse_stopmotion();
             m_monitor->setRender(m_captureDevice);
-            connect(m_captureDevice, SIGNAL(frameSaved(QString)), this, SLOT(slotNewThumb(QString)));
+            connect(m_captureDevice, &MltDeviceCapture::frameSaved, this, &StopmotionWidget::slotNewThumb);
             }
 
             m_manager->activateMonitor(Kdenlive::StopMotionMonitor);
@@ -654,6 +673,17 @@ void StopmotionWidget::slotCaptureFrame()
         m_intervalTimer.stop();
         return;
     }
+    if (m_captureDevice->frameWriter()->isFull()) {
+        // Previous frames are still being written, try again a bit later
+        log_box->insertItem(-1, i18n("Waiting for frames to be written"));
+        log_box->setCurrentIndex(0);
+        if (capture_interval->isChecked()) {
+            QTimer::singleShot(500, this, &StopmotionWidget::slotCaptureFrame);
+        } else {
+            m_captureAction->setChecked(false);
+        }
+        return;
+    }
     QString currentPath = getPathForFrame(m_sequenceFrame);
     m_captureDevice->captureFrame(currentPath);
     KNotification::event(QStringLiteral("FrameCaptured"), i18n("Frame Captured"), QPixmap(), this);
@@ -676,19 +706,23 @@ void StopmotionWidget::slotPreNotify()
     }
 }
 
-void StopmotionWidget::slotNewThumb(const QString &path)
+void StopmotionWidget::slotNewThumb(const QString &path, const QImage &thumbnail)
 {
     if (!KdenliveSettings::showstopmotionthumbs()) {
         return;
     }
-    m_filesList.append(path);
     if (m_showOverlay->isChecked()) {
         reloadOverlay();
     }
+    if (!thumbnail.isNull() && !m_future.isRunning()) {
+        addThumbnail(thumbnail, SlideshowClip::getFrameNumberFromPath(QUrl::fromLocalFile(path)));
+        return;
+    }
+    // Thumbnails of older frames are still loading, keep the order
+    m_filesList.append(path);
     if (!m_future.isRunning()) {
         m_future = QtConcurrent::run(this, &StopmotionWidget::slotPrepareThumbs);
     }
-
 }
 
 void StopmotionWidget::slotPrepareThumbs()
@@ -703,10 +737,14 @@ void StopmotionWidget::slotPrepareThumbs()
 
 void StopmotionWidget::slotCreateThumbs(const QImage &img, int ix)
 {
-    if (img.isNull()) {
-        m_future = QtConcurrent::run(this, &StopmotionWidget::slotPrepareThumbs);
-        return;
+    if (!img.isNull()) {
+        addThumbnail(img, ix);
     }
+    m_future = QtConcurrent::run(this, &StopmotionWidget::slotPrepareThumbs);
+}
+
+void StopmotionWidget::addThumbnail(const QImage &img, int ix)
+{
     int height = 90;
     int width = height * img.width() / img.height();
     frame_list->setIconSize(QSize(width, height));
@@ -725,7 +763,6 @@ void StopmotionWidget::slotCreateThumbs(const QImage &img, int ix)
     frame_list->blockSignals(true);
     frame_list->setCurrentItem(item);
     frame_list->blockSignals(false);
-    m_future = QtConcurrent::run(this, &StopmotionWidget::slotPrepareThumbs);
 }
 
 QString StopmotionWidget::getPathForFrame(int ix, QString seqName)
@@ -733,7 +770,18 @@ QString StopmotionWidget::getPathForFrame(int ix, QString seqName)
     if (seqName.isEmpty()) {
         seqName = m_sequenceName;
     }
-    return m_projectFolder.toLocalFile() + QDir::separator() + seqName + QLatin1Char('_') + QString::number(ix).rightJustified(4, '0', false) + QStringLiteral(".png");
+    return m_projectFolder.toLocalFile() + QDir::separator() + seqName + QLatin1Char('_') + QString::number(ix).rightJustified(4, '0', false) + QLatin1Char('.') + sequenceExtension(seqName);
+}
+
+QString StopmotionWidget::sequenceExtension(const QString &seqName) const
+{
+    // An existing sequence keeps the format of its first frame
+    QDir dir(m_projectFolder.toLocalFile());
+    const QStringList first = dir.entryList(QStringList() << seqName + QStringLiteral("_0000.*"), QDir::Files);
+    if (!first.isEmpty()) {
+        return first.first().section(QLatin1Char('.'), -1);
+    }
+    return KdenliveSettings::sm_imageformat();
 }
 
 void StopmotionWidget::slotShowFrame(const QString &path)
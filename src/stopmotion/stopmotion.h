@@ -118,6 +118,12 @@ private:
     /** @brief Find all stopmotion sequences in current project folder. */
     void parseExistingSequences();
 
+    /** @brief File extension of the sequence frames, the configured format for a new sequence. */
+    QString sequenceExtension(const QString &seqName) const;
+
+    /** @brief Add a frame to the thumbnails list. */
+    void addThumbnail(const QImage &img, int ix);
+
     /** @brief This widget will hold the frame preview. */
     MyLabel *m_frame_preview;
 
@@ -216,8 +222,8 @@ private slots:
     /** @brief Show the config dialog */
     void slotConfigure();
 
-    /** @brief Prepare to crete thumb for newly captured frame. */
-    void slotNewThumb(const QString &path);
+    /** @brief Add the thumbnail of a newly captured frame, made when writing it. */
+    void slotNewThumb(const QString &path, const QImage &thumbnail);
 
     /** @brief Set the effect to be applied to overlay frame. */
     void slotUpdateOverlayEffect(QAction *act);
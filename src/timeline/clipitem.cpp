@@ -54,6 +54,8 @@ ClipItem::ClipItem(ProjectClip *clip, const ItemInfo &info, double fps, double s
     m_timeLine(nullptr),
     m_startThumbRequested(false),
     m_endThumbRequested(false),
+    m_generateThumbs(generateThumbs),
+    m_thumbsTracked(false),
     //m_hover(false),
     m_speed(speed),
     m_strobe(strobe),
@@ -92,9 +94,7 @@ ClipItem::ClipItem(ProjectClip *clip, const ItemInfo &info, double fps, double s
             m_endThumbTimer.setSingleShot(true);
             connect(&m_endThumbTimer, &QTimer::timeout, this, &ClipItem::slotGetEndThumb);
             connect(m_binClip, SIGNAL(thumbReady(int, QImage)), this, SLOT(slotThumbReady(int, QImage)));
-            if (generateThumbs && KdenliveSettings::videothumbnails()) {
-                QTimer::singleShot(0, this, &ClipItem::slotFetchThumbs);
-            }
+            // Thumbnails are fetched when the clip is first painted, see paint()
         }
     } else if (m_clipType == Color) {
         m_baseColor = m_binClip->getProducerColorProperty(QStringLiteral("resource"));
@@ -408,6 +408,21 @@ void ClipItem::slotFetchThumbs()
     }
 }
 
+void ClipItem::releaseThumbs()
+{
+    m_audioThumbCachePic.clear();
+    if (!m_hasThumbs) {
+        // Image and title thumbnails come from the bin clip, keep them
+        return;
+    }
+    m_startPix = QPixmap();
+    m_endPix = QPixmap();
+    // A pending request will be ignored, the next paint asks again
+    m_startThumbRequested = false;
+    m_endThumbRequested = false;
+    m_thumbsTracked = false;
+}
+
 void ClipItem::stopThumbs()
 {
     // Clip is about to be deleted, make sure we don't request thumbnails
@@ -616,6 +631,17 @@ void ClipItem::paint(QPainter *painter,
     }
     // draw thumbnails
     if (KdenliveSettings::videothumbnails() && m_clipState != PlaylistState::AudioOnly && m_originalClipState != PlaylistState::AudioOnly) {
+        if (m_generateThumbs && m_hasThumbs && (m_startPix.isNull() || m_endPix.isNull()) && !m_startThumbRequested && !m_endThumbRequested) {
+            // Clip is visible for the first time, or its thumbnails were released
+            m_startThumbRequested = m_startPix.isNull();
+            m_endThumbRequested = m_endPix.isNull();
+            QTimer::singleShot(0, this, &ClipItem::slotFetchThumbs);
+        }
+        if (!m_thumbsTracked && m_hasThumbs && (m_startThumbRequested || m_endThumbRequested || !m_startPix.isNull() || !m_endPix.isNull())) {
+            // Let the view release them once this clip leaves the visible area
+            m_thumbsTracked = true;
+            projectScene()->trackThumbs(this);
+        }
         QRectF thumbRect;
         if ((m_clipType == Image || m_clipType == Text || m_clipType == QText || m_clipType == TextTemplate) && !m_startPix.isNull()) {
             if (thumbRect.isNull()) {
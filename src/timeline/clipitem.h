@@ -178,6 +178,9 @@ public:
      * Which producer is returned depends on the type of this clip (audioonly, videoonly, normal) */
     //Mlt::Producer *getProducer(int track, bool trackSpecific = true);
     void resetFrameWidth(int width);
+    /** @brief Clip scrolled away from the view, free its video and audio thumbnails.
+     *  They are fetched again when the clip is painted. */
+    void releaseThumbs();
     /** @brief Clip is about to be deleted, block thumbs. */
     void stopThumbs();
 
@@ -227,6 +230,10 @@ private:
     QTimeLine *m_timeLine;
     bool m_startThumbRequested;
     bool m_endThumbRequested;
+    /** @brief Fetch video thumbnails when the clip is painted */
+    bool m_generateThumbs;
+    /** @brief Thumbnails were reported to the view, which releases them when the clip scrolls away */
+    bool m_thumbsTracked;
     //bool m_hover;
     double m_speed;
     int m_strobe;
@@ -114,3 +114,7 @@ TimelineMode::EditMode CustomTrackScene::editMode() const
     return m_editMode;
 }
 
+void CustomTrackScene::trackThumbs(ClipItem *clip)
+{
+    emit thumbsTracked(clip);
+}
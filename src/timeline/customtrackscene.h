@@ -34,6 +34,7 @@
 
 class Timeline;
 class MltVideoProfile;
+class ClipItem;
 
 class CustomTrackScene : public QGraphicsScene
 {
@@ -52,6 +53,8 @@ public:
     MltVideoProfile profile() const;
     void setEditMode(TimelineMode::EditMode mode);
     TimelineMode::EditMode editMode() const;
+    /** @brief A clip item requested video thumbnails while painting. */
+    void trackThumbs(ClipItem *clip);
     bool isZooming;
 
 private:
@@ -59,6 +62,10 @@ private:
     QPointF m_scale;
     TimelineMode::EditMode m_editMode;
     QList<GenTime> m_snapPoints;
+
+signals:
+    /** @brief Emitted when a clip item starts holding thumbnails, so that the view can release them later. */
+    void thumbsTracked(ClipItem *clip);
 };
 
 #endif
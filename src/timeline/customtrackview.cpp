@@ -36,6 +36,7 @@
 #include "renderer.h"
 #include "bin/projectclip.h"
 #include "mainwindow.h"
+#include "core.h"
 #include "transitionhandler.h"
 #include "project/clipmanager.h"
 #include "utils/KoIconUtils.h"
@@ -66,6 +67,7 @@
 #include <QScrollBar>
 #include <QApplication>
 #include <QMimeData>
+#include <QSet>
 
 #include <QGraphicsDropShadowEffect>
 
@@ -152,6 +154,14 @@ CustomTrackView::CustomTrackView(KdenliveDoc *doc, Timeline *timeline, CustomTra
     verticalScrollBar()->setTracking(true);
     // repaint guides when using vertical scroll
     connect(verticalScrollBar(), &QAbstractSlider::valueChanged, this, &CustomTrackView::slotRefreshGuides);
+    // Only clips near the view keep their thumbnails. Clips report when they paint
+    // thumbnails, the timer is not restarted so it also fires during continuous scrolling
+    m_visibleClipsTimer.setSingleShot(true);
+    m_visibleClipsTimer.setInterval(500);
+    connect(&m_visibleClipsTimer, &QTimer::timeout, this, &CustomTrackView::slotReleaseHiddenThumbs);
+    connect(verticalScrollBar(), &QAbstractSlider::valueChanged, this, &CustomTrackView::checkHiddenThumbs);
+    connect(horizontalScrollBar(), &QAbstractSlider::valueChanged, this, &CustomTrackView::checkHiddenThumbs);
+    connect(projectscene, &CustomTrackScene::thumbsTracked, this, &CustomTrackView::slotTrackThumbs);
 
     m_cursorLine = projectscene->addLine(0, 0, 0, m_tracksHeight);
     m_cursorLine->setZValue(1000);
@@ -4205,7 +4215,9 @@ void CustomTrackView::insertSpace(const QList<ItemInfo> &clipsToMove, const QLis
     foreach (AbstractGroupItem *grp, groupList) {
         rebuildGroup(grp);
     }
+    m_timeline->beginEdit();
     m_document->renderer()->mltInsertSpace(trackClipStartList, trackTransitionStartList, track, duration, offset);
+    m_timeline->commitEdit();
 }
 
 void CustomTrackView::deleteClip(const QString &clipId, QUndoCommand *deleteCommand)
@@ -4677,7 +4689,9 @@ void CustomTrackView::razorGroup(AbstractGroupItem *group, GenTime cutPos)
         }
         new GroupClipsCommand(this, clips1, transitions1, true, true, command);
         new GroupClipsCommand(this, clips2, transitions2, true, true, command);
+        m_timeline->beginEdit();
         m_commandStack->push(command);
+        m_timeline->commitEdit();
     }
 }
 
@@ -4866,6 +4880,10 @@ void CustomTrackView::addClip(const QString &clipId, const  ItemInfo &info, cons
         }
         emit displayMessage(QString(), InformationMessage);
     }
+    if (binClip->refCount() == 0 && !pCore->bin()->isLoading) {
+        // Pending proxy or analysis jobs on this clip are now more urgent, unless it was already used
+        pCore->bin()->boostClipJobs(clipId);
+    }
     QLocale locale;
     locale.setNumberOptions(QLocale::OmitGroupSeparator);
     // Get speed and strobe values from effects
@@ -5213,6 +5231,8 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
     // Group Items
     resetSelectionGroup();
     m_scene->clearSelection();
+    // Apply all playlist changes under a single lock, refresh once at the end
+    m_timeline->beginEdit();
     m_selectionMutex.lock();
     m_selectionGroup = new AbstractGroupItem(m_document->fps());
     scene()->addItem(m_selectionGroup);
@@ -5377,6 +5397,7 @@ void CustomTrackView::moveGroup(QList<ItemInfo> startClip, QList<ItemInfo> start
     } else {
         qCDebug(KDENLIVE_LOG) << "///////// WARNING; NO GROUP TO MOVE";
     }
+    m_timeline->commitEdit();
 }
 
 void CustomTrackView::moveTransition(const ItemInfo &start, const ItemInfo &end, bool refresh)
@@ -6310,6 +6331,40 @@ void CustomTrackView::setScale(double scaleFactor, double verticalScale, bool zo
     }
     m_currentToolManager->updateTimelineItems();
     m_scene->isZooming = false;
+    checkHiddenThumbs();
+}
+
+void CustomTrackView::checkHiddenThumbs()
+{
+    if (!m_visibleClipsTimer.isActive()) {
+        m_visibleClipsTimer.start();
+    }
+}
+
+void CustomTrackView::slotTrackThumbs(ClipItem *clip)
+{
+    m_thumbClips << clip;
+    checkHiddenThumbs();
+}
+
+void CustomTrackView::slotReleaseHiddenThumbs()
+{
+    // Keep one view of margin on each side, so that short scrolls do not refetch thumbnails
+    QRectF visible = mapToScene(viewport()->rect()).boundingRect();
+    visible.adjust(-visible.width(), -visible.height(), visible.width(), visible.height());
+    QList<QPointer<ClipItem> > nearClips;
+    for (const QPointer<ClipItem> &clip : m_thumbClips) {
+        if (!clip) {
+            continue;
+        }
+        if (clip->scene() && clip->sceneBoundingRect().intersects(visible)) {
+            nearClips << clip;
+        } else {
+            // The clip reports itself again when it is painted
+            clip->releaseThumbs();
+        }
+    }
+    m_thumbClips = nearClips;
 }
 
 void CustomTrackView::slotRefreshGuides()
@@ -6627,7 +6682,9 @@ void CustomTrackView::pasteClip()
     updateTrackDuration(-1, pasteClips);
     firstRefresh->updateRange(range);
     new RefreshMonitorCommand(this, range, true, false, pasteClips);
+    m_timeline->beginEdit();
     m_commandStack->push(pasteClips);
+    m_timeline->commitEdit();
 }
 
 void CustomTrackView::pasteClipEffects()
@@ -6820,6 +6877,16 @@ void CustomTrackView::expandActiveClip()
     emit importPlaylistClips(info, url, expandCommand);
 }
 
+void CustomTrackView::freezeActiveClip()
+{
+    AbstractClipItem *item = getActiveClipUnderCursor(true);
+    if (item == nullptr || item->type() != AVWidget) {
+        emit displayMessage(i18n("You must select one clip for this action"), ErrorMessage);
+        return;
+    }
+    m_timeline->freezeClip(static_cast < ClipItem *>(item));
+}
+
 void CustomTrackView::setInPoint()
 {
     AbstractClipItem *clip = getActiveClipUnderCursor(true);
@@ -7336,6 +7403,26 @@ void CustomTrackView::splitAudio(bool warn, const ItemInfo &info, int destTrack,
     }
 }
 
+AudioEnvelope *CustomTrackView::createAudioEnvelope(ClipItem *clip, int offset, int length, int track, int startPos)
+{
+    // The bin producer is only read, the track duplicates used by the timeline are left alone
+    Mlt::Producer *prod = m_document->renderer()->getBinProducer(clip->getBinId());
+    if (!prod) {
+        qCWarning(KDENLIVE_LOG) << "couldn't load producer for clip " << clip->getBinId() << " on track " << clip->track();
+        return nullptr;
+    }
+    AudioEnvelope *envelope = new AudioEnvelope(clip->binClip()->url(), prod, offset, length, track, startPos);
+    // Envelopes only depend on the clip file and the analysed zone, keep them for the next alignments
+    const QString clipHash = clip->binClip()->hash();
+    bool ok = false;
+    QDir audioFolder = m_document->getCacheDir(CacheAudio, &ok);
+    if (ok && !clipHash.isEmpty()) {
+        envelope->setCacheFile(audioFolder.absoluteFilePath(QStringLiteral("%1_%2_%3_%4_%5.envelope").arg(clipHash).arg(prod->get_int("audio_index"))
+                               .arg((int) m_document->fps()).arg(offset).arg(envelope->envelopeSize())));
+    }
+    return envelope;
+}
+
 void CustomTrackView::setAudioAlignReference()
 {
     QList<QGraphicsItem *> selection = scene()->selectedItems();
@@ -7351,15 +7438,14 @@ void CustomTrackView::setAudioAlignReference()
     if (selection.at(0)->type() == AVWidget) {
         ClipItem *clip = static_cast<ClipItem *>(selection.at(0));
         if (clip->clipType() == AV || clip->clipType() == Audio) {
-            m_audioAlignmentReference = clip;
-            Mlt::Producer *prod = m_timeline->track(clip->track())->clipProducer(m_document->renderer()->getBinProducer(clip->getBinId()), clip->clipState());
-            if (!prod) {
-                qCWarning(KDENLIVE_LOG) << "couldn't load producer for clip " << clip->getBinId() << " on track " << clip->track();
+            AudioEnvelope *envelope = createAudioEnvelope(clip);
+            if (!envelope) {
                 return;
             }
-            AudioEnvelope *envelope = new AudioEnvelope(clip->binClip()->url(), prod);
+            m_audioAlignmentReference = clip;
             m_audioCorrelator = new AudioCorrelation(envelope);
             connect(m_audioCorrelator, &AudioCorrelation::gotAudioAlignData, this, &CustomTrackView::slotAlignClip);
+            connect(m_audioCorrelator, &AudioCorrelation::gotBatchAlignData, this, &CustomTrackView::slotAlignClips);
             connect(m_audioCorrelator, &AudioCorrelation::displayMessage, this, &CustomTrackView::displayMessage);
             emit displayMessage(i18n("Processing audio, please wait."), ProcessingJobMessage);
         }
@@ -7385,6 +7471,7 @@ void CustomTrackView::alignAudio()
         return;
     }
 
+    QList<AudioEnvelope *> envelopes;
     QList<QGraphicsItem *> selection = scene()->selectedItems();
     foreach (QGraphicsItem *item, selection) {
         if (item->type() == AVWidget) {
@@ -7396,31 +7483,36 @@ void CustomTrackView::alignAudio()
 
             if (clip->clipType() == AV || clip->clipType() == Audio) {
                 ItemInfo info = clip->info();
-                Mlt::Producer *prod = m_timeline->track(clip->track())->clipProducer(m_document->renderer()->getBinProducer(clip->getBinId()), clip->clipState());
-                if (!prod) {
-                    qCWarning(KDENLIVE_LOG) << "couldn't load producer for clip " << clip->getBinId() << " on track " << clip->track();
+                AudioEnvelope *envelope = createAudioEnvelope(clip,
+                                          info.cropStart.frames(m_document->fps()),
+                                          info.cropDuration.frames(m_document->fps()),
+                                          clip->track(),
+                                          info.startPos.frames(m_document->fps()));
+                if (!envelope) {
+                    qDeleteAll(envelopes);
                     return;
                 }
-                AudioEnvelope *envelope = new AudioEnvelope(clip->binClip()->url(), prod,
-                        info.cropStart.frames(m_document->fps()),
-                        info.cropDuration.frames(m_document->fps()),
-                        clip->track(),
-                        info.startPos.frames(m_document->fps()));
-                m_audioCorrelator->addChild(envelope);
+                envelopes << envelope;
             }
         }
     }
+    if (envelopes.isEmpty()) {
+        return;
+    }
+    if (envelopes.count() == 1) {
+        m_audioCorrelator->addChild(envelopes.first());
+    } else {
+        m_audioCorrelator->addChildren(envelopes);
+    }
     emit displayMessage(i18n("Processing audio, please wait."), ProcessingJobMessage);
 }
 
-void CustomTrackView::slotAlignClip(int track, int pos, int shift)
+bool CustomTrackView::alignClip(int track, int pos, int shift, QUndoCommand *command)
 {
-    QUndoCommand *moveCommand = new QUndoCommand();
     ClipItem *clip = getClipItemAtStart(GenTime(pos, m_document->fps()), track);
     if (!clip) {
         emit displayMessage(i18n("Cannot find clip to align."), ErrorMessage);
-        delete moveCommand;
-        return;
+        return false;
     }
     GenTime add(shift, m_document->fps());
     ItemInfo start = clip->info();
@@ -7432,31 +7524,62 @@ void CustomTrackView::slotAlignClip(int track, int pos, int shift)
         // Clip would start before 0, so crop it first
         GenTime cropBy = -end.startPos;
         if (cropBy > start.cropDuration) {
-            delete moveCommand;
             emit displayMessage(i18n("Unable to move clip out of timeline."), ErrorMessage);
-            return;
+            return false;
+        }
+        end.startPos += cropBy;
+        if (itemCollision(clip, end)) {
+            emit displayMessage(i18n("Unable to move clip due to collision."), ErrorMessage);
+            return false;
         }
         ItemInfo resized = start;
         resized.startPos += cropBy;
 
         resizeClip(start, resized);
-        new ResizeClipCommand(this, start, resized, false, false, moveCommand);
+        new ResizeClipCommand(this, start, resized, false, false, command);
 
         start = clip->info();
-        end.startPos += cropBy;
+    } else if (itemCollision(clip, end)) {
+        emit displayMessage(i18n("Unable to move clip due to collision."), ErrorMessage);
+        return false;
     }
+    new MoveClipCommand(this, start, end, false, true, command);
+    updateTrackDuration(clip->track(), command);
+    return true;
+}
 
-    if (itemCollision(clip, end)) {
+void CustomTrackView::slotAlignClip(int track, int pos, int shift)
+{
+    QUndoCommand *moveCommand = new QUndoCommand();
+    moveCommand->setText(i18n("Auto-align clip"));
+    if (!alignClip(track, pos, shift, moveCommand)) {
         delete moveCommand;
-        emit displayMessage(i18n("Unable to move clip due to collision."), ErrorMessage);
         return;
     }
     emit displayMessage(i18n("Clip aligned."), OperationCompletedMessage);
-    moveCommand->setText(i18n("Auto-align clip"));
-    new MoveClipCommand(this, start, end, false, true, moveCommand);
-    updateTrackDuration(clip->track(), moveCommand);
     m_commandStack->push(moveCommand);
+}
 
+void CustomTrackView::slotAlignClips(const QList<AudioAlignment> &alignments)
+{
+    QUndoCommand *moveCommand = new QUndoCommand();
+    moveCommand->setText(i18np("Auto-align clip", "Auto-align %1 clips", alignments.count()));
+    int aligned = 0;
+    foreach (const AudioAlignment &alignment, alignments) {
+        if (alignClip(alignment.track, alignment.startPos, alignment.shift, moveCommand)) {
+            aligned++;
+        }
+    }
+    if (aligned == 0) {
+        delete moveCommand;
+        return;
+    }
+    if (aligned == alignments.count()) {
+        emit displayMessage(i18np("Clip aligned.", "%1 clips aligned.", aligned), OperationCompletedMessage);
+    } else {
+        emit displayMessage(i18n("%1 of %2 clips aligned.", aligned, alignments.count()), ErrorMessage);
+    }
+    m_commandStack->push(moveCommand);
 }
 
 bool CustomTrackView::doSplitAudio(const GenTime &pos, int track, int destTrack, bool split)
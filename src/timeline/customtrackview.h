@@ -27,6 +27,8 @@
 #include <QTimeLine>
 #include <QMenu>
 #include <QMutex>
+#include <QPointer>
+#include <QTimer>
 #include <QWaitCondition>
 
 #include "doc/kdenlivedoc.h"
@@ -42,6 +44,8 @@ class AbstractClipItem;
 class AbstractGroupItem;
 class Transition;
 class AudioCorrelation;
+class AudioEnvelope;
+struct AudioAlignment;
 class KSelectAction;
 
 class CustomTrackView : public QGraphicsView
@@ -157,7 +161,8 @@ public:
     /// Define which clip to take as reference for automatic audio alignment
     void setAudioAlignReference();
 
-    /// Automatically align the currently selected clips to synchronize their audio with the reference's audio
+    /// Automatically align the currently selected clips to synchronize their audio with the reference's audio.
+    /// Several clips are aligned in one undoable operation
     void alignAudio();
 
     /** @brief Separates the audio of a clip to a audio track.
@@ -238,6 +243,8 @@ public:
     int getPositionFromTrack(int track) const;
     /** @brief Expand current timeline clip (recover clips and tracks from an MLT playlist) */
     void expandActiveClip();
+    /** @brief Pre-render current timeline clip with its effects, or unfreeze it */
+    void freezeActiveClip();
     /** @brief Import amultitrack MLT playlist in timeline */
     void importPlaylist(const ItemInfo &info, const QMap<QString, QString> &idMap, const QDomDocument &doc, QUndoCommand *command);
     /** @brief Returns true if there is a selected item in timeline */
@@ -406,6 +413,7 @@ public slots:
 
     void slotInfoProcessingFinished();
     void slotAlignClip(int, int, int);
+    void slotAlignClips(const QList<AudioAlignment> &alignments);
     /** @brief Export part of the playlist in an xml file */
     void exportTimelineSelection(QString path = QString());
     /** Remove zone from current track */
@@ -455,6 +463,10 @@ private:
     QGraphicsItem *m_visualTip;
     QGraphicsItemAnimation *m_keyProperties;
     QTimeLine *m_keyPropertiesTimer;
+    /** @brief Started on scroll, zoom and thumbnail requests, releases the thumbnails of clips far from the view */
+    QTimer m_visibleClipsTimer;
+    /** @brief Clips that painted or requested thumbnails since they were last released */
+    QList<QPointer<ClipItem> > m_thumbClips;
     QColor m_tipColor;
     QPen m_tipPen;
     QPoint m_clickEvent;
@@ -520,6 +532,12 @@ private:
     AudioCorrelation *m_audioCorrelator;
     ClipItem *m_audioAlignmentReference;
 
+    /** @brief Build the envelope used to align the audio of a clip, cached in the project audio folder. */
+    AudioEnvelope *createAudioEnvelope(ClipItem *clip, int offset = 0, int length = 0, int track = 0, int startPos = 0);
+    /** @brief Add the commands moving the clip at pos on track by shift frames relative to the audio reference to command.
+     *  Returns false and shows a message if the clip cannot be moved. */
+    bool alignClip(int track, int pos, int shift, QUndoCommand *command);
+
     void updatePositionEffects(ClipItem *item, const ItemInfo &info, bool standalone = true);
     bool insertDropClips(const QMimeData *mimeData, const QPoint &pos);
     bool canBePastedTo(const QList<ItemInfo> &infoList, int type) const;
@@ -560,6 +578,12 @@ private:
 
 private slots:
     void slotRefreshGuides();
+    /** @brief Free thumbnails of the clips that left the view and its margin. */
+    void slotReleaseHiddenThumbs();
+    /** @brief Start m_visibleClipsTimer unless it is already pending. */
+    void checkHiddenThumbs();
+    /** @brief Remember a clip that holds thumbnails. */
+    void slotTrackThumbs(ClipItem *clip);
     void slotEditTimeLineGuide();
     void slotDeleteTimeLineGuide();
     void checkTrackSequence(int track);
@@ -0,0 +1,218 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "freezemanager.h"
+#include "../timeline.h"
+#include "../track.h"
+#include "../clipitem.h"
+#include "../customtrackview.h"
+#include "core.h"
+#include "bin/projectclip.h"
+#include "doc/kdenlivedoc.h"
+#include "kdenlivesettings.h"
+#include "mltcontroller/clipcontroller.h"
+#include "project/jobs/jobscheduler.h"
+
+#include "kdenlive_debug.h"
+#include <KLocalizedString>
+#include <QCryptographicHash>
+#include <QFile>
+
+FreezeManager::FreezeManager(KdenliveDoc *doc, Timeline *timeline) : QObject()
+    , m_doc(doc)
+    , m_timeline(timeline)
+    , m_process(nullptr)
+    , m_ticket(-1)
+{
+    connect(pCore->jobScheduler(), &JobScheduler::slotsAvailable, this, &FreezeManager::processRequests);
+}
+
+FreezeManager::~FreezeManager()
+{
+    abortRendering();
+}
+
+void FreezeManager::abortRendering()
+{
+    QString partFile;
+    if (!m_requests.isEmpty()) {
+        partFile = renderFile(m_requests.first().key) + QStringLiteral(".part");
+    }
+    for (const FreezeRequest &request : m_requests) {
+        QFile::remove(m_cacheDir.absoluteFilePath(request.key + QStringLiteral(".mlt")));
+    }
+    m_requests.clear();
+    if (m_process && m_process->state() != QProcess::NotRunning) {
+        m_process->kill();
+        m_process->waitForFinished();
+    }
+    if (m_ticket > -1) {
+        pCore->jobScheduler()->finish(m_ticket);
+        m_ticket = -1;
+    }
+    if (!partFile.isEmpty()) {
+        QFile::remove(partFile);
+    }
+}
+
+void FreezeManager::toggleFreeze(ClipItem *clip)
+{
+    const ItemInfo info = clip->info();
+    Track *track = m_timeline->track(info.track);
+    if (!track) {
+        return;
+    }
+    if (!track->frozenKey(info.startPos.seconds()).isEmpty()) {
+        track->thawClip(info.startPos.seconds());
+        m_timeline->projectView()->monitorRefresh(info);
+        m_doc->displayMessage(i18n("Clip effects are processed live again"), InformationMessage);
+        return;
+    }
+    if (clip->effectsCount() == 0) {
+        m_doc->displayMessage(i18n("Clip has no effect to freeze"), ErrorMessage);
+        return;
+    }
+    if (clip->clipState() == PlaylistState::AudioOnly || clip->clipState() == PlaylistState::Disabled) {
+        m_doc->displayMessage(i18n("Only clips with video can be frozen"), ErrorMessage);
+        return;
+    }
+    if (m_cacheDir == QDir()) {
+        bool ok;
+        QDir dir = m_doc->getCacheDir(CacheFreeze, &ok);
+        if (!ok && !dir.mkpath(QStringLiteral("."))) {
+            m_doc->displayMessage(i18n("Cannot create folder %1", dir.absolutePath()), ErrorMessage);
+            return;
+        }
+        m_cacheDir = dir;
+    }
+    const QString key = clipKey(clip);
+    if (QFile::exists(renderFile(key))) {
+        // Same content was already rendered
+        if (!applyRender(info, key)) {
+            m_doc->displayMessage(i18n("Cannot use frozen clip %1", renderFile(key)), ErrorMessage);
+        }
+        return;
+    }
+    for (const FreezeRequest &request : m_requests) {
+        if (request.key == key && request.info.startPos == info.startPos && request.info.track == info.track) {
+            return;
+        }
+    }
+    // Save the clip as it is now, later edits will not affect the render
+    if (!track->saveClip(info.startPos.seconds(), m_cacheDir.absoluteFilePath(key + QStringLiteral(".mlt")))) {
+        m_doc->displayMessage(i18n("Cannot save clip to freeze"), ErrorMessage);
+        return;
+    }
+    FreezeRequest request;
+    request.info = info;
+    request.key = key;
+    request.videoOnly = clip->clipState() == PlaylistState::VideoOnly;
+    m_requests << request;
+    m_doc->displayMessage(i18n("Freezing clip effects"), ProcessingJobMessage);
+    processRequests();
+}
+
+const QString FreezeManager::clipKey(ClipItem *clip) const
+{
+    const double fps = m_doc->fps();
+    QStringList content;
+    content << clip->binClip()->hash();
+    content << QString::number(clip->cropStart().frames(fps)) << QString::number(clip->cropDuration().frames(fps));
+    content << QString::number(clip->speed()) << QString::number(clip->strobe()) << QString::number((int) clip->clipState());
+    content << clip->effectList().toString(-1);
+    if (clip->binClip()->controller()) {
+        // Bin effects are applied to the rendered cut too
+        content << clip->binClip()->controller()->effectList().toString(-1);
+    }
+    return QString::fromLatin1(QCryptographicHash::hash(content.join(QLatin1Char('\n')).toUtf8(), QCryptographicHash::Md5).toHex());
+}
+
+const QString FreezeManager::renderFile(const QString &key) const
+{
+    return m_cacheDir.absoluteFilePath(key + QStringLiteral(".mov"));
+}
+
+bool FreezeManager::applyRender(const ItemInfo &info, const QString &key)
+{
+    ClipItem *clip = m_timeline->projectView()->getClipItemAtStart(info.startPos, info.track);
+    if (!clip || clipKey(clip) != key) {
+        // Clip was edited or moved during the render
+        return false;
+    }
+    Track *track = m_timeline->track(info.track);
+    if (!track || !track->freezeClip(info.startPos.seconds(), renderFile(key), key)) {
+        return false;
+    }
+    m_timeline->projectView()->monitorRefresh(info);
+    return true;
+}
+
+void FreezeManager::processRequests()
+{
+    if (m_requests.isEmpty() || (m_process && m_process->state() != QProcess::NotRunning)) {
+        return;
+    }
+    if (m_ticket == -1) {
+        m_ticket = pCore->jobScheduler()->enqueue(JobScheduler::CpuResource, i18n("Freeze clip"));
+    }
+    if (!pCore->jobScheduler()->tryStart(m_ticket)) {
+        // Wait for a free slot
+        return;
+    }
+    if (!m_process) {
+        m_process = new QProcess(this);
+        connect(m_process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, &FreezeManager::slotRenderFinished);
+    }
+    const FreezeRequest &request = m_requests.first();
+    // Intra frame codec, so that the frozen clip seeks as fast as the original
+    QStringList args;
+    args << m_cacheDir.absoluteFilePath(request.key + QStringLiteral(".mlt"));
+    args << QStringLiteral("-consumer") << QStringLiteral("avformat:") + renderFile(request.key) + QStringLiteral(".part");
+    args << QStringLiteral("f=mov") << QStringLiteral("vcodec=mjpeg") << QStringLiteral("qscale=2");
+    if (request.videoOnly) {
+        args << QStringLiteral("an=1");
+    } else {
+        args << QStringLiteral("acodec=pcm_s16le");
+    }
+    QString program = KdenliveSettings::rendererpath();
+    JobScheduler::lowerPriority(program, args);
+    m_process->start(program, args);
+}
+
+void FreezeManager::slotRenderFinished(int exitCode, QProcess::ExitStatus status)
+{
+    if (m_ticket > -1) {
+        pCore->jobScheduler()->finish(m_ticket);
+        m_ticket = -1;
+    }
+    if (m_requests.isEmpty()) {
+        return;
+    }
+    const FreezeRequest request = m_requests.takeFirst();
+    const QString file = renderFile(request.key);
+    QFile::remove(m_cacheDir.absoluteFilePath(request.key + QStringLiteral(".mlt")));
+    if (status != QProcess::NormalExit || exitCode != 0 || !QFile::rename(file + QStringLiteral(".part"), file)) {
+        qCDebug(KDENLIVE_LOG) << "// Freeze render failed: " << m_process->readAllStandardError();
+        QFile::remove(file + QStringLiteral(".part"));
+        m_doc->displayMessage(i18n("Cannot freeze clip effects"), ErrorMessage);
+    } else if (applyRender(request.info, request.key)) {
+        m_doc->displayMessage(i18n("Clip effects frozen"), OperationCompletedMessage);
+    }
+    processRequests();
+}
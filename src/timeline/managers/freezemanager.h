@@ -0,0 +1,83 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FREEZEMANAGER_H
+#define FREEZEMANAGER_H
+
+#include "definitions.h"
+
+#include <QDir>
+#include <QObject>
+#include <QProcess>
+
+class KdenliveDoc;
+class Timeline;
+class ClipItem;
+
+/**
+ * @class FreezeManager
+ * @brief Pre-renders timeline clips with their effects.
+ * A frozen clip plays a file rendered from its cut and effect stack instead of processing
+ * its effects on the fly. Renders are stored in the project cache, named after the bin clip
+ * hash, the clip crop, speed and effect stack, so that they are reused as long as the clip
+ * content does not change. The track restores the original cut as soon as the clip is edited
+ * or moved to another track, edits on other clips and moves within the track leave it frozen.
+ * The frozen state is not saved in the project: after reopening, clips play their live effects
+ * until frozen again, which reuses the render if the clip did not change.
+ */
+
+class FreezeManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FreezeManager(KdenliveDoc *doc, Timeline *timeline);
+    virtual ~FreezeManager();
+    /** @brief Freeze a clip, or restore its live effects if it is already frozen. */
+    void toggleFreeze(ClipItem *clip);
+    /** @brief Stop the current render and drop the waiting ones. */
+    void abortRendering();
+
+private:
+    struct FreezeRequest {
+        ItemInfo info;
+        QString key;
+        bool videoOnly;
+    };
+    KdenliveDoc *m_doc;
+    Timeline *m_timeline;
+    QDir m_cacheDir;
+    QProcess *m_process;
+    /** @brief The first request is the one being rendered */
+    QList<FreezeRequest> m_requests;
+    /** @brief Job scheduler ticket of the current render, -1 if none */
+    int m_ticket;
+    /** @brief Returns a key identifying the rendered content of the clip. */
+    const QString clipKey(ClipItem *clip) const;
+    const QString renderFile(const QString &key) const;
+    /** @brief Substitute the render in the track if the clip at info still has the same content. */
+    bool applyRender(const ItemInfo &info, const QString &key);
+
+private slots:
+    /** @brief Start the next render if the job scheduler has a free slot. */
+    void processRequests();
+    void slotRenderFinished(int exitCode, QProcess::ExitStatus status);
+};
+
+#endif
@@ -0,0 +1,235 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "playbackprefetcher.h"
+#include "../timeline.h"
+#include "../track.h"
+#include "kdenlivesettings.h"
+#include "kdenlive_debug.h"
+
+#include <QElapsedTimer>
+#include <QSet>
+#include <QtConcurrent>
+#include <algorithm>
+
+#include <mlt++/Mlt.h>
+
+// Maximum number of clips read in advance
+static const int maxWarmClips = 4;
+
+PlaybackPrefetcher::PlaybackPrefetcher(Timeline *timeline, Mlt::Tractor *tractor) : QObject()
+    , m_timeline(timeline)
+    , m_tractor(tractor)
+    , m_lastId(0)
+    , m_lastCheck(-1)
+    , m_warmed(0)
+    , m_reached(0)
+    , m_slowOpens(0)
+{
+}
+
+PlaybackPrefetcher::~PlaybackPrefetcher()
+{
+    stop();
+    m_thread.waitForFinished();
+}
+
+void PlaybackPrefetcher::positionChanged(int pos)
+{
+    if (KdenliveSettings::prefetchseconds() <= 0) {
+        return;
+    }
+    const int fps = qMax(1, (int)(m_tractor->get_fps() + 0.5));
+    if (m_lastCheck < 0) {
+        // Playback started
+        m_lastCheck = pos - fps;
+    }
+    m_mutex.lock();
+    for (int i = m_pool.count() - 1; i >= 0; --i) {
+        const WarmClip &clip = m_pool.at(i);
+        if (pos < clip.start) {
+            continue;
+        }
+        if (clip.warmTime >= 0 && pos - clip.start < fps) {
+            m_reached++;
+            // Opening the clip from disk took more than a frame
+            if (clip.warmTime > 1000 / fps) {
+                m_slowOpens++;
+            }
+        }
+        delete clip.cut;
+        m_pool.removeAt(i);
+    }
+    m_mutex.unlock();
+    if (qAbs(pos - m_lastCheck) < fps / 2) {
+        return;
+    }
+    m_lastCheck = pos;
+    lookAhead(pos);
+}
+
+void PlaybackPrefetcher::lookAhead(int pos)
+{
+    const int fps = qMax(1, (int)(m_tractor->get_fps() + 0.5));
+    const int limit = pos + KdenliveSettings::prefetchseconds() * fps;
+    QSet<mlt_producer> playing;
+    QList<WarmClip> candidates;
+    // Track 0 is the black background
+    for (int i = 1; i < m_timeline->tracksCount(); ++i) {
+        Track *tk = m_timeline->track(i);
+        if (!tk || tk->state() == 3) {
+            continue;
+        }
+        Mlt::Playlist &playlist = tk->playlist();
+        const int count = playlist.count();
+        for (int index = qMax(0, playlist.get_clip_index_at(pos)); index < count; ++index) {
+            const int start = playlist.clip_start(index);
+            if (start > limit) {
+                break;
+            }
+            if (playlist.is_blank(index)) {
+                continue;
+            }
+            Mlt::Producer *cut = playlist.get_clip(index);
+            if (!cut || !cut->is_valid()) {
+                delete cut;
+                continue;
+            }
+            if (start <= pos) {
+                playing << cut->parent().get_producer();
+                delete cut;
+                continue;
+            }
+            const QString service = QString::fromUtf8(cut->parent().get("mlt_service"));
+            if (!service.startsWith(QLatin1String("avformat"))) {
+                delete cut;
+                continue;
+            }
+            WarmClip clip;
+            clip.id = 0;
+            clip.cut = cut;
+            clip.service = service;
+            clip.resource = QString::fromUtf8(cut->parent().get("resource"));
+            clip.in = cut->get_in();
+            clip.track = i;
+            clip.start = start;
+            clip.warmTime = -1;
+            clip.started = false;
+            candidates << clip;
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const WarmClip &a, const WarmClip &b) {
+        return a.start < b.start;
+    });
+    QMutexLocker lock(&m_mutex);
+    for (const WarmClip &candidate : candidates) {
+        bool skip = m_pool.count() >= maxWarmClips || playing.contains(candidate.cut->parent().get_producer());
+        for (int i = 0; !skip && i < m_pool.count(); ++i) {
+            const WarmClip &clip = m_pool.at(i);
+            // Reading the same media twice is useless
+            skip = (clip.track == candidate.track && clip.start == candidate.start) || clip.cut->parent().get_producer() == candidate.cut->parent().get_producer();
+        }
+        if (skip) {
+            delete candidate.cut;
+            continue;
+        }
+        WarmClip clip = candidate;
+        clip.id = ++m_lastId;
+        m_pool << clip;
+    }
+    if (!m_thread.isRunning() && !m_pool.isEmpty()) {
+        m_thread = QtConcurrent::run(this, &PlaybackPrefetcher::doWarm);
+    }
+}
+
+void PlaybackPrefetcher::doWarm()
+{
+    Mlt::Profile profile(KdenliveSettings::current_profile().toUtf8().constData());
+    while (true) {
+        m_mutex.lock();
+        int id = -1;
+        QString service;
+        QString resource;
+        int in = 0;
+        for (int i = 0; i < m_pool.count(); ++i) {
+            WarmClip &clip = m_pool[i];
+            if (!clip.started) {
+                clip.started = true;
+                id = clip.id;
+                service = clip.service;
+                resource = clip.resource;
+                in = clip.in;
+                break;
+            }
+        }
+        m_mutex.unlock();
+        if (id < 0) {
+            return;
+        }
+        QElapsedTimer timer;
+        timer.start();
+        // The timeline producer must not be touched from this thread, a separate one
+        // reads the headers and the frames around the in point into the system cache
+        Mlt::Producer producer(profile, service.toUtf8().constData(), resource.toUtf8().constData());
+        if (producer.is_valid()) {
+            producer.seek(in);
+            Mlt::Frame *frame = producer.get_frame();
+            if (frame && frame->is_valid()) {
+                mlt_image_format format = mlt_image_yuv422;
+                int width = 0;
+                int height = 0;
+                frame->get_image(format, width, height);
+                mlt_audio_format audioFormat = mlt_audio_s16;
+                int frequency = 48000;
+                int channels = 2;
+                int samples = mlt_sample_calculator(producer.get_fps(), frequency, in);
+                frame->get_audio(audioFormat, frequency, channels, samples);
+            }
+            delete frame;
+        }
+        const qint64 elapsed = timer.elapsed();
+        QMutexLocker lock(&m_mutex);
+        for (int i = 0; i < m_pool.count(); ++i) {
+            if (m_pool.at(i).id == id) {
+                m_pool[i].warmTime = elapsed;
+                m_warmed++;
+                break;
+            }
+        }
+    }
+}
+
+void PlaybackPrefetcher::stop()
+{
+    if (m_lastCheck < 0) {
+        return;
+    }
+    m_lastCheck = -1;
+    QMutexLocker lock(&m_mutex);
+    for (const WarmClip &clip : m_pool) {
+        delete clip.cut;
+    }
+    m_pool.clear();
+    if (m_warmed > 0) {
+        qCDebug(KDENLIVE_LOG) << "Playback prefetch:" << m_warmed << "clips read," << m_reached << "reached in time," << m_slowOpens << "slow to open";
+    }
+    m_warmed = 0;
+    m_reached = 0;
+    m_slowOpens = 0;
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef PLAYBACKPREFETCHER_H
+#define PLAYBACKPREFETCHER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QFuture>
+
+class Timeline;
+
+namespace Mlt
+{
+class Producer;
+class Tractor;
+}
+
+/**
+ * @class PlaybackPrefetcher
+ * @brief Reads the next clips of the timeline in advance during playback.
+ * MLT opens and seeks the producer of a clip when playback reaches it, which shows as a hitch on
+ * long GOP media stored on slow disks. While playing, the clips starting within a few seconds of the
+ * cursor are opened and decoded once at their in point from a background thread, so that the container
+ * headers and the GOP around the in point are in the system cache when the playlist switches to them.
+ * The timeline producers are used by the consumer thread, so the clips are read with a separate producer
+ * that is deleted right after. Only a few clips are read ahead at a time.
+ */
+
+class PlaybackPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PlaybackPrefetcher(Timeline *timeline, Mlt::Tractor *tractor);
+    virtual ~PlaybackPrefetcher();
+    /** @brief Playback reached pos, warm the upcoming clips. */
+    void positionChanged(int pos);
+    /** @brief Playback stopped, forget the waiting clips and log statistics. */
+    void stop();
+
+private:
+    struct WarmClip {
+        int id;
+        /** @brief Only used from the GUI thread, to identify the timeline producer */
+        Mlt::Producer *cut;
+        /** @brief What the background thread opens, copied from the timeline producer */
+        QString service;
+        QString resource;
+        int in;
+        int track;
+        int start;
+        /** @brief Time taken to open and seek the separate producer, in ms, -1 if not done yet */
+        qint64 warmTime;
+        bool started;
+    };
+    Timeline *m_timeline;
+    Mlt::Tractor *m_tractor;
+    /** @brief Clips waiting to be reached by playback, guarded by m_mutex */
+    QList<WarmClip> m_pool;
+    QMutex m_mutex;
+    QFuture<void> m_thread;
+    int m_lastId;
+    /** @brief Position of the last lookahead, -1 when not playing */
+    int m_lastCheck;
+    /** @brief Statistics since last playback start */
+    int m_warmed;
+    int m_reached;
+    /** @brief Clips reached in time that took more than a frame to open */
+    int m_slowOpens;
+    /** @brief Background thread, reads the waiting clips of the pool. */
+    void doWarm();
+    /** @brief Look for clips starting after pos and add them to the pool. */
+    void lookAhead(int pos);
+};
+
+#endif
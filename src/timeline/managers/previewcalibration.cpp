@@ -0,0 +1,187 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include "previewcalibration.h"
+#include "kdenlive_debug.h"
+#include "mlt++/Mlt.h"
+
+#include <KConfig>
+#include <KConfigGroup>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QThread>
+
+// Length of the test clip, in seconds
+static const int CALIBRATION_LENGTH = 2;
+// Decoding must be this much faster than the project frame rate to play smoothly
+static const double REALTIME_MARGIN = 1.1;
+
+static QAtomicInt s_calibrationRunning;
+
+// Results are written from a thread, so don't use the cached shared config
+static const QString CALIBRATION_CONFIG = QStringLiteral("kdenlivecalibrationrc");
+
+static QString calibrationGroup()
+{
+    // Results only make sense on the computer that measured them
+    return QStringLiteral("Preview ") + QSysInfo::machineHostName();
+}
+
+QList<double> PreviewCalibration::storedSpeed(const QString &candidate, const QString &profilePath)
+{
+    KConfig config(CALIBRATION_CONFIG);
+    KConfigGroup group(&config, calibrationGroup());
+    const QStringList values = group.readEntry(profilePath + QLatin1Char('|') + candidate, QStringList());
+    QList<double> result;
+    if (values.count() == 2) {
+        result << values.at(0).toDouble() << values.at(1).toDouble();
+    }
+    return result;
+}
+
+QString PreviewCalibration::bestProfile(const QStringList &candidates, const QString &profilePath, double fps)
+{
+    QString bestEncoder;
+    double bestEncodeSpeed = 0;
+    QString bestDecoder;
+    double bestDecodeSpeed = 0;
+    for (const QString &candidate : candidates) {
+        const QList<double> speed = storedSpeed(candidate, profilePath);
+        if (speed.isEmpty()) {
+            return QString();
+        }
+        if (speed.at(1) >= fps * REALTIME_MARGIN && speed.at(0) > bestEncodeSpeed) {
+            bestEncodeSpeed = speed.at(0);
+            bestEncoder = candidate;
+        }
+        if (speed.at(1) > bestDecodeSpeed) {
+            bestDecodeSpeed = speed.at(1);
+            bestDecoder = candidate;
+        }
+    }
+    return bestEncoder.isEmpty() ? bestDecoder : bestEncoder;
+}
+
+bool PreviewCalibration::calibrate(const QStringList &candidates, const QString &profilePath, double fps)
+{
+    if (!s_calibrationRunning.testAndSetAcquire(0, 1)) {
+        return false;
+    }
+    for (const QString &candidate : candidates) {
+        if (!storedSpeed(candidate, profilePath).isEmpty()) {
+            continue;
+        }
+        QList<double> speed = measure(candidate, profilePath, fps);
+        QStringList values;
+        // A failed profile is stored as unusable so that it is not measured again
+        values << QString::number(speed.value(0)) << QString::number(speed.value(1));
+        KConfig config(CALIBRATION_CONFIG);
+        KConfigGroup group(&config, calibrationGroup());
+        group.writeEntry(profilePath + QLatin1Char('|') + candidate, values);
+        config.sync();
+        qCDebug(KDENLIVE_LOG) << "Preview profile" << candidate << "encodes at" << speed.value(0) << "fps, decodes at" << speed.value(1) << "fps";
+    }
+    s_calibrationRunning.storeRelease(0);
+    return true;
+}
+
+QList<double> PreviewCalibration::measure(const QString &candidate, const QString &profilePath, double fps)
+{
+    QList<double> result;
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return result;
+    }
+    const QString extension = candidate.section(QLatin1Char(';'), 1, 1);
+    const QString testFile = dir.path() + QStringLiteral("/calibration.") + extension;
+    const int frames = qMax(10, (int)(CALIBRATION_LENGTH * fps));
+
+    // Encode in process, a melt process would mostly measure its own startup on such a short clip
+    Mlt::Profile profile(profilePath.toUtf8().constData());
+    // Noise is the worst case for all codecs, so a profile passing this test is safe
+    Mlt::Producer noise(profile, nullptr, "noise:");
+    if (!noise.is_valid()) {
+        return result;
+    }
+    noise.set_in_and_out(0, frames - 1);
+    Mlt::Consumer encoder(profile, "avformat", testFile.toUtf8().constData());
+    if (!encoder.is_valid()) {
+        return result;
+    }
+    // Same parameters as PreviewManager, frame rate and size come from the profile
+    const QStringList params = candidate.section(QLatin1Char(';'), 0, 0).split(QLatin1Char(' '), QString::SkipEmptyParts);
+    for (const QString &param : params) {
+        if (!param.startsWith(QLatin1String("r=")) && !param.startsWith(QLatin1String("s="))) {
+            encoder.set(param.section(QLatin1Char('='), 0, 0).toUtf8().constData(), param.section(QLatin1Char('='), 1).toUtf8().constData());
+        }
+    }
+    encoder.set("an", 1);
+    encoder.set("real_time", -1);
+    encoder.set("terminate_on_pause", 1);
+    encoder.connect(noise);
+    QElapsedTimer timer;
+    timer.start();
+    if (encoder.start() != 0) {
+        qCDebug(KDENLIVE_LOG) << "Preview calibration failed for" << candidate;
+        return result;
+    }
+    while (!encoder.is_stopped()) {
+        if (timer.elapsed() > 60000) {
+            qCDebug(KDENLIVE_LOG) << "Preview calibration timed out for" << candidate;
+            encoder.stop();
+            return result;
+        }
+        QThread::msleep(10);
+    }
+    const qint64 elapsed = timer.elapsed();
+    encoder.stop();
+    if (QFileInfo(testFile).size() <= 0) {
+        qCDebug(KDENLIVE_LOG) << "Preview calibration failed for" << candidate;
+        return result;
+    }
+    result << frames * 1000.0 / qMax((qint64) 1, elapsed);
+
+    Mlt::Producer producer(profile, nullptr, testFile.toUtf8().constData());
+    if (!producer.is_valid()) {
+        result << 0.;
+        return result;
+    }
+    const int length = producer.get_playtime();
+    int decoded = 0;
+    timer.restart();
+    for (int i = 0; i < length; ++i) {
+        producer.seek(i);
+        Mlt::Frame *frame = producer.get_frame();
+        if (frame == nullptr || !frame->is_valid()) {
+            delete frame;
+            break;
+        }
+        mlt_image_format format = mlt_image_yuv422;
+        int width = profile.width();
+        int height = profile.height();
+        frame->get_image(format, width, height);
+        delete frame;
+        decoded++;
+    }
+    result << decoded * 1000.0 / qMax((qint64) 1, timer.elapsed());
+    return result;
+}
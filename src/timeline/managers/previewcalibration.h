@@ -0,0 +1,53 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef PREVIEWCALIBRATION_H
+#define PREVIEWCALIBRATION_H
+
+#include <QStringList>
+
+/**
+ * @class PreviewCalibration
+ * @brief Measures the timeline preview encoding profiles on this computer.
+ * Each candidate profile renders a short synthetic clip, then the result is decoded.
+ * Encoding and decoding speeds are stored in the configuration for this host, so that
+ * the calibration only runs once per project format.
+ */
+
+class PreviewCalibration
+{
+public:
+    /** @brief Returns the fastest candidate to encode that still decodes in real time, or the fastest to decode
+     *  if none does. Returns an empty string if some candidates were never measured on this computer.
+     *  @param candidates the preview profiles, in "parameters;extension" format
+     *  @param profilePath the MLT profile of the project
+     *  @param fps the project frame rate */
+    static QString bestProfile(const QStringList &candidates, const QString &profilePath, double fps);
+    /** @brief Measure the candidates that were never measured. This is slow, call it from a thread
+     *  holding a job scheduler slot. Returns false if another calibration is already running. */
+    static bool calibrate(const QStringList &candidates, const QString &profilePath, double fps);
+
+private:
+    /** @brief Encoding and decoding speed in frames per second, empty if not measured */
+    static QList<double> storedSpeed(const QString &candidate, const QString &profilePath);
+    /** @brief Render and decode a test clip, returns encoding and decoding speed */
+    static QList<double> measure(const QString &candidate, const QString &profilePath, double fps);
+};
+
+#endif
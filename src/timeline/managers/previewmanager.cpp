@@ -26,12 +26,15 @@
 #include <QtConcurrent>
 #include <QStandardPaths>
 #include <QProcess>
+#include <QTemporaryDir>
 
 PreviewManager::PreviewManager(KdenliveDoc *doc, CustomRuler *ruler, Mlt::Tractor *tractor) : QObject()
     , m_doc(doc)
     , m_ruler(ruler)
     , m_tractor(tractor)
     , m_previewTrack(nullptr)
+    , m_ramDir(nullptr)
+    , m_ramPreview(false)
     , m_initialized(false)
     , m_abortPreview(false)
 {
@@ -46,6 +49,7 @@ PreviewManager::~PreviewManager()
         if (m_undoDir.dirName() == QLatin1String("undo")) {
             m_undoDir.removeRecursively();
         }
+        m_cacheDir = m_diskCacheDir;
         if ((m_doc->url().isEmpty() && m_cacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot).isEmpty()) || m_cacheDir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot).isEmpty()) {
             if (m_cacheDir.dirName() == QLatin1String("preview")) {
                 m_cacheDir.removeRecursively();
@@ -53,6 +57,7 @@ PreviewManager::~PreviewManager()
         }
     }
     delete m_previewTrack;
+    delete m_ramDir;
 }
 
 bool PreviewManager::initialize()
@@ -75,6 +80,7 @@ bool PreviewManager::initialize()
         m_doc->displayMessage(i18n("Something is wrong with cache folder %1", m_cacheDir.absolutePath()), ErrorMessage);
         return false;
     }
+    m_diskCacheDir = m_cacheDir;
     if (!loadParams()) {
         m_doc->displayMessage(i18n("Invalid timeline preview parameters"), ErrorMessage);
         return false;
@@ -94,6 +100,7 @@ bool PreviewManager::initialize()
     connect(&m_previewTimer, &QTimer::timeout, this, &PreviewManager::startPreviewRender);
     connect(this, &PreviewManager::previewRender, this, &PreviewManager::gotPreviewRender);
     connect(&m_previewGatherTimer, &QTimer::timeout, this, &PreviewManager::slotProcessDirtyChunks);
+    connect(this, &PreviewManager::memoryFull, this, &PreviewManager::slotMemoryFull);
     m_initialized = true;
     return true;
 }
@@ -179,6 +186,33 @@ void PreviewManager::disconnectTrack()
 
 bool PreviewManager::loadParams()
 {
+    m_ramPreview = false;
+    m_cacheDir = m_diskCacheDir;
+    if (KdenliveSettings::rampreview()) {
+        if (m_ramDir == nullptr) {
+            // Prefer a memory backed file system
+            QString base = QStringLiteral("/dev/shm");
+            if (!QFileInfo(base).isWritable()) {
+                base = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+            }
+            m_ramDir = new QTemporaryDir(base + QStringLiteral("/kdenlive-preview-XXXXXX"));
+        }
+        if (m_ramDir->isValid()) {
+            m_ramPreview = true;
+            m_cacheDir = QDir(m_ramDir->path());
+            // Intra frame codecs, so that playback only decodes the displayed frames
+            if (KdenliveSettings::rampreviewraw()) {
+                m_extension = QStringLiteral("nut");
+                m_consumerParams = QStringList() << QStringLiteral("f=nut") << QStringLiteral("vcodec=rawvideo") << QStringLiteral("pix_fmt=yuyv422");
+            } else {
+                m_extension = QStringLiteral("avi");
+                m_consumerParams = QStringList() << QStringLiteral("f=avi") << QStringLiteral("vcodec=mjpeg") << QStringLiteral("qscale=2");
+            }
+            m_consumerParams << QStringLiteral("an=1");
+            return true;
+        }
+        m_doc->displayMessage(i18n("Cannot create memory preview folder, using project cache"), InformationMessage);
+    }
     m_extension = m_doc->getDocumentProperty(QStringLiteral("previewextension"));
     m_consumerParams = m_doc->getDocumentProperty(QStringLiteral("previewparameters")).split(QLatin1Char(' '), QString::SkipEmptyParts);
 
@@ -213,6 +247,17 @@ void PreviewManager::invalidatePreviews(const QList<int> &chunks)
         m_previewTimer.stop();
         timer = true;
     }
+    if (m_ramPreview) {
+        // No undo history in memory, only drop the invalidated chunks
+        foreach (int i, chunks) {
+            m_cacheDir.remove(QStringLiteral("%1.%2").arg(i).arg(m_extension));
+        }
+        m_doc->setModified(true);
+        if (timer) {
+            m_previewTimer.start();
+        }
+        return;
+    }
     int stackIx = m_doc->commandStack()->index();
     int stackMax = m_doc->commandStack()->count();
     if (stackIx == stackMax && !m_undoDir.exists(QString::number(stackIx - 1))) {
@@ -431,6 +476,12 @@ void PreviewManager::doPreviewRender(const QString &scene)
             emit previewRender(i, m_cacheDir.absoluteFilePath(fileName), progress);
             continue;
         }
+        if (m_ramPreview && ramUsage() >= (qint64) KdenliveSettings::rampreviewsize() * 1024 * 1024) {
+            m_waitingThumbs.clear();
+            emit previewRender(0, QString(), 1000);
+            emit memoryFull();
+            break;
+        }
         // Build rendering process
         QStringList args;
         args << scene;
@@ -477,6 +528,45 @@ void PreviewManager::slotProcessDirtyChunks()
     }
 }
 
+qint64 PreviewManager::ramUsage() const
+{
+    qint64 size = 0;
+    const QFileInfoList files = m_cacheDir.entryInfoList(QDir::Files);
+    for (const QFileInfo &file : files) {
+        size += file.size();
+    }
+    return size;
+}
+
+void PreviewManager::slotMemoryFull()
+{
+    m_doc->displayMessage(i18n("Memory preview limit reached (%1 MB), reduce the preview zone", KdenliveSettings::rampreviewsize()), InformationMessage);
+}
+
+bool PreviewManager::setRamPreview(bool enable)
+{
+    if (enable == m_ramPreview) {
+        return true;
+    }
+    abortRendering();
+    // Files of the previous storage are not invalidated anymore, remove them and render the zones again
+    QList<int> chunks = m_ruler->getProcessedChunks();
+    chunks << m_ruler->getDirtyChunks();
+    clearPreviewRange();
+    if (!loadParams()) {
+        return false;
+    }
+    if (!chunks.isEmpty()) {
+        qSort(chunks);
+        m_ruler->addChunks(chunks, true);
+        m_ruler->update();
+        if (KdenliveSettings::autopreview()) {
+            m_previewTimer.start();
+        }
+    }
+    return true;
+}
+
 void PreviewManager::slotRemoveInvalidUndo(int ix)
 {
     QMutexLocker lock(&m_previewMutex);
@@ -29,6 +29,7 @@
 
 class KdenliveDoc;
 class CustomRuler;
+class QTemporaryDir;
 
 namespace Mlt
 {
@@ -44,6 +45,8 @@ class Playlist;
  * This allow us to get a preview with a smooth playback of our project.
  * Only the preview zone is rendered. Once defined, a preview zone shows as a red line below
  * the timeline ruler. As chunks are rendered, the zone turns to green.
+ * In memory mode, chunks are stored with an intra-frame codec in a memory backed folder,
+ * limited in size, for zones that are played many times.
  */
 
 class PreviewManager : public QObject
@@ -79,6 +82,8 @@ public:
     const QDir getCacheDir() const;
     /** @brief: Load existing ruler chunks. */
     void loadChunks(const QStringList &previewChunks, QStringList dirtyChunks, const QDateTime &documentDate);
+    /** @brief: Switch between disk and memory storage, all rendered chunks become dirty. */
+    bool setRamPreview(bool enable);
 
 private:
     KdenliveDoc *m_doc;
@@ -87,6 +92,11 @@ private:
     Mlt::Playlist *m_previewTrack;
     /** @brief: The directory used to store the preview files. */
     QDir m_cacheDir;
+    /** @brief: The preview folder in project cache, used when not in memory mode. */
+    QDir m_diskCacheDir;
+    /** @brief: Memory backed folder for memory mode, nullptr if not used. */
+    QTemporaryDir *m_ramDir;
+    bool m_ramPreview;
     /** @brief: The directory used to store undo history of preview files (child of m_cacheDir). */
     QDir m_undoDir;
     QMutex m_previewMutex;
@@ -102,6 +112,8 @@ private:
     QFuture <void> m_previewThread;
     /** @brief: After an undo/redo, if we have preview history, use it. */
     void reloadChunks(const QList<int> &chunks);
+    /** @brief: Size of the preview files in memory mode, in bytes. */
+    qint64 ramUsage() const;
 
 private slots:
     /** @brief: To avoid filling the hard drive, remove preview undo history after 5 steps. */
@@ -112,6 +124,8 @@ private slots:
     void slotRemoveInvalidUndo(int ix);
     /** @brief: When the timer collecting invalid zones is done, process. */
     void slotProcessDirtyChunks();
+    /** @brief: Memory preview reached its size limit. */
+    void slotMemoryFull();
 
 public slots:
     /** @brief: Prepare and start rendering. */
@@ -123,6 +137,7 @@ signals:
     void abortPreview();
     void cleanupOldPreviews();
     void previewRender(int frame, const QString &file, int progress);
+    void memoryFull();
 };
 
 #endif
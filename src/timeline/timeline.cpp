@@ -40,6 +40,8 @@
 #include "effectslist/initeffects.h"
 #include "mltcontroller/effectscontroller.h"
 #include "managers/previewmanager.h"
+#include "managers/freezemanager.h"
+#include "managers/playbackprefetcher.h"
 #include "managers/trimmanager.h"
 
 #include <QScrollBar>
@@ -49,6 +51,7 @@
 #include <KMessageBox>
 #include <KIO/FileCopyJob>
 #include <klocalizedstring.h>
+#include <algorithm>
 
 ScrollEventEater::ScrollEventEater(QObject *parent) : QObject(parent)
 {
@@ -77,6 +80,8 @@ Timeline::Timeline(KdenliveDoc *doc, const QList<QAction *> &actions, const QLis
     , m_doc(doc)
     , m_verticalZoom(1)
     , m_timelinePreview(nullptr)
+    , m_freezeManager(nullptr)
+    , m_prefetcher(nullptr)
     , m_usePreview(false)
 {
     m_trackActions << actions;
@@ -176,13 +181,17 @@ Timeline::Timeline(KdenliveDoc *doc, const QList<QAction *> &actions, const QLis
     splitter->restoreState(QByteArray::fromBase64(KdenliveSettings::timelineheaderwidth().toUtf8()));
     QAction *previewRender = m_doc->getAction(QStringLiteral("prerender_timeline_zone"));
     previewRender->setEnabled(true);
+    m_freezeManager = new FreezeManager(m_doc, this);
+    m_prefetcher = new PlaybackPrefetcher(this, m_tractor);
 }
 
 Timeline::~Timeline()
 {
+    delete m_prefetcher;
     if (m_timelinePreview) {
         delete m_timelinePreview;
     }
+    delete m_freezeManager;
     delete m_ruler;
     delete m_trackview;
     delete m_scene;
@@ -229,6 +238,44 @@ Track *Timeline::track(int i)
     return m_tracks.at(i);
 }
 
+void Timeline::beginEdit()
+{
+    m_doc->renderer()->beginEdit();
+    for (Track *tk : m_tracks) {
+        tk->beginEdit();
+    }
+}
+
+void Timeline::commitEdit()
+{
+    for (int i = m_tracks.count() - 1; i >= 0; --i) {
+        m_tracks.at(i)->commitEdit();
+    }
+    m_doc->renderer()->commitEdit();
+    if (m_doc->renderer()->isEditing()) {
+        return;
+    }
+    if (m_pendingInvalidations.isEmpty() || !m_timelinePreview) {
+        m_pendingInvalidations.clear();
+        return;
+    }
+    // Invalidate the preview once per distinct zone touched by the transaction
+    std::sort(m_pendingInvalidations.begin(), m_pendingInvalidations.end(), [](const QPoint &a, const QPoint &b) {
+        return a.x() < b.x();
+    });
+    QPoint zone = m_pendingInvalidations.takeFirst();
+    for (const QPoint &range : m_pendingInvalidations) {
+        if (range.x() > zone.y()) {
+            m_timelinePreview->invalidatePreview(zone.x(), zone.y());
+            zone = range;
+        } else {
+            zone.setY(qMax(zone.y(), range.y()));
+        }
+    }
+    m_timelinePreview->invalidatePreview(zone.x(), zone.y());
+    m_pendingInvalidations.clear();
+}
+
 int Timeline::tracksCount() const
 {
     return m_tractor->count() - m_hasOverlayTrack - m_usePreview;
@@ -604,6 +651,11 @@ void Timeline::setCursorPos(int pos)
 void Timeline::moveCursorPos(int pos)
 {
     m_trackview->setCursorPos(pos);
+    if (m_doc->renderer()->isPlaying()) {
+        m_prefetcher->positionChanged(pos);
+    } else {
+        m_prefetcher->stop();
+    }
 }
 
 void Timeline::slotChangeZoom(int horizontal, int vertical, bool zoomOnMouse)
@@ -1409,6 +1461,8 @@ bool Timeline::moveClip(int startTrack, qreal startPos, int endTrack, qreal endP
         return track(startTrack)->move(startPos, endPos, mode);
     }
     Track *sourceTrack = track(startTrack);
+    // The frozen state belongs to the source track, move the original cut with its effects
+    sourceTrack->thawClip(startPos);
     int pos = sourceTrack->frame(startPos);
     int clipIndex = sourceTrack->playlist().get_clip_index_at(pos);
     sourceTrack->playlist().lock();
@@ -1732,6 +1786,10 @@ void Timeline::slotMultitrackView(bool enable)
 
 void Timeline::connectOverlayTrack(bool enable)
 {
+    // Frozen clips are only a playback cache, save the original clips
+    for (Track *tk : m_tracks) {
+        tk->connectFrozenClips(enable);
+    }
     if (!m_hasOverlayTrack && !m_usePreview) {
         return;
     }
@@ -1964,11 +2022,16 @@ void Timeline::invalidateRange(const ItemInfo &info)
     if (!m_timelinePreview) {
         return;
     }
+    QPoint range(0, m_trackview->duration());
     if (info.isValid()) {
-        m_timelinePreview->invalidatePreview(info.startPos.frames(m_doc->fps()), info.endPos.frames(m_doc->fps()));
-    } else {
-        m_timelinePreview->invalidatePreview(0, m_trackview->duration());
+        range = QPoint(info.startPos.frames(m_doc->fps()), info.endPos.frames(m_doc->fps()));
+    }
+    if (m_doc->renderer()->isEditing()) {
+        // Each invalidation aborts the preview render and locks the tractor, do it once at commit
+        m_pendingInvalidations << range;
+        return;
     }
+    m_timelinePreview->invalidatePreview(range.x(), range.y());
 }
 
 void Timeline::loadPreviewRender()
@@ -2010,6 +2073,18 @@ void Timeline::updatePreviewSettings(const QString &profile)
     }
 }
 
+bool Timeline::hasRenderedPreview() const
+{
+    return m_timelinePreview && !m_ruler->getProcessedChunks().isEmpty();
+}
+
+void Timeline::setRamPreview(bool enable)
+{
+    if (m_timelinePreview) {
+        m_timelinePreview->setRamPreview(enable);
+    }
+}
+
 void Timeline::invalidateTrack(int ix)
 {
     if (!m_timelinePreview) {
@@ -2142,3 +2217,8 @@ bool Timeline::hideClip(const QString &id, bool hide)
     }
     return trackHidden;
 }
+
+void Timeline::freezeClip(ClipItem *clip)
+{
+    m_freezeManager->toggleFreeze(clip);
+}
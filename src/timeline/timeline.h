@@ -45,6 +45,8 @@ class TransitionHandler;
 class CustomRuler;
 class QUndoCommand;
 class PreviewManager;
+class FreezeManager;
+class PlaybackPrefetcher;
 
 class ScrollEventEater : public QObject
 {
@@ -110,6 +112,11 @@ public:
     void refreshIcons();
     /** @brief Returns a kdenlive effect xml description from an effect tag / id */
     static QDomElement getEffectByTag(const QString &effecttag, const QString &effectid);
+    /** @brief Start a batched edit: MLT changes still lock only while they are applied, but duration
+     *  checks, consumer purge, monitor refresh and preview invalidation are issued once at commitEdit() */
+    void beginEdit();
+    /** @brief Apply a batched edit started with beginEdit() */
+    void commitEdit();
     /** @brief Move a clip between tracks */
     bool moveClip(int startTrack, qreal startPos, int endTrack, qreal endPos, PlaylistState::ClipState state, TimelineMode::EditMode mode, bool duplicate);
     void renameTrack(int ix, const QString &name);
@@ -180,6 +187,10 @@ public:
     void clearPreviewRange();
     /** @brief Check if timeline preview profile changed and remove preview files if necessary. */
     void updatePreviewSettings(const QString &profile);
+    /** @brief Returns true if some timeline preview chunks were already rendered. */
+    bool hasRenderedPreview() const;
+    /** @brief Store timeline preview in memory or in the project cache */
+    void setRamPreview(bool enable);
     /** @brief invalidate timeline preview for visible clips in a track */
     void invalidateTrack(int ix);
     /** @brief Start rendering preview rendering range. */
@@ -190,6 +201,8 @@ public:
      *  @returns true if a track was temporarily hidden
     */
     bool hideClip(const QString &id, bool hide);
+    /** @brief Pre-render a clip with its effects, or go back to live effects if it is frozen. */
+    void freezeClip(ClipItem *clip);
 
 public slots:
     void slotDeleteClip(const QString &clipId, QUndoCommand *deleteCommand);
@@ -229,7 +242,11 @@ private:
     QList<QAction *> m_trackActions;
     /** @brief sometimes grouped commands quickly send invalidate commands, so wait a little bit before processing*/
     PreviewManager *m_timelinePreview;
+    FreezeManager *m_freezeManager;
+    PlaybackPrefetcher *m_prefetcher;
     bool m_usePreview;
+    /** @brief Preview zones invalidated during the current edit transaction */
+    QList<QPoint> m_pendingInvalidations;
     QAction *m_disablePreview;
 
     void adjustTrackHeaders();
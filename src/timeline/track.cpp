@@ -28,14 +28,21 @@
 #include "effectmanager.h"
 
 #include "kdenlive_debug.h"
+#include <QFile>
 #include <math.h>
 
+#include <mlt++/MltConsumer.h>
+
 Track::Track(int index, const QList<QAction *> &actions, Mlt::Playlist &playlist, TrackType trackType, int height, QWidget *parent) :
     effectsList(EffectsList(true)),
     type(trackType),
     trackHeader(nullptr),
     m_index(index),
-    m_playlist(playlist)
+    m_playlist(playlist),
+    m_editDepth(0),
+    m_durationChanged(false),
+    m_lastFreezeId(0),
+    m_trackProducersIndexed(false)
 {
     QString playlist_name = playlist.get("id");
     if (playlist_name != QLatin1String("black_track")) {
@@ -46,6 +53,11 @@ Track::Track(int index, const QList<QAction *> &actions, Mlt::Playlist &playlist
 Track::~Track()
 {
     if (trackHeader) trackHeader->deleteLater();
+    for (const FrozenClip &frozen : m_frozenClips) {
+        delete frozen.original;
+        delete frozen.frozen;
+    }
+    qDeleteAll(m_trackProducers);
 }
 
 // members access
@@ -55,6 +67,42 @@ Mlt::Playlist & Track::playlist()
     return m_playlist;
 }
 
+void Track::beginEdit()
+{
+    if (m_editDepth++ == 0) {
+        m_durationChanged = false;
+    }
+}
+
+void Track::commitEdit()
+{
+    if (m_editDepth == 0) {
+        qCWarning(KDENLIVE_LOG) << "// Unbalanced edit transaction on track" << m_index;
+        return;
+    }
+    if (--m_editDepth > 0) {
+        return;
+    }
+    if (m_durationChanged) {
+        m_durationChanged = false;
+        emit newTrackDuration(m_playlist.get_playtime());
+    }
+}
+
+bool Track::isEditing() const
+{
+    return m_editDepth > 0;
+}
+
+void Track::notifyDuration()
+{
+    if (m_editDepth > 0) {
+        m_durationChanged = true;
+    } else {
+        emit newTrackDuration(m_playlist.get_playtime());
+    }
+}
+
 qreal Track::fps()
 {
     return m_playlist.get_fps();
@@ -107,7 +155,7 @@ bool Track::doAdd(qreal t, Mlt::Producer *cut, TimelineMode::EditMode mode)
     }
     m_playlist.consolidate_blanks();
     if (m_playlist.insert_at(pos, cut, 1) == m_playlist.count() - 1) {
-        emit newTrackDuration(m_playlist.get_playtime());
+        notifyDuration();
     }
     return true;
 }
@@ -135,7 +183,7 @@ bool Track::move(qreal start, qreal end, TimelineMode::EditMode mode)
     bool result = doAdd(end, clipProducer.data(), mode);
     m_playlist.unlock();
     if (durationChanged) {
-	emit newTrackDuration(m_playlist.get_playtime());
+	notifyDuration();
     }
     return result;
 }
@@ -151,9 +199,10 @@ bool Track::isLastClip(qreal t)
 
 bool Track::del(qreal t, bool checkDuration)
 {
+    int pos = frame(t);
+    thaw(m_playlist.get_clip_index_at(pos));
     m_playlist.lock();
     bool durationChanged = false;
-    int pos = frame(t);
     int ix = m_playlist.get_clip_index_at(pos);
     if (ix == m_playlist.count() - 1) {
 	durationChanged = true;
@@ -168,25 +217,34 @@ bool Track::del(qreal t, bool checkDuration)
     }
     m_playlist.consolidate_blanks();
     m_playlist.unlock();
+    pruneTrackProducers();
     if (durationChanged && checkDuration) {
-        emit newTrackDuration(m_playlist.get_playtime());
+        notifyDuration();
     }
     return true;
 }
 
 bool Track::del(qreal t, qreal dt)
 {
+    if (!m_frozenClips.isEmpty()) {
+        int last = m_playlist.get_clip_index_at(frame(t + dt));
+        for (int i = m_playlist.get_clip_index_at(frame(t)); i <= last; i++) {
+            thaw(i);
+        }
+    }
     m_playlist.lock();
     m_playlist.insert_blank(m_playlist.remove_region(frame(t), frame(dt) + 1), frame(dt));
     m_playlist.consolidate_blanks();
     m_playlist.unlock();
+    pruneTrackProducers();
     return true;
 }
 
 bool Track::resize(qreal t, qreal dt, bool end)
 {
-    m_playlist.lock();
     int startFrame = frame(t);
+    thaw(m_playlist.get_clip_index_at(startFrame));
+    m_playlist.lock();
     int index = m_playlist.get_clip_index_at(startFrame);
     int length = frame(dt);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(index));
@@ -227,7 +285,7 @@ bool Track::resize(qreal t, qreal dt, bool end)
         if (index > m_playlist.count() - 1) {
             m_playlist.unlock();
             // this is the last clip in track, check tracks length to adjust black track and project duration
-            emit newTrackDuration(m_playlist.get_playtime());
+            notifyDuration();
             return true;
         }
         length = -length;
@@ -259,6 +317,7 @@ bool Track::resize(qreal t, qreal dt, bool end)
 bool Track::cut(qreal t)
 {
     int pos = frame(t);
+    thaw(m_playlist.get_clip_index_at(pos));
     m_playlist.lock();
     int index = m_playlist.get_clip_index_at(pos);
     if (m_playlist.is_blank(index)) {
@@ -307,6 +366,7 @@ void Track::replaceId(const QString &id)
     QString idForAudioTrack = id + QLatin1Char('_') + m_playlist.get("id") + QStringLiteral("_audio");
     QString idForVideoTrack = id + QStringLiteral("_video");
     QString idForTrack = id + QLatin1Char('_') + m_playlist.get("id");
+    releaseTrackProducers(id);
     //TODO: slowmotion
     for (int i = 0; i < m_playlist.count(); i++) {
         if (m_playlist.is_blank(i)) continue;
@@ -353,6 +413,8 @@ QList<ItemInfo> Track::replaceAll(const QString &id, Mlt::Producer *original, Ml
         idForVideoTrack = idForTrack + QStringLiteral("_video");
         idForTrack.append(QLatin1Char('_') + m_playlist.get("id"));
     }
+    thawClips(id);
+    releaseTrackProducers(id);
     Mlt::Producer *trackProducer = nullptr;
     Mlt::Producer *audioTrackProducer = nullptr;
     QList<ItemInfo> replaced;
@@ -439,13 +501,18 @@ QList<ItemInfo> Track::replaceAll(const QString &id, Mlt::Producer *original, Ml
             replaced << cInfo;
         }
     }
-    delete trackProducer;
+    if (trackProducer) {
+        delete m_trackProducers.take(idForTrack);
+        m_trackProducers.insert(idForTrack, trackProducer);
+    }
     delete audioTrackProducer;
+    pruneTrackProducers();
     return replaced;
 }
 
 //TODO: cut: checkSlowMotionProducer
 bool Track::replace(qreal t, Mlt::Producer *prod, PlaylistState::ClipState state, PlaylistState::ClipState originalState) {
+    thaw(m_playlist.get_clip_index_at(frame(t)));
     m_playlist.lock();
     int index = m_playlist.get_clip_index_at(frame(t));
     Mlt::Producer *cut;
@@ -482,6 +549,8 @@ const QList<ItemInfo> Track::updateEffects(const QString &id, Mlt::Producer *ori
     QString service = original->parent().get("mlt_service");
     QString idForTrack = original->parent().get("id");
     QList<ItemInfo> range;
+    // Bin effects are part of the frozen render
+    thawClips(id);
     if (needsDuplicate(service)) {
         // We have to use the track clip duplication functions, because of audio glitches in MLT's multitrack
         idForAudioTrack = idForTrack + QLatin1Char('_') + m_playlist.get("id") + QStringLiteral("_audio");
@@ -548,13 +617,13 @@ Mlt::Producer *Track::clipProducer(Mlt::Producer *parent, PlaylistState::ClipSta
     if (state == PlaylistState::AudioOnly) {
         idForTrack.append(QStringLiteral("_audio"));
     }
+    if (!m_trackProducersIndexed) {
+        indexTrackProducers();
+    }
     if (!forceCreation) {
-        for (int i = 0; i < m_playlist.count(); i++) {
-            if (m_playlist.is_blank(i)) continue;
-            QScopedPointer<Mlt::Producer> p(m_playlist.get_clip(i));
-            if (QString(p->parent().get("id")) == idForTrack) {
-                return new Mlt::Producer(p->parent());
-            }
+        Mlt::Producer *existing = m_trackProducers.value(idForTrack);
+        if (existing && existing->is_valid()) {
+            return new Mlt::Producer(*existing);
         }
     }
     Mlt::Producer *prod = Clip(parent->parent()).clone();
@@ -562,9 +631,52 @@ Mlt::Producer *Track::clipProducer(Mlt::Producer *parent, PlaylistState::ClipSta
     if (state == PlaylistState::AudioOnly) {
         prod->set("video_index", -1);
     }
+    // Clips already using a replaced duplicate keep it alive
+    delete m_trackProducers.take(idForTrack);
+    m_trackProducers.insert(idForTrack, new Mlt::Producer(*prod));
     return prod;
 }
 
+void Track::indexTrackProducers()
+{
+    // Duplicates loaded with the project, the next ones are added by clipProducer()
+    const QString suffix = QLatin1Char('_') + QString(m_playlist.get("id"));
+    const QString audioSuffix = suffix + QStringLiteral("_audio");
+    for (int i = 0; i < m_playlist.count(); i++) {
+        if (m_playlist.is_blank(i)) continue;
+        QScopedPointer<Mlt::Producer> p(m_playlist.get_clip(i));
+        const QString id = p->parent().get("id");
+        if ((id.endsWith(suffix) || id.endsWith(audioSuffix)) && !m_trackProducers.contains(id)) {
+            m_trackProducers.insert(id, new Mlt::Producer(p->parent()));
+        }
+    }
+    m_trackProducersIndexed = true;
+}
+
+void Track::releaseTrackProducers(const QString &id)
+{
+    if (!m_trackProducersIndexed) {
+        indexTrackProducers();
+    }
+    const QString idForTrack = id + QLatin1Char('_') + m_playlist.get("id");
+    delete m_trackProducers.take(idForTrack);
+    delete m_trackProducers.take(idForTrack + QStringLiteral("_audio"));
+}
+
+void Track::pruneTrackProducers()
+{
+    QHash<QString, Mlt::Producer *>::iterator it = m_trackProducers.begin();
+    while (it != m_trackProducers.end()) {
+        // Only referenced here, no clip of the track uses it
+        if (it.value()->ref_count() <= 1) {
+            delete it.value();
+            it = m_trackProducers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 bool Track::hasAudio() 
 {
     for (int i = 0; i < m_playlist.count(); i++) {
@@ -656,6 +768,7 @@ void Track::updateClipProperties(const QString &id, const QMap<QString, QString>
     QString idForVideoTrack = id + QStringLiteral("_video");
     QString idForAudioTrack = idForTrack + QStringLiteral("_audio");
     // slowmotion producers are updated in renderer
+    thawClips(id);
 
     for (int i = 0; i < m_playlist.count(); i++) {
         if (m_playlist.is_blank(i)) continue;
@@ -710,6 +823,7 @@ int Track::changeClipSpeed(const ItemInfo &info, const ItemInfo &speedIndependan
     //TODO: invalidate preview rendering
     int newLength = 0;
     int startPos = info.startPos.frames(fps());
+    thaw(m_playlist.get_clip_index_at(startPos));
     int clipIndex = m_playlist.get_clip_index_at(startPos);
     int clipLength = m_playlist.clip_length(clipIndex);
     m_playlist.lock();
@@ -861,7 +975,7 @@ int Track::changeClipSpeed(const ItemInfo &info, const ItemInfo &speedIndependan
     m_playlist.unlock();
     if (clipIndex + 1 == m_playlist.count()) {
         // We changed the speed of last clip in playlist, check track length
-        emit newTrackDuration(m_playlist.get_playtime());
+        notifyDuration();
     }
     return newLength;
 }
@@ -890,6 +1004,7 @@ void Track::disableEffects(bool disable)
     enableTrackEffects(QList<int> (), disable, true);
     // Disable timeline clip effects
     for (int i = 0; i < m_playlist.count(); i++) {
+        thaw(i);
         QScopedPointer<Mlt::Producer> original(m_playlist.get_clip(i));
         if (original == nullptr || !original->is_valid() || original->is_blank()) {
             // invalid clip
@@ -903,6 +1018,7 @@ bool Track::addEffect(double start, const EffectsParameterList &params)
 {
     int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
+    thaw(clipIndex);
     int duration = m_playlist.clip_length(clipIndex);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
     if (!clip) {
@@ -925,6 +1041,7 @@ bool Track::editEffect(double start, const EffectsParameterList &params, bool re
 {
     int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
+    thaw(clipIndex);
     int duration = m_playlist.clip_length(clipIndex);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
     if (!clip) {
@@ -946,6 +1063,7 @@ bool Track::removeEffect(double start, int effectIndex, bool updateIndex)
 {
     int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
+    thaw(clipIndex);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
     if (!clip) {
         return false;
@@ -965,6 +1083,7 @@ bool Track::enableEffects(double start, const QList<int> &effectIndexes, bool di
 {
     int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
+    thaw(clipIndex);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
     if (!clip) {
         return false;
@@ -984,6 +1103,7 @@ bool Track::moveEffect(double start, int oldPos, int newPos)
 {
     int pos = frame(start);
     int clipIndex = m_playlist.get_clip_index_at(pos);
+    thaw(clipIndex);
     QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
     if (!clip) {
         return false;
@@ -1044,6 +1164,7 @@ QList<QPoint> Track::visibleClips()
 bool Track::resize_in_out(int pos, int in, int out)
 {
     int ix = m_playlist.get_clip_index_at(pos);
+    thaw(ix);
     m_playlist.resize_clip(ix, in, out);
     return true;
 }
@@ -1083,3 +1204,157 @@ bool Track::hideClip(int pos, const QString &id, bool hide)
     }
     return false;
 }
+
+bool Track::saveClip(qreal t, const QString &path)
+{
+    int clipIndex = m_playlist.get_clip_index_at(frame(t));
+    if (m_playlist.is_blank(clipIndex)) {
+        return false;
+    }
+    QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
+    if (!clip) {
+        return false;
+    }
+    // Work on a copy of the cut, the playlist entry must not be shared
+    QScopedPointer<Mlt::Producer> cut(clip->parent().cut(clip->get_in(), clip->get_out()));
+    Clip(*cut).addEffects(*clip);
+    Mlt::Playlist list(*m_playlist.profile());
+    list.append(*cut);
+    Mlt::Consumer xmlConsumer(*m_playlist.profile(), ("xml:" + path).toUtf8().constData());
+    if (!xmlConsumer.is_valid()) {
+        return false;
+    }
+    xmlConsumer.set("terminate_on_pause", 1);
+    xmlConsumer.connect(list);
+    xmlConsumer.run();
+    return QFile::exists(path);
+}
+
+bool Track::freezeClip(qreal t, const QString &file, const QString &key)
+{
+    int clipIndex = m_playlist.get_clip_index_at(frame(t));
+    if (m_playlist.is_blank(clipIndex)) {
+        return false;
+    }
+    QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
+    if (!clip || clip->get_int("_kdenlive_freeze") > 0) {
+        return false;
+    }
+    int length = clip->get_playtime();
+    Mlt::Producer render(*m_playlist.profile(), file.toUtf8().constData());
+    if (!render.is_valid() || render.get_length() < length) {
+        qCDebug(KDENLIVE_LOG) << "// Invalid frozen clip render: " << file;
+        return false;
+    }
+    const int id = ++m_lastFreezeId;
+    QScopedPointer<Mlt::Producer> cut(render.cut(0, length - 1));
+    // Underscore properties are not saved
+    cut->set("_kdenlive_freeze", id);
+    cut->set("_kdenlive_freezekey", key.toUtf8().constData());
+    clip->set("_kdenlive_freeze", id);
+    FrozenClip frozen;
+    m_playlist.lock();
+    frozen.original = swapCut(clipIndex, cut.data());
+    frozen.frozen = nullptr;
+    m_playlist.unlock();
+    m_frozenClips.insert(id, frozen);
+    return true;
+}
+
+bool Track::thawClip(qreal t)
+{
+    return thaw(m_playlist.get_clip_index_at(frame(t)));
+}
+
+const QString Track::frozenKey(qreal t)
+{
+    int clipIndex = m_playlist.get_clip_index_at(frame(t));
+    if (m_frozenClips.isEmpty() || m_playlist.is_blank(clipIndex)) {
+        return QString();
+    }
+    QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
+    if (!clip || !m_frozenClips.contains(clip->get_int("_kdenlive_freeze"))) {
+        return QString();
+    }
+    return QString::fromUtf8(clip->get("_kdenlive_freezekey"));
+}
+
+void Track::connectFrozenClips(bool enable)
+{
+    if (m_frozenClips.isEmpty()) {
+        return;
+    }
+    m_playlist.lock();
+    for (int i = 0; i < m_playlist.count(); i++) {
+        if (m_playlist.is_blank(i)) continue;
+        QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(i));
+        QMap<int, FrozenClip>::iterator it = m_frozenClips.find(clip->get_int("_kdenlive_freeze"));
+        if (it == m_frozenClips.end()) {
+            continue;
+        }
+        if (enable && it->frozen) {
+            it->original = swapCut(i, it->frozen);
+            delete it->frozen;
+            it->frozen = nullptr;
+        } else if (!enable && it->original) {
+            it->frozen = swapCut(i, it->original);
+            delete it->original;
+            it->original = nullptr;
+        }
+    }
+    m_playlist.unlock();
+}
+
+bool Track::thaw(int clipIndex)
+{
+    if (m_frozenClips.isEmpty() || clipIndex < 0 || clipIndex >= m_playlist.count() || m_playlist.is_blank(clipIndex)) {
+        return false;
+    }
+    QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(clipIndex));
+    QMap<int, FrozenClip>::iterator it = m_frozenClips.find(clip->get_int("_kdenlive_freeze"));
+    if (it == m_frozenClips.end() || !it->original) {
+        return false;
+    }
+    m_playlist.lock();
+    delete swapCut(clipIndex, it->original);
+    m_playlist.unlock();
+    it->original->set("_kdenlive_freeze", (char *) nullptr);
+    delete it->original;
+    m_frozenClips.erase(it);
+    return true;
+}
+
+void Track::thawClips(const QString &id)
+{
+    if (m_frozenClips.isEmpty()) {
+        return;
+    }
+    for (int i = 0; i < m_playlist.count(); i++) {
+        if (m_playlist.is_blank(i)) continue;
+        QScopedPointer<Mlt::Producer> clip(m_playlist.get_clip(i));
+        QMap<int, FrozenClip>::const_iterator it = m_frozenClips.constFind(clip->get_int("_kdenlive_freeze"));
+        if (it == m_frozenClips.constEnd() || !it->original) {
+            continue;
+        }
+        QString current = it->original->parent().get("id");
+        if (current.startsWith(QLatin1Char('#'))) {
+            current.remove(0, 1);
+        }
+        if (current.startsWith(QLatin1String("slowmotion:"))) {
+            current = current.section(QLatin1Char(':'), 1, 1);
+        } else {
+            current = current.section(QLatin1Char('_'), 0, 0);
+        }
+        if (current == id) {
+            thaw(i);
+        }
+    }
+}
+
+Mlt::Producer *Track::swapCut(int clipIndex, Mlt::Producer *cut)
+{
+    Mlt::Producer *current = m_playlist.get_clip(clipIndex);
+    m_playlist.remove(clipIndex);
+    m_playlist.insert(*cut, clipIndex);
+    return current;
+}
@@ -27,6 +27,8 @@
 #include "definitions.h"
 #include "mltcontroller/effectscontroller.h"
 #include <QObject>
+#include <QHash>
+#include <QMap>
 
 #include <mlt++/MltPlaylist.h>
 #include <mlt++/MltProducer.h>
@@ -98,6 +100,15 @@ public:
     /** @brief Returns MLT's track index */
     int index() const;
 
+    /** @brief Start an edit transaction on this track
+     * Each operation still locks the playlist only while it modifies it, track duration
+     * changes are collected and notified once at commit. Transactions can be nested. */
+    void beginEdit();
+    /** @brief Close an edit transaction and notify duration change if any */
+    void commitEdit();
+    /** @brief Returns true if an edit transaction is in progress on this track */
+    bool isEditing() const;
+
     /** @brief add a clip
      * @param t is the time position to start the cut (in seconds)
      * @param cut is a MLT Producer cut (resource + in/out timecodes)
@@ -159,7 +170,8 @@ public:
      * @param parent is the source media
      * @param state is for Normal, Audio only or Video only
      * @param forceCreation if true, we do not attempt to re-use existing track producer but recreate it
-     * @return producer cut for this track */
+     * @return producer cut for this track
+     * Track producers are kept by id, so that each clip and state only has one decoder on a track */
     Mlt::Producer *clipProducer(Mlt::Producer *parent, PlaylistState::ClipState state, bool forceCreation = false);
     /** @brief Changes the speed of a clip in MLT's playlist.
     *
@@ -213,6 +225,20 @@ public:
      *  @returns true if the track was hidden
      **/
     bool hideClip(int pos, const QString &id, bool hide);
+    /** @brief Save the clip at position t with its effects as a single clip MLT playlist */
+    bool saveClip(qreal t, const QString &path);
+    /** @brief Replace the clip at position t with a pre-rendered file of its effect stack
+     *  The original cut is kept and restored as soon as the clip is edited or leaves the track.
+     *  The frozen state only lasts for the session, it is not saved with the project.
+     *  @param key identifies the rendered content of the clip
+     *  @return true if success */
+    bool freezeClip(qreal t, const QString &file, const QString &key);
+    /** @brief Restore the original cut of a frozen clip, returns false if the clip was not frozen */
+    bool thawClip(qreal t);
+    /** @brief Returns the render key of the frozen clip at position t, empty if not frozen */
+    const QString frozenKey(qreal t);
+    /** @brief Whenever we save or render our project, put the original cuts back so that cache files are not saved */
+    void connectFrozenClips(bool enable);
 
 signals:
     /** @brief notify track length change to update background
@@ -225,10 +251,39 @@ private:
     int m_index;
     /** MLT playlist behind the scene */
     Mlt::Playlist m_playlist;
+    /** @brief Nesting level of the current edit transaction */
+    int m_editDepth;
+    /** @brief True if track duration changed during the current edit transaction */
+    bool m_durationChanged;
+    /** @brief Emit newTrackDuration, or defer it until the transaction commit */
+    void notifyDuration();
     /** @brief Returns true is this MLT service needs duplication to work on multiple tracks */
     bool needsDuplicate(const QString &service) const;
     void checkEffect(const QString effectName, int pos, int duration);
     void checkEffects(const QStringList effectNames, int pos, int duration);
+    /** @brief A frozen clip, only the cut that is currently out of the playlist is set */
+    struct FrozenClip {
+        Mlt::Producer *original;
+        Mlt::Producer *frozen;
+    };
+    /** @brief Frozen clips, by the id stored in their cuts' _kdenlive_freeze property */
+    QMap<int, FrozenClip> m_frozenClips;
+    int m_lastFreezeId;
+    /** @brief Restore the original cut at playlist index, returns false if it was not frozen */
+    bool thaw(int clipIndex);
+    /** @brief Restore the original cuts of all frozen instances of a bin clip */
+    void thawClips(const QString &id);
+    /** @brief Put cut in the playlist at index, returns the cut that was there */
+    Mlt::Producer *swapCut(int clipIndex, Mlt::Producer *cut);
+    /** @brief Producers duplicated for this track, by their id (bin id, track and state) */
+    QHash<QString, Mlt::Producer *> m_trackProducers;
+    /** @brief True once the duplicates already in the playlist were added to m_trackProducers */
+    bool m_trackProducersIndexed;
+    void indexTrackProducers();
+    /** @brief Forget the duplicates of a bin clip, before they are replaced */
+    void releaseTrackProducers(const QString &id);
+    /** @brief Close the duplicates that are not used by any clip anymore */
+    void pruneTrackProducers();
 };
 
 #endif // TRACK_H
@@ -14,6 +14,8 @@ the Free Software Foundation, either version 3 of the License, or
 #include <QDateTime>
 #include <QStringList>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
 #include <mlt++/Mlt.h>
 #include <iostream>
 #include <cstdlib>
@@ -23,6 +25,8 @@ the Free Software Foundation, either version 3 of the License, or
 #include "../src/lib/audio/audioStreamInfo.h"
 #include "../src/lib/audio/audioEnvelope.h"
 #include "../src/lib/audio/audioCorrelation.h"
+#include "../src/lib/audio/audioCorrelationInfo.h"
+#include "../src/lib/audio/multiResolutionCorrelation.h"
 
 void printUsage(const char *path)
 {
@@ -30,14 +34,48 @@ void printUsage(const char *path)
               << "how much B needs to be shifted in order to be synchronized with A." << std::endl << std::endl
               << path << " <main audio file> <second audio file>" << std::endl
               << "\t-h, --help\n\t\tDisplay this help" << std::endl
-              << "\t--fft\n\t\tUse Fourier Transform (FFT) to calculate the offset. This only takes" << std::endl
-              << "\t\tO(n log n) time compared to O(n²) when using normal correlation and should be " << std::endl
-              << "\t\tfaster for large data (several minutes)." << std::endl
+              << "\t--fft\n\t\tUse Fourier Transform (FFT) at full resolution to calculate the offset. By default" << std::endl
+              << "\t\tlong files are first correlated with a lower resolution, then refined around the best matches." << std::endl
               << "\t--profile=<profile>\n\t\tUse the given profile for calculation (run: melt -query profiles)" << std::endl
               << "\t--no-images\n\t\tDo not save envelope and correlation images" << std::endl
+              << "\t--benchmark[=<runs>]\n\t\tCompare the time taken by the correlation methods (default: 5 runs each)" << std::endl
               ;
 }
 
+// Loads and normalizes the envelope like the timeline does
+void loadEnvelope(AudioEnvelope *envelope)
+{
+    QEventLoop loop;
+    QObject::connect(envelope, &AudioEnvelope::envelopeReady, &loop, &QEventLoop::quit);
+    envelope->normalizeEnvelope();
+    loop.exec();
+}
+
+// Correlates the envelopes runs times with the given method, prints the average time and the shift found
+void benchmark(const char *name, int runs, AudioEnvelope *envelopeMain, AudioEnvelope *envelopeSub, int method)
+{
+    const int sizeMain = envelopeMain->envelopeSize();
+    const int sizeSub = envelopeSub->envelopeSize();
+    qint64 total = 0;
+    int shift = 0;
+    for (int run = 0; run < runs; ++run) {
+        AudioCorrelationInfo info(sizeMain, sizeSub);
+        QElapsedTimer timer;
+        timer.start();
+        if (method == 0) {
+            AudioCorrelation::correlate(envelopeMain->envelope(), sizeMain, envelopeSub->envelope(), sizeSub, info.correlationVector());
+        } else {
+            // Plans are part of the engine, so they are rebuilt for every run
+            MultiResolutionCorrelation engine(envelopeMain->envelope(), sizeMain);
+            engine.setMultiResolution(method == 2);
+            engine.correlate(envelopeSub->envelope(), sizeSub, &info);
+        }
+        total += timer.nsecsElapsed();
+        shift = info.maxIndex() - sizeSub;
+    }
+    std::cout << name << ": " << total / runs / 1000000.0 << " ms, shift " << shift << " frames" << std::endl;
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -47,6 +85,7 @@ int main(int argc, char *argv[])
     std::string profile = "atsc_1080p_24";
     bool saveImages = true;
     bool useFFT = false;
+    int benchmarkRuns = 0;
 
     // Load arguments
     foreach (const QString &str, args) {
@@ -68,6 +107,11 @@ int main(int argc, char *argv[])
         } else if (str == "--fft") {
             useFFT = true;
             args.removeOne(str);
+
+        } else if (str.startsWith(QLatin1String("--benchmark"))) {
+            benchmarkRuns = str.contains(QLatin1Char('=')) ? str.section(QLatin1Char('='), 1).toInt() : 5;
+            benchmarkRuns = qMax(1, benchmarkRuns);
+            args.removeOne(str);
         }
 
     }
@@ -84,19 +128,12 @@ int main(int argc, char *argv[])
 
     qDebug() << "Unused arguments: " << args;
 
-    if (argc > 2) {
-        fileMain = argv[1];
-        fileSub = argv[2];
-    } else {
-        std::cout << "Usage: " << argv[0] << " <main audio file> <second audio file>" << std::endl;
-        return 0;
-    }
     std::cout << "Trying to align (2)\n\t" << fileSub << "\nto fit on (1)\n\t" << fileMain
               << "\n, result will indicate by how much (2) has to be moved." << std::endl
               << "Profile used: " << profile << std::endl
               ;
     if (useFFT) {
-        std::cout << "Will use FFT based correlation." << std::endl;
+        std::cout << "Will use full resolution FFT based correlation." << std::endl;
     }
 
     // Initialize MLT
@@ -119,21 +156,32 @@ int main(int argc, char *argv[])
 
     // Build the audio envelopes for the correlation
     AudioEnvelope *envelopeMain = new AudioEnvelope(fileMain.c_str(), &prodMain);
-    envelopeMain->loadEnvelope();
-    envelopeMain->loadStdDev();
+    QElapsedTimer timer;
+    timer.start();
+    loadEnvelope(envelopeMain);
     envelopeMain->dumpInfo();
 
     AudioEnvelope *envelopeSub = new AudioEnvelope(fileSub.c_str(), &prodSub);
-    envelopeSub->loadEnvelope();
-    envelopeSub->loadStdDev();
+    loadEnvelope(envelopeSub);
     envelopeSub->dumpInfo();
+    std::cout << "Envelopes loaded in " << timer.elapsed() << " ms." << std::endl;
+
+    if (benchmarkRuns > 0) {
+        // The direct correlation is quadratic, skip it for long files
+        if ((qint64) envelopeMain->envelopeSize() * envelopeSub->envelopeSize() < 2000000000LL) {
+            benchmark("Direct correlation", benchmarkRuns, envelopeMain, envelopeSub, 0);
+        }
+        benchmark("Full resolution", benchmarkRuns, envelopeMain, envelopeSub, 1);
+        benchmark("FFT, coarse to fine", benchmarkRuns, envelopeMain, envelopeSub, 2);
+    }
 
     // Calculate the correlation and hereby the audio shift
-    AudioCorrelation corr(envelopeMain);
-    int index = 0;
-    corr.addChild(envelopeSub/*, useFFT*/);
+    MultiResolutionCorrelation engine(envelopeMain->envelope(), envelopeMain->envelopeSize());
+    engine.setMultiResolution(!useFFT);
+    AudioCorrelationInfo info(envelopeMain->envelopeSize(), envelopeSub->envelopeSize());
+    engine.correlate(envelopeSub->envelope(), envelopeSub->envelopeSize(), &info);
 
-    int shift = corr.getShift(index);
+    int shift = info.maxIndex() - envelopeSub->envelopeSize();
     std::cout << " Should be shifted by " << shift << " frames: " << fileSub << std::endl
               << "\trelative to " << fileMain << std::endl
               << "\tin a " << prodMain.get_fps() << " fps profile (" << profile << ")." << std::endl;
@@ -153,12 +201,14 @@ int main(int argc, char *argv[])
                   << std::endl;
         outImg = QString::fromLatin1("correlation-%1.png")
                  .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd-hh:mm:ss"));
-        corr.info(index)->toImage().save(outImg);
+        info.toImage().save(outImg);
         std::cout << "Saved correlation image as "
                   << QFileInfo(outImg).absoluteFilePath().toStdString()
                   << std::endl;
     }
 
+    delete envelopeMain;
+    delete envelopeSub;
     //    Mlt::Factory::close();
 
     return 0;
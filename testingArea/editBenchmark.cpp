@@ -0,0 +1,171 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThread>
+#include <iostream>
+
+#include <mlt++/Mlt.h>
+
+/* Moves every clip of a timeline while a consumer plays it, the way
+   CustomTrackView::moveGroup does, and compares:
+   - per clip: each move purges the consumer, checks the timeline length and
+     refreshes, like before edit transactions
+   - transaction: each move only locks the tractor while the playlist changes,
+     length check, purge and refresh happen once at commit (Render::beginEdit)
+   - single lock: the tractor stays locked for the whole group move
+   The longest lock shows how long the consumer thread can be blocked. */
+
+enum Mode {
+    PerClip,
+    Transaction,
+    SingleLock
+};
+
+static QAtomicInt s_shownFrames;
+
+static void frameShown(mlt_consumer, void *, mlt_frame)
+{
+    s_shownFrames.fetchAndAddRelaxed(1);
+}
+
+// Same steps as Track::move, in overwrite mode
+static void moveClip(Mlt::Playlist &playlist, int pos, int offset)
+{
+    int index = playlist.get_clip_index_at(pos);
+    Mlt::Producer *cut = playlist.replace_with_blank(index);
+    playlist.consolidate_blanks();
+    if (cut) {
+        playlist.insert_at(pos + offset, cut, 1);
+        delete cut;
+    }
+}
+
+// Same work as Render::mltCheckLength, without resizing the black track
+static int checkLength(Mlt::Tractor &tractor)
+{
+    int duration = 0;
+    for (int i = 0; i < tractor.count(); ++i) {
+        Mlt::Producer *track = tractor.track(i);
+        duration = qMax(duration, track->get_playtime());
+        delete track;
+    }
+    return duration;
+}
+
+static void run(const char *name, Mlt::Profile &profile, int tracks, int clips, Mode mode)
+{
+    const int length = 50;
+    const int gap = 10;
+    const int offset = 5;
+    Mlt::Producer color(profile, "color:red");
+    color.set("length", clips * (length + gap) * 2);
+    color.set("out", clips * (length + gap) * 2 - 1);
+    Mlt::Tractor tractor(profile);
+    QList<Mlt::Playlist *> playlists;
+    for (int t = 0; t < tracks; ++t) {
+        Mlt::Playlist *playlist = new Mlt::Playlist(profile);
+        for (int c = 0; c < clips; ++c) {
+            playlist->blank(gap - 1);
+            playlist->append(color, 0, length - 1);
+        }
+        tractor.set_track(*playlist, t);
+        playlists << playlist;
+    }
+    tractor.set("eof", "loop");
+    Mlt::Consumer consumer(profile, "null");
+    consumer.set("real_time", 1);
+    consumer.set("terminate_on_pause", 0);
+    Mlt::Event *event = consumer.listen("consumer-frame-show", nullptr, (mlt_listener) frameShown);
+    consumer.connect(tractor);
+    tractor.set_speed(1);
+    consumer.start();
+    // Let the consumer fill its queue
+    QThread::msleep(200);
+
+    Mlt::Service service(tractor.get_service());
+    s_shownFrames.store(0);
+    int refreshes = 0;
+    qint64 maxLock = 0;
+    QElapsedTimer lockTimer;
+    QElapsedTimer timer;
+    timer.start();
+    if (mode == SingleLock) {
+        service.lock();
+        lockTimer.start();
+    }
+    for (int t = 0; t < tracks; ++t) {
+        // Move the last clips first so that no clip overlaps another one
+        for (int c = clips - 1; c >= 0; --c) {
+            const int pos = c * (length + gap) + gap;
+            if (mode != SingleLock) {
+                service.lock();
+                lockTimer.start();
+            }
+            if (mode == PerClip) {
+                consumer.purge();
+            }
+            moveClip(*playlists.at(t), pos, offset);
+            if (mode != SingleLock) {
+                maxLock = qMax(maxLock, lockTimer.nsecsElapsed());
+                service.unlock();
+            }
+            if (mode == PerClip) {
+                checkLength(tractor);
+                consumer.set("refresh", 1);
+                refreshes++;
+            }
+        }
+    }
+    if (mode == SingleLock) {
+        maxLock = lockTimer.nsecsElapsed();
+        service.unlock();
+    }
+    if (mode != PerClip) {
+        checkLength(tractor);
+        consumer.purge();
+        consumer.set("refresh", 1);
+        refreshes++;
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+    const int shown = s_shownFrames.load();
+    consumer.stop();
+    delete event;
+    qDeleteAll(playlists);
+    std::cout << name << ": " << elapsed / 1000000.0 << " ms, longest lock " << maxLock / 1000000.0 << " ms, "
+              << refreshes << " refreshes, " << shown << " frames played meanwhile" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    const int tracks = args.count() > 1 ? qMax(1, args.at(1).toInt()) : 8;
+    const int clips = args.count() > 2 ? qMax(1, args.at(2).toInt()) : 200;
+    std::cout << "Moving " << tracks * clips << " clips on " << tracks << " tracks (usage: " << argv[0] << " [tracks] [clips per track])" << std::endl;
+    Mlt::Factory::init();
+    Mlt::Profile profile("dv_pal");
+    run("  per clip   ", profile, tracks, clips, PerClip);
+    run("  transaction", profile, tracks, clips, Transaction);
+    run("  single lock", profile, tracks, clips, SingleLock);
+    return 0;
+}
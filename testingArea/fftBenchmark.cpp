@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <cmath>
+#include <iostream>
+
+#include "../src/lib/audio/fftTools.h"
+
+// The former FFTTools::fftNormalized: string keyed caches and per call buffers
+class LegacyFFT
+{
+public:
+    ~LegacyFFT()
+    {
+        for (kiss_fftr_cfg cfg : m_fftCfgs) {
+            free(cfg);
+        }
+    }
+
+    void fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum,
+                       const FFTTools::WindowType windowType, const uint windowSize, const float param)
+    {
+        const uint numSamples = audioFrame.size() / numChannels;
+        const QString cfgSig = QStringLiteral("s%1").arg(windowSize);
+        const QString winSig = QStringLiteral("s%1_t%2_p%3").arg(windowSize).arg(windowType).arg(param, 0, 'f', 3);
+        kiss_fftr_cfg myCfg;
+        if (m_fftCfgs.contains(cfgSig)) {
+            myCfg = m_fftCfgs.value(cfgSig);
+        } else {
+            myCfg = kiss_fftr_alloc(windowSize, false, nullptr, nullptr);
+            m_fftCfgs.insert(cfgSig, myCfg);
+        }
+        QVector<float> window;
+        float windowScaleFactor = 1;
+        if (windowType != FFTTools::Window_Rect) {
+            if (m_windowFunctions.contains(winSig)) {
+                window = m_windowFunctions.value(winSig);
+            } else {
+                window = FFTTools::window(windowType, windowSize, 0);
+                m_windowFunctions.insert(winSig, window);
+            }
+            windowScaleFactor = 1.0 / window[windowSize];
+        }
+        kiss_fft_cpx freqData[windowSize / 2 + 1];
+        float data[windowSize];
+        if (numSamples < windowSize) {
+            std::fill(&data[numSamples], &data[windowSize - 1], 0);
+        }
+        for (uint i = 0; i < numSamples && i < windowSize; ++i) {
+            if (windowType != FFTTools::Window_Rect) {
+                data[i] = (float) audioFrame.data()[i * numChannels + channel] / 32767.0f * window[i];
+            } else {
+                data[i] = (float) audioFrame.data()[i * numChannels + channel] / 32767.0f;
+            }
+        }
+        kiss_fftr(myCfg, data, freqData);
+        for (uint i = 0; i < windowSize / 2; ++i) {
+            freqSpectrum[i] = 20 * log(pow(pow(fabs(freqData[i].r * windowScaleFactor), 2) + pow(fabs(freqData[i].i * windowScaleFactor), 2), .5) / ((float)windowSize / 2.0f)) / log(10);
+        }
+    }
+
+private:
+    QHash<QString, kiss_fftr_cfg> m_fftCfgs;
+    QHash<QString, QVector<float> > m_windowFunctions;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    const int runs = args.count() > 1 ? qMax(1, args.at(1).toInt()) : 20000;
+    std::cout << "Spectrum of a stereo frame, " << runs << " runs per size (usage: " << argv[0] << " [runs])" << std::endl;
+
+    // 48 kHz stereo frame with two tones
+    audioShortVector frame(2 * 1920);
+    for (int i = 0; i < frame.size() / 2; ++i) {
+        const qint16 value = 10000 * sin(2 * M_PI * 440 * i / 48000.) + 3000 * sin(2 * M_PI * 5000 * i / 48000.);
+        frame[2 * i] = value;
+        frame[2 * i + 1] = value;
+    }
+
+    FFTTools tools;
+    LegacyFFT legacy;
+    const uint sizes[] = {512, 1024, 2048, 4096};
+    for (uint size : sizes) {
+        QVector<float> spectrum(size / 2);
+        QVector<float> legacySpectrum(size / 2);
+        QElapsedTimer timer;
+        timer.start();
+        for (int run = 0; run < runs; ++run) {
+            legacy.fftNormalized(frame, 0, 2, legacySpectrum.data(), FFTTools::Window_Hamming, size, 0);
+        }
+        const qint64 before = timer.nsecsElapsed();
+        timer.restart();
+        for (int run = 0; run < runs; ++run) {
+            tools.fftNormalized(frame, 0, 2, spectrum.data(), FFTTools::Window_Hamming, size, 0);
+        }
+        const qint64 after = timer.nsecsElapsed();
+        float maxDiff = 0;
+        for (int i = 0; i < spectrum.size(); ++i) {
+            maxDiff = qMax(maxDiff, (float) fabs(spectrum.at(i) - legacySpectrum.at(i)));
+        }
+        std::cout << "Window " << size << ": before " << before / runs << " ns, after " << after / runs
+                  << " ns per call, max difference " << maxDiff << " dB" << std::endl;
+    }
+    return 0;
+}
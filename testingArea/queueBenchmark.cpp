@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QtConcurrent>
+#include <iostream>
+
+#include "../src/monitor/scopes/dataqueue.h"
+#include "../src/monitor/scopes/ringqueue.h"
+
+// Items carry their push time, to measure how long they wait in the queue
+struct Stamp {
+    qint64 index;
+    qint64 time;
+};
+
+static QElapsedTimer s_timer;
+
+// DataQueue::pop() blocks on an empty queue, both queues are polled the same way
+static bool tryPop(DataQueue<Stamp> &queue, Stamp &item)
+{
+    if (queue.count() == 0) {
+        return false;
+    }
+    item = queue.pop();
+    return true;
+}
+
+static bool tryPop(RingQueue<Stamp> &queue, Stamp &item)
+{
+    return queue.tryPop(item);
+}
+
+/* Pushes count items from this thread while a second thread pops them, like the
+   consumer thread and a scope worker. Reports the time spent in push(), which
+   delays the consumer thread, the time items wait in the queue and the throughput.
+   consumerDelay slows down the popping thread (in µs per item). */
+template <class Queue>
+void run(const char *name, Queue &queue, qint64 count, int consumerDelay)
+{
+    QAtomicInt done(0);
+    qint64 received = 0;
+    qint64 totalWait = 0;
+    qint64 lastIndex = -1;
+    bool ordered = true;
+    QFuture<void> consumer = QtConcurrent::run([&]() {
+        Stamp item;
+        while (true) {
+            if (tryPop(queue, item)) {
+                totalWait += s_timer.nsecsElapsed() - item.time;
+                ordered = ordered && item.index > lastIndex;
+                lastIndex = item.index;
+                received++;
+                if (consumerDelay > 0) {
+                    QThread::usleep(consumerDelay);
+                }
+            } else if (done.loadAcquire() == 1 && queue.count() == 0) {
+                break;
+            } else {
+                QThread::yieldCurrentThread();
+            }
+        }
+    });
+    qint64 pushTime = 0;
+    qint64 maxPush = 0;
+    const qint64 start = s_timer.nsecsElapsed();
+    for (qint64 i = 0; i < count; ++i) {
+        Stamp item;
+        item.index = i;
+        item.time = s_timer.nsecsElapsed();
+        queue.push(item);
+        const qint64 elapsed = s_timer.nsecsElapsed() - item.time;
+        pushTime += elapsed;
+        maxPush = qMax(maxPush, elapsed);
+    }
+    done.storeRelease(1);
+    consumer.waitForFinished();
+    const qint64 total = s_timer.nsecsElapsed() - start;
+    std::cout << name << ": " << received << "/" << count << " items, " << (ordered ? "in order" : "OUT OF ORDER")
+              << ", " << (qint64)(received * 1e9 / qMax((qint64) 1, total)) << " items/s"
+              << ", push " << pushTime / count << " ns (max " << maxPush / 1000 << " µs)"
+              << ", queued " << totalWait / qMax((qint64) 1, received) / 1000 << " µs" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    const qint64 count = args.count() > 1 ? qMax(1, args.at(1).toInt()) : 1000000;
+    std::cout << count << " items per run (usage: " << argv[0] << " [items])" << std::endl;
+    s_timer.start();
+
+    std::cout << "Throughput, every item delivered" << std::endl;
+    {
+        DataQueue<Stamp> queue(3, DataQueue<Stamp>::OverflowModeWait);
+        run("  DataQueue", queue, count, 0);
+    }
+    {
+        RingQueue<Stamp> queue(3, RingQueue<Stamp>::OverflowModeWait);
+        run("  RingQueue", queue, count, 0);
+    }
+
+    // Like the scopes: a slow worker and a producer that must never wait
+    std::cout << "Slow consumer, oldest items discarded" << std::endl;
+    const qint64 slowCount = qMax((qint64) 1, count / 100);
+    {
+        DataQueue<Stamp> queue(3, DataQueue<Stamp>::OverflowModeDiscardOldest);
+        run("  DataQueue", queue, slowCount, 20);
+    }
+    {
+        RingQueue<Stamp> queue(3, RingQueue<Stamp>::OverflowModeDiscardOldest);
+        run("  RingQueue", queue, slowCount, 20);
+    }
+    return 0;
+}
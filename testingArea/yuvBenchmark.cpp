@@ -0,0 +1,119 @@
+/***************************************************************************
+ *   Copyright (C) 2018 by Kdenlive team (kdenlive@kde.org)                *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QStringList>
+#include <QVector>
+#include <cstring>
+#include <iostream>
+
+#include "../src/lib/video/yuvConverter.h"
+
+namespace {
+inline uchar clampByte(int value)
+{
+    return static_cast<uchar>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// The former capture path: scalar YUYV to rgb24, then a new QImage for each frame
+// and a swapped copy for the scopes
+QImage legacyConvert(const uchar *yuv, int width, int height, QImage &analysis)
+{
+    QVector<uchar> rgb(width * height * 3);
+    uchar *out = rgb.data();
+    for (int i = 0; i < width * height / 2; ++i) {
+        const int Y = yuv[i * 4];
+        const int U = yuv[i * 4 + 1];
+        const int Y2 = yuv[i * 4 + 2];
+        const int V = yuv[i * 4 + 3];
+        const int values[2] = {Y, Y2};
+        for (int luma : values) {
+            *out++ = clampByte((298 * (luma - 16) + 409 * (V - 128) + 128) >> 8);
+            *out++ = clampByte((298 * (luma - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8);
+            *out++ = clampByte((298 * (luma - 16) + 516 * (U - 128) + 128) >> 8);
+        }
+    }
+    QImage qimage(width, height, QImage::Format_RGB888);
+    memcpy(qimage.bits(), rgb.constData(), static_cast<size_t>(width * height * 3));
+    analysis = qimage.rgbSwapped();
+    return qimage;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    const int runs = args.count() > 1 ? qMax(1, args.at(1).toInt()) : 100;
+    const int width = 1920;
+    const int height = 1080;
+    std::cout << width << "x" << height << " frames, " << runs << " runs (usage: " << argv[0] << " [runs])" << std::endl;
+
+    QVector<uchar> yuyv(width * height * 2);
+    QVector<uchar> planar(width * height * 3 / 2);
+    qsrand(42);
+    for (uchar &value : yuyv) {
+        value = static_cast<uchar>(qrand());
+    }
+    for (uchar &value : planar) {
+        value = static_cast<uchar>(qrand());
+    }
+    const uchar *u = planar.constData() + width * height;
+    const uchar *v = u + (width / 2) * (height / 2);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < runs; ++i) {
+        QImage analysis;
+        legacyConvert(yuyv.constData(), width, height, analysis);
+    }
+    std::cout << "Before, 4:2:2 to rgb24 with copies: " << timer.nsecsElapsed() / runs / 1000 << " µs" << std::endl;
+
+    QImage reference(width, height, QImage::Format_RGB32);
+    YuvConverter::packed422ToRgb32(yuyv.constData(), width * 2, reference.bits(), reference.bytesPerLine(), width, height, YuvConverter::YUYV, YuvConverter::Scalar);
+    QImage reference420(width, height, QImage::Format_RGB32);
+    YuvConverter::planar420ToRgb32(planar.constData(), width, u, v, width / 2, reference420.bits(), reference420.bytesPerLine(), width, height, YuvConverter::Scalar);
+
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int k = YuvConverter::Scalar; k <= YuvConverter::Avx2; ++k) {
+        const YuvConverter::Kernel kernel = static_cast<YuvConverter::Kernel>(k);
+        if (!YuvConverter::isSupported(kernel)) {
+            std::cout << YuvConverter::kernelName(kernel) << ": not supported" << std::endl;
+            continue;
+        }
+        timer.restart();
+        for (int i = 0; i < runs; ++i) {
+            YuvConverter::packed422ToRgb32(yuyv.constData(), width * 2, image.bits(), image.bytesPerLine(), width, height, YuvConverter::YUYV, kernel);
+        }
+        const qint64 packed = timer.nsecsElapsed() / runs / 1000;
+        const bool packedOk = image == reference;
+        timer.restart();
+        for (int i = 0; i < runs; ++i) {
+            YuvConverter::planar420ToRgb32(planar.constData(), width, u, v, width / 2, image.bits(), image.bytesPerLine(), width, height, kernel);
+        }
+        const qint64 planar420 = timer.nsecsElapsed() / runs / 1000;
+        const bool planarOk = image == reference420;
+        std::cout << YuvConverter::kernelName(kernel) << ": 4:2:2 " << packed << " µs" << (packedOk ? "" : " (MISMATCH)")
+                  << ", 4:2:0 " << planar420 << " µs" << (planarOk ? "" : " (MISMATCH)") << std::endl;
+    }
+    std::cout << "Selected kernel: " << YuvConverter::kernelName(YuvConverter::bestKernel()) << std::endl;
+    return 0;
+}